@@ -63,51 +63,25 @@ void MainComponent::enumerateHIDDevices()
     // Clear any existing devices
     hidDevices.clear();
 
-    // Initialize the HID API
-    if (hid_init() != 0) {
+    // Enumerate HID devices through the shared, process-wide hidapi context
+    if (!hidContext->isInitialised()) {
         printf("Error: Failed to initialize HID API\n");
         return;
     }
 
-    // Enumerate HID devices
-    struct hid_device_info* devices = hid_enumerate(0x0, 0x0);  // 0,0 means enumerate all devices
-    struct hid_device_info* current_device = devices;
+    hidDevices = hidContext->enumerate();  // 0,0 means enumerate all devices
 
     int device_count = 0;
-    while (current_device) {
+    for (const auto& deviceInfo : hidDevices) {
         device_count++;
 
-        HIDDeviceInfo deviceInfo;
-        deviceInfo.path = juce::String(current_device->path);
-        deviceInfo.vendorId = current_device->vendor_id;
-        deviceInfo.productId = current_device->product_id;
-
-        if (current_device->manufacturer_string)
-            deviceInfo.manufacturer = juce::String(current_device->manufacturer_string);
-        else
-            deviceInfo.manufacturer = "Unknown";
-
-        if (current_device->product_string)
-            deviceInfo.product = juce::String(current_device->product_string);
-        else
-            deviceInfo.product = "Unknown Product";
-
-        if (current_device->serial_number)
-            deviceInfo.serialNumber = juce::String(current_device->serial_number);
-        else
-            deviceInfo.serialNumber = "No Serial";
-
-        hidDevices.push_back(deviceInfo);
-
         printf("\nDevice #%d:\n", device_count);
-        printf("  Path: %s\n", current_device->path);
-        printf("  Vendor ID: 0x%04X\n", current_device->vendor_id);
-        printf("  Product ID: 0x%04X\n", current_device->product_id);
+        printf("  Path: %s\n", deviceInfo.path.toUTF8());
+        printf("  Vendor ID: 0x%04X\n", deviceInfo.vendorId);
+        printf("  Product ID: 0x%04X\n", deviceInfo.productId);
         printf("  Manufacturer: %s\n", deviceInfo.manufacturer.toUTF8());
         printf("  Product: %s\n", deviceInfo.product.toUTF8());
         printf("  Serial Number: %s\n", deviceInfo.serialNumber.toUTF8());
-
-        current_device = current_device->next;
     }
 
     if (device_count == 0) {
@@ -116,12 +90,6 @@ void MainComponent::enumerateHIDDevices()
         printf("\nTotal devices found: %d\n", device_count);
     }
 
-    // Free the enumeration list
-    hid_free_enumeration(devices);
-
-    // Clean up the HID API
-    hid_exit();
-
     printf("=== End of HID Device Enumeration ===\n");
 }
 
@@ -183,17 +151,10 @@ void MainComponent::connectToDevice(const HIDDeviceInfo& device)
     // Disconnect from any currently connected device
     disconnectFromDevice();
 
-    // Initialize HID API
-    if (hid_init() != 0) {
-        printf("Error: Failed to initialize HID API for device connection\n");
-        return;
-    }
-
-    // Open the device
-    connectedDevice = hid_open_path(device.path.toUTF8());
+    // Open the device (hidapi is already initialised by the shared context)
+    connectedDevice = hidContext->openDevice(device);
     if (!connectedDevice) {
         printf("Error: Failed to open device at path: %s\n", device.path.toUTF8());
-        hid_exit();
         return;
     }
 
@@ -222,8 +183,7 @@ void MainComponent::disconnectFromDevice()
 {
     if (isDeviceConnected && connectedDevice) {
         stopTimer();
-        hid_close(connectedDevice);
-        hid_exit();
+        hidContext->closeDevice(connectedDevice);
         connectedDevice = nullptr;
         isDeviceConnected = false;
         printf("Disconnected from device\n");
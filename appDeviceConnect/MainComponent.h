@@ -5,22 +5,14 @@
 // have called `juce_generate_juce_header(<thisTarget>)` in your CMakeLists.txt,
 // you could `#include <JuceHeader.h>` here instead, to make all your module headers visible.
 #include <juce_gui_extra/juce_gui_extra.h>
-
-#include "../hidapi/hidapi/hidapi.h"
+#include <bs_hid/bs_hid.h>
 
 //==============================================================================
 /*
     This component lives inside our window, and this is where you should put all
     your controls and content.
 */
-struct HIDDeviceInfo {
-    juce::String path;
-    unsigned short vendorId;
-    unsigned short productId;
-    juce::String manufacturer;
-    juce::String product;
-    juce::String serialNumber;
-};
+using HIDDeviceInfo = bs_hid::HIDDeviceInfo;
 
 class MainComponent final : public juce::Component, public juce::Button::Listener, public juce::Timer
 {
@@ -49,6 +41,8 @@ private:
     void parseELOTouchData(unsigned char* data, int length, unsigned char reportId);
     void parseStandardTouchData(unsigned char* data, int length, unsigned char reportId);
 
+    juce::SharedResourcePointer<bs_hid::HIDContext> hidContext;
+
     std::vector<HIDDeviceInfo> hidDevices;
     juce::OwnedArray<juce::TextButton> deviceButtons;
     juce::TextButton disconnectButton;
@@ -10,5 +10,21 @@
 // It's added to target_sources in CMakeLists.txt
 
 // Include module implementations
+#include "bs_hid_HIDContext.cpp"
+#include "bs_hid_HIDDeviceRegistry.cpp"
 #include "bs_hid_TouchParser.cpp"
+#include "bs_hid_TouchFilter.cpp"
+#include "bs_hid_TouchPredictor.cpp"
+#include "bs_hid_TouchOnsetDetector.cpp"
+#include "bs_hid_ZoneMap.cpp"
+#include "bs_hid_GestureRecognizer.cpp"
+#include "bs_hid_TouchHistory.cpp"
+#include "bs_hid_AudioClock.cpp"
+#include "bs_hid_ScanTimeClock.cpp"
+#include "bs_hid_JitterBuffer.cpp"
+#include "bs_hid_LatencyMeter.cpp"
+#include "bs_hid_SyntheticTouchDevice.cpp"
 #include "bs_hid_HIDDeviceManager.cpp"
+#include "bs_hid_HIDHub.cpp"
+#include "bs_hid_SharedTouchRing.cpp"
+#include "bs_hid_SharedTouchClient.cpp"
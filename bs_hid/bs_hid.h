@@ -23,6 +23,36 @@
 // Include hidapi header
 #include "../hidapi/hidapi/hidapi.h"
 
+//==============================================================================
+/** Config: BS_HID_ENABLE_SHARED_MEMORY
+    Enables SharedTouchRing and SharedTouchClient, which let a separate touch
+    daemon own the device and distribute frames to other processes through
+    POSIX shared memory. Defaults to on for POSIX platforms.
+*/
+#ifndef BS_HID_ENABLE_SHARED_MEMORY
+ #if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+  #define BS_HID_ENABLE_SHARED_MEMORY 1
+ #else
+  #define BS_HID_ENABLE_SHARED_MEMORY 0
+ #endif
+#endif
+
+/** Config: BS_HID_USE_SIMD
+    Uses SSE2 or NEON intrinsics for per-frame work such as applying the
+    calibration transform. Set to 0 to force the portable scalar code.
+*/
+#ifndef BS_HID_USE_SIMD
+ #define BS_HID_USE_SIMD 1
+#endif
+
+#if BS_HID_USE_SIMD && (defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2))
+ #define BS_HID_USE_SSE 1
+ #include <emmintrin.h>
+#elif BS_HID_USE_SIMD && (defined (__aarch64__) || defined (_M_ARM64))
+ #define BS_HID_USE_NEON 1
+ #include <arm_neon.h>
+#endif
+
 namespace bs_hid
 {
     using namespace juce;
@@ -30,7 +60,32 @@ namespace bs_hid
 
 #include "bs_hid_HIDDeviceInfo.h"
 #include "bs_hid_TouchData.h"
-#include "bs_hid_HIDDeviceManager.h"
+#include "bs_hid_SeqLockValue.h"
+#include "bs_hid_RealtimeListenerList.h"
+#include "bs_hid_ContactStateMap.h"
 #include "bs_hid_TouchParser.h"
+#include "bs_hid_TouchFilter.h"
 #include "bs_hid_TouchCalibrationManager.h"
-#include "bs_hid_TouchVisualizerComponent.h"
+#include "bs_hid_TouchPredictor.h"
+#include "bs_hid_TouchOnsetDetector.h"
+#include "bs_hid_ZoneMap.h"
+#include "bs_hid_GestureRecognizer.h"
+#include "bs_hid_TouchHistory.h"
+#include "bs_hid_LinearFit.h"
+#include "bs_hid_AudioClock.h"
+#include "bs_hid_ScanTimeClock.h"
+#include "bs_hid_JitterBuffer.h"
+#include "bs_hid_LatencyMeter.h"
+#include "bs_hid_SyntheticTouchDevice.h"
+#include "bs_hid_HIDContext.h"
+#include "bs_hid_HIDDeviceRegistry.h"
+#include "bs_hid_HIDDeviceManager.h"
+#include "bs_hid_HIDHub.h"
+#include "bs_hid_SharedTouchRing.h"
+#include "bs_hid_SharedTouchClient.h"
+
+// The visualizer is only available to targets that link juce_gui_basics,
+// so headless tools such as the touch daemon can still use the module
+#if JUCE_MODULE_AVAILABLE_juce_gui_basics
+ #include "bs_hid_TouchVisualizerComponent.h"
+#endif
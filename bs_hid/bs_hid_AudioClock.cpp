@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+   Audio Clock Implementation
+
+  ==============================================================================
+*/
+
+// This file should only be included via bs_hid.cpp
+// But if compiled standalone, include the necessary headers
+#ifndef BS_HID_H_INCLUDED
+    #include "bs_hid.h"
+#endif
+
+namespace bs_hid
+{
+
+//==============================================================================
+void AudioClock::prepare(double sampleRate) noexcept
+{
+    nominalSamplesPerMs = sampleRate * 0.001;
+    blockStartSample = 0;
+    lastNumSamples = 0;
+    hasLine = false;
+    resetThisBlock = false;
+    callbackErrorMs = 0.0;
+    mapping = { 0.0, 0.0, nominalSamplesPerMs };
+    publishedMapping.store(mapping);
+}
+
+void AudioClock::update(double callbackTimeMs, int numSamples) noexcept
+{
+    blockStartSample += lastNumSamples;
+    lastNumSamples = numSamples;
+    resetThisBlock = false;
+
+    if (hasLine)
+        callbackErrorMs = callbackTimeMs - mapping.sampleToTime((double) blockStartSample);
+
+    if (! hasLine || std::abs(callbackErrorMs) > resetThresholdMs)
+    {
+        restart(callbackTimeMs);
+    }
+    else
+    {
+        fit.add(callbackTimeMs, (double) blockStartSample, std::exp(-(callbackTimeMs - fit.getLastX()) / windowMs));
+
+        // The line runs through the weighted mean, where the callbacks' jitter has averaged out.
+        // Until the points span enough time for the slope to mean anything, it is the nominal rate
+        mapping.timeMs = fit.getMeanX();
+        mapping.samplePosition = fit.getMeanY();
+        mapping.samplesPerMs = fit.getSlope(nominalSamplesPerMs, nominalSamplesPerMs * (1.0 - maxDrift),
+                                            nominalSamplesPerMs * (1.0 + maxDrift), minSpreadMs);
+    }
+
+    publishedMapping.store(mapping);
+}
+
+//==============================================================================
+void AudioClock::restart(double callbackTimeMs) noexcept
+{
+    fit.reset(callbackTimeMs, (double) blockStartSample);
+
+    hasLine = true;
+    resetThisBlock = true;
+    callbackErrorMs = 0.0;
+    mapping = { callbackTimeMs, (double) blockStartSample, nominalSamplesPerMs };
+}
+
+} // namespace bs_hid
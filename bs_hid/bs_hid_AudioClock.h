@@ -0,0 +1,111 @@
+/*
+  ==============================================================================
+
+   Audio Clock - Maps report timestamps to the audio sample position
+
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace bs_hid
+{
+
+/**
+    Relates the clock reports are stamped with, Time::getMillisecondCounterHiRes(),
+    to the position of the audio stream in samples.
+
+    The audio side only counts samples, and the callback times that would tie
+    the two together jitter by a millisecond or more. The sound card's crystal
+    also runs slightly off the CPU's, so a fixed rate drifts away by tens of
+    microseconds every second. update() adds each callback's time and sample
+    position to a least-squares line, weighted towards the last few seconds:
+    the line's slope is the measured sample rate, drift included, and the
+    jitter averages out of its position.
+
+    Call update() at the start of every processBlock(). The mapping is then
+    available on the audio thread through timeToSample() and sampleToTime(),
+    and on any other thread through getMapping().
+
+    A callback far off the line, after the host stalled or the stream
+    restarted, starts the line again; wasReset() is true for that block.
+*/
+class AudioClock
+{
+public:
+    //==============================================================================
+    /** A straight line from milliseconds to sample positions */
+    struct Mapping
+    {
+        double timeMs = 0.0;            // A point on the line
+        double samplePosition = 0.0;
+        double samplesPerMs = 0.0;      // Slope: the measured sample rate / 1000
+
+        double timeToSample(double time) const noexcept     { return samplePosition + (time - timeMs) * samplesPerMs; }
+        double sampleToTime(double sample) const noexcept   { return timeMs + (sample - samplePosition) / samplesPerMs; }
+    };
+
+    //==============================================================================
+    AudioClock() = default;
+
+    /** Sets the nominal sample rate and starts a new line. Call from prepareToPlay() */
+    void prepare(double sampleRate) noexcept;
+
+    /** Adds a callback at callbackTimeMs, starting a block of numSamples */
+    void update(double callbackTimeMs, int numSamples) noexcept;
+
+    //==============================================================================
+    /** Samples processed before the current block */
+    juce::int64 getBlockStartSample() const noexcept { return blockStartSample; }
+
+    /** Where the line puts the current block's first sample */
+    double getBlockStartMs() const noexcept { return mapping.sampleToTime((double) blockStartSample); }
+
+    double timeToSample(double timeMs) const noexcept { return mapping.timeToSample(timeMs); }
+    double sampleToTime(double samplePosition) const noexcept { return mapping.sampleToTime(samplePosition); }
+
+    /** Offset of a time from the start of the current block, in samples (may lie outside it) */
+    int getSampleOffset(double timeMs) const noexcept
+    {
+        return juce::roundToInt(mapping.timeToSample(timeMs) - (double) blockStartSample);
+    }
+
+    /** How far the current callback came after (or before) the line predicted */
+    double getCallbackErrorMs() const noexcept { return callbackErrorMs; }
+
+    /** True if the current block started a new line */
+    bool wasReset() const noexcept { return resetThisBlock; }
+
+    /** The audio clock's rate against the report clock, in parts per million */
+    double getDriftPpm() const noexcept { return (mapping.samplesPerMs / nominalSamplesPerMs - 1.0) * 1.0e6; }
+
+    /** The mapping for the audio thread's current block */
+    const Mapping& getCurrentMapping() const noexcept { return mapping; }
+
+    /** The latest mapping, from any thread */
+    Mapping getMapping() const noexcept { return publishedMapping.load(); }
+
+private:
+    //==============================================================================
+    static constexpr double windowMs = 4000.0;          // Time constant of the weighting
+    static constexpr double resetThresholdMs = 50.0;    // Callbacks this far off the line restart it
+    static constexpr double minSpreadMs = 50.0;         // Points must span this before the slope is measured
+    static constexpr double maxDrift = 0.002;           // Slopes further from nominal are not believed
+
+    void restart(double callbackTimeMs) noexcept;
+
+    //==============================================================================
+    double nominalSamplesPerMs = 44.1;
+    juce::int64 blockStartSample = 0;
+    int lastNumSamples = 0;
+    bool hasLine = false, resetThisBlock = false;
+    double callbackErrorMs = 0.0;
+
+    LinearFit fit;      // Sample position against callback time
+    Mapping mapping;
+    SeqLockValue<Mapping> publishedMapping;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioClock)
+};
+
+} // namespace bs_hid
@@ -0,0 +1,113 @@
+/*
+  ==============================================================================
+
+   Contact State Map - Fixed-capacity per-contact state for HID thread filters
+
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace bs_hid
+{
+
+/**
+    Keeps one State per live contact of a device, keyed by contact ID.
+
+    Stages that run on the HID thread (prediction, filtering, onset detection)
+    need state that follows a finger from report to report. This holds it in
+    fixed arrays: lookups scan at most TouchFrame::maxContacts keys, which fit
+    in a cache line, and nothing ever allocates.
+
+    Call beginReport(), find() every contact in the report, then endReport()
+    to release the entries of contacts that have lifted. Stages that keep
+    their own structure-of-arrays state use findIndex() and leave State empty.
+*/
+struct NoContactState {};
+
+template <typename State = NoContactState>
+class ContactStateMap
+{
+public:
+    static constexpr int capacity = TouchFrame::maxContacts;
+
+    //==============================================================================
+    /** Starts a report; contacts not found before endReport() are released */
+    void beginReport() noexcept { seen.fill(false); }
+
+    /** Returns the state for a contact, value-initialising it if the contact is new.
+        Returns nullptr if every entry is taken by another contact. */
+    State* find(uint8_t contactId, bool& isNew) noexcept
+    {
+        auto index = findIndex(contactId, isNew);
+        return index >= 0 ? &states[(size_t) index] : nullptr;
+    }
+
+    /** Like find(), but returns the entry's index (0 to capacity - 1), or -1 if full.
+        An entry keeps its index for as long as the contact stays down. */
+    int findIndex(uint8_t contactId, bool& isNew) noexcept
+    {
+        int freeIndex = -1;
+
+        for (int i = 0; i < capacity; ++i)
+        {
+            if (used[(size_t) i] && ids[(size_t) i] == contactId)
+            {
+                seen[(size_t) i] = true;
+                isNew = false;
+                return i;
+            }
+
+            if (!used[(size_t) i] && freeIndex < 0)
+                freeIndex = i;
+        }
+
+        if (freeIndex < 0)
+            return -1;
+
+        used[(size_t) freeIndex] = true;
+        seen[(size_t) freeIndex] = true;
+        ids[(size_t) freeIndex] = contactId;
+        states[(size_t) freeIndex] = State();
+        isNew = true;
+        return freeIndex;
+    }
+
+    /** Releases the contacts that were not in this report */
+    void endReport() noexcept { endReport([](uint8_t, State&) {}); }
+
+    /** Like endReport(), calling onRelease(contactId, state) for each contact that lifted */
+    template <typename Callback>
+    void endReport(Callback&& onRelease)
+    {
+        for (int i = 0; i < capacity; ++i)
+        {
+            if (used[(size_t) i] && !seen[(size_t) i])
+            {
+                used[(size_t) i] = false;
+                onRelease(ids[(size_t) i], states[(size_t) i]);
+            }
+        }
+    }
+
+    /** Calls fn(contactId, state) for each contact being followed */
+    template <typename Callback>
+    void forEach(Callback&& fn)
+    {
+        for (int i = 0; i < capacity; ++i)
+            if (used[(size_t) i])
+                fn(ids[(size_t) i], states[(size_t) i]);
+    }
+
+    /** Forgets every contact */
+    void clear() noexcept { used.fill(false); }
+
+private:
+    //==============================================================================
+    std::array<uint8_t, capacity> ids {};
+    std::array<bool, capacity> used {};
+    std::array<bool, capacity> seen {};
+    std::array<State, capacity> states {};
+};
+
+} // namespace bs_hid
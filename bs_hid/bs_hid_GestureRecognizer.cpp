@@ -0,0 +1,280 @@
+/*
+  ==============================================================================
+
+   Gesture Recognizer Implementation
+
+  ==============================================================================
+*/
+
+// This file should only be included via bs_hid.cpp
+// But if compiled standalone, include the necessary headers
+#ifndef BS_HID_H_INCLUDED
+    #include "bs_hid.h"
+#endif
+
+namespace bs_hid
+{
+
+//==============================================================================
+void GestureRecognizer::setOptions(const Options& newOptions)
+{
+    options = newOptions;
+    options.tapSlop = juce::jmax(0.0f, options.tapSlop);
+    options.swipeMinDistance = juce::jmax(options.tapSlop, options.swipeMinDistance);
+    options.swipeDirectionRatio = juce::jmax(1.0f, options.swipeDirectionRatio);
+    options.pinchThreshold = juce::jmax(0.0f, options.pinchThreshold);
+    options.rotateThreshold = juce::jmax(0.0f, options.rotateThreshold);
+    reset();
+}
+
+void GestureRecognizer::reset() noexcept
+{
+    tracked.clear();
+    pair = Pair();
+    hasPreviousTap = false;
+    numGestures = 0;
+}
+
+int GestureRecognizer::process(const TouchData* contacts, int numContacts, double reportTimeMs) noexcept
+{
+    numGestures = 0;
+    tracked.beginReport();
+
+    int numReportContacts = 0;
+
+    for (int i = 0; i < numContacts; ++i)
+    {
+        const auto& touch = contacts[i];
+        bool isNew = false;
+        auto* contact = tracked.find(touch.contactId, isNew);
+
+        if (contact == nullptr)
+            continue;
+
+        if (isNew)
+        {
+            contact->first = touch;
+            contact->firstTimeMs = reportTimeMs;
+        }
+
+        contact->last = touch;
+        contact->lastTimeMs = reportTimeMs;
+        reportContacts[(size_t) numReportContacts++] = contact;
+
+        updateContact(*contact, reportTimeMs);
+    }
+
+    // Lifts first, so a pair that loses a contact ends before another can form
+    tracked.endReport([&](uint8_t contactId, Contact& contact)
+    {
+        if (pair.isActive && (contactId == pair.firstId || contactId == pair.secondId))
+            endPair(reportTimeMs);
+
+        liftContact(contact, reportTimeMs);
+    });
+
+    updatePair(numReportContacts, reportTimeMs);
+    return numGestures;
+}
+
+//==============================================================================
+void GestureRecognizer::updateContact(Contact& contact, double reportTimeMs) noexcept
+{
+    if (contact.isPaired)
+        return;
+
+    const float deltaX = contact.last.normX - contact.first.normX;
+    const float deltaY = contact.last.normY - contact.first.normY;
+    const float distance = std::hypot(deltaX, deltaY);
+    const double elapsedMs = reportTimeMs - contact.firstTimeMs;
+
+    if (distance > options.tapSlop)
+        contact.canTap = false;
+
+    if (contact.canTap && elapsedMs >= options.longPressMs)
+    {
+        addGesture(Gesture::Type::longPress, contact.first, reportTimeMs);
+        contact.canTap = false;
+        contact.canSwipe = false;
+        return;
+    }
+
+    if (!contact.canSwipe || distance < options.swipeMinDistance || elapsedMs <= 0.0)
+        return;
+
+    const float speed = distance / (float) elapsedMs;
+
+    // Too slow is a drag, and it can only get slower on average
+    if (speed < options.swipeMinSpeed)
+    {
+        contact.canSwipe = false;
+        return;
+    }
+
+    const float alongX = std::abs(deltaX), alongY = std::abs(deltaY);
+
+    // A diagonal stroke keeps being watched while it is fast enough, in case it straightens
+    if (juce::jmax(alongX, alongY) < options.swipeDirectionRatio * juce::jmin(alongX, alongY))
+        return;
+
+    auto& swipe = addGesture(Gesture::Type::swipe, contact.first, reportTimeMs);
+    swipe.direction = alongX > alongY ? (deltaX > 0.0f ? Gesture::Direction::right : Gesture::Direction::left)
+                                      : (deltaY > 0.0f ? Gesture::Direction::down : Gesture::Direction::up);
+    swipe.distance = distance;
+    swipe.speed = speed;
+
+    contact.canSwipe = false;
+}
+
+void GestureRecognizer::liftContact(Contact& contact, double reportTimeMs) noexcept
+{
+    if (contact.isPaired || !contact.canTap || contact.lastTimeMs - contact.firstTimeMs > options.tapMaxMs)
+        return;
+
+    const bool isDoubleTap = hasPreviousTap
+                              && contact.firstTimeMs - previousTapTimeMs <= options.doubleTapMaxIntervalMs
+                              && std::hypot(contact.first.normX - previousTapX,
+                                            contact.first.normY - previousTapY) <= options.doubleTapSlop;
+
+    addGesture(isDoubleTap ? Gesture::Type::doubleTap : Gesture::Type::tap, contact.first, reportTimeMs);
+
+    // A third tap starts a new pair of taps rather than making another double tap
+    hasPreviousTap = !isDoubleTap;
+    previousTapX = contact.first.normX;
+    previousTapY = contact.first.normY;
+    previousTapTimeMs = reportTimeMs;
+}
+
+//==============================================================================
+void GestureRecognizer::updatePair(int numReportContacts, double reportTimeMs) noexcept
+{
+    const Contact* first = nullptr;
+    const Contact* second = nullptr;
+
+    if (pair.isActive)
+    {
+        for (int i = 0; i < numReportContacts; ++i)
+        {
+            const auto* contact = reportContacts[(size_t) i];
+
+            if (contact->last.contactId == pair.firstId)
+                first = contact;
+            else if (contact->last.contactId == pair.secondId)
+                second = contact;
+        }
+    }
+    else
+    {
+        // The first two contacts down form the pair
+        if (numReportContacts < 2)
+            return;
+
+        for (int i = 0; i < 2; ++i)
+            reportContacts[(size_t) i]->isPaired = true;
+
+        first = reportContacts[0];
+        second = reportContacts[1];
+    }
+
+    jassert(first != nullptr && second != nullptr);
+
+    if (first == nullptr || second == nullptr)
+        return;
+
+    const float deltaX = second->last.normX - first->last.normX;
+    const float deltaY = second->last.normY - first->last.normY;
+    const float distance = std::hypot(deltaX, deltaY);
+    const float angle = std::atan2(deltaY, deltaX);
+
+    if (!pair.isActive)
+    {
+        pair = Pair();
+        pair.isActive = true;
+        pair.deviceIndex = first->last.deviceIndex;
+        pair.firstId = first->last.contactId;
+        pair.secondId = second->last.contactId;
+        pair.startDistance = distance;
+        pair.lastAngle = angle;
+    }
+
+    pair.centreX = 0.5f * (first->last.normX + second->last.normX);
+    pair.centreY = 0.5f * (first->last.normY + second->last.normY);
+
+    // Accumulate the turn report by report, so it can go past half a turn
+    float turn = angle - pair.lastAngle;
+
+    if (turn > juce::MathConstants<float>::pi)
+        turn -= juce::MathConstants<float>::twoPi;
+    else if (turn < -juce::MathConstants<float>::pi)
+        turn += juce::MathConstants<float>::twoPi;
+
+    pair.rotation += turn;
+    pair.lastAngle = angle;
+    pair.scale = pair.startDistance > 1.0e-4f ? distance / pair.startDistance : 1.0f;
+
+    if (pair.isPinching)
+    {
+        addPairGesture(Gesture::Type::pinch, Gesture::State::changed, reportTimeMs);
+    }
+    else if (std::abs(pair.scale - 1.0f) >= options.pinchThreshold)
+    {
+        pair.isPinching = true;
+        addPairGesture(Gesture::Type::pinch, Gesture::State::began, reportTimeMs);
+    }
+
+    if (pair.isRotating)
+    {
+        addPairGesture(Gesture::Type::rotate, Gesture::State::changed, reportTimeMs);
+    }
+    else if (std::abs(pair.rotation) >= options.rotateThreshold)
+    {
+        pair.isRotating = true;
+        addPairGesture(Gesture::Type::rotate, Gesture::State::began, reportTimeMs);
+    }
+}
+
+void GestureRecognizer::endPair(double reportTimeMs) noexcept
+{
+    if (pair.isPinching)
+        addPairGesture(Gesture::Type::pinch, Gesture::State::ended, reportTimeMs);
+
+    if (pair.isRotating)
+        addPairGesture(Gesture::Type::rotate, Gesture::State::ended, reportTimeMs);
+
+    // The contact left behind stays out of single-contact gestures until it lifts
+    pair.isActive = false;
+}
+
+void GestureRecognizer::addPairGesture(Gesture::Type type, Gesture::State state, double reportTimeMs) noexcept
+{
+    TouchData centre;
+    centre.deviceIndex = pair.deviceIndex;
+    centre.contactId = pair.firstId;
+    centre.normX = pair.centreX;
+    centre.normY = pair.centreY;
+
+    auto& gesture = addGesture(type, centre, reportTimeMs);
+    gesture.state = state;
+    gesture.scale = pair.scale;
+    gesture.rotation = pair.rotation;
+}
+
+Gesture& GestureRecognizer::addGesture(Gesture::Type type, const TouchData& contact, double reportTimeMs) noexcept
+{
+    // Each contact makes at most one gesture per report, and the pair two
+    jassert(numGestures < maxGesturesPerReport);
+
+    auto& gesture = gestures[(size_t) juce::jmin(numGestures, maxGesturesPerReport - 1)];
+    numGestures = juce::jmin(numGestures + 1, maxGesturesPerReport);
+
+    gesture = Gesture();
+    gesture.type = type;
+    gesture.deviceIndex = contact.deviceIndex;
+    gesture.contactId = contact.contactId;
+    gesture.x = contact.normX;
+    gesture.y = contact.normY;
+    gesture.timeMs = reportTimeMs;
+    return gesture;
+}
+
+} // namespace bs_hid
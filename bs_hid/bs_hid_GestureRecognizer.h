@@ -0,0 +1,162 @@
+/*
+  ==============================================================================
+
+   Gesture Recognizer - Taps, swipes, pinches and long presses from contacts
+
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace bs_hid
+{
+
+/** A gesture recognised from one device's contacts */
+struct Gesture
+{
+    enum class Type : uint8_t
+    {
+        tap,            // Short touch that barely moved, reported as it lifts
+        doubleTap,      // Second tap close in time and place to the last (reported instead of its tap)
+        longPress,      // Touch held still for longPressMs, reported while still down
+        swipe,          // Fast stroke, reported as soon as its direction is clear
+        pinch,          // Two contacts moving apart or together
+        rotate          // Two contacts turning about each other
+    };
+
+    enum class State : uint8_t
+    {
+        recognised,     // Discrete gestures: tap, doubleTap, longPress, swipe
+        began,          // Continuous gestures (pinch, rotate): first report past the threshold,
+        changed,        // then every report of the pair,
+        ended           // then once when either contact lifts
+    };
+
+    enum class Direction : uint8_t { none, left, right, up, down };
+
+    Type type = Type::tap;
+    State state = State::recognised;
+    uint8_t deviceIndex = 0;
+    uint8_t contactId = 0;          // Contact that made the gesture (the first of a pair)
+    float x = 0.0f, y = 0.0f;       // Where it happened: tap point, swipe start or the pair's centre
+    Direction direction = Direction::none;  // Swipes only
+    float distance = 0.0f;          // Swipes: distance travelled when recognised (normalised units)
+    float speed = 0.0f;             // Swipes: average speed in normalised units per ms
+    float scale = 1.0f;             // Pinch and rotate: pair distance relative to when the pair formed
+    float rotation = 0.0f;          // Pinch and rotate: radians turned since the pair formed, clockwise
+    double timeMs = 0.0;            // Report time the gesture was recognised at
+};
+
+//==============================================================================
+/**
+    Recognises gestures from one device's contacts, incrementally, as reports
+    arrive.
+
+    Every contact is followed by a small state machine that is updated once per
+    report and commits as early as the gesture is unambiguous:
+
+    - a swipe as soon as the contact has covered swipeMinDistance, quickly
+      enough and mainly along one axis, without waiting for it to lift;
+    - a long press on the first report after longPressMs without moving;
+    - a tap as the contact lifts. A double tap is reported on the second tap's
+      lift, instead of its tap, so the first tap is never held back waiting
+      to see whether another follows;
+    - pinch and rotate once a pair of contacts has changed its distance or
+      angle past the threshold, then on every report until either lifts.
+
+    Once a contact moves it can no longer tap or long-press, and contacts that
+    form a pair no longer tap, long-press or swipe. Long presses are checked
+    when reports arrive, which digitizers send continuously while touched.
+
+    Distances are in normalised screen units, so on a wide screen a horizontal
+    distance covers more of the glass than the same vertical one.
+
+    process() runs on the HID thread, does work proportional to the number of
+    contacts and never allocates or locks.
+*/
+class GestureRecognizer
+{
+public:
+    //==============================================================================
+    /** Most gestures one report can produce: one per contact, plus pinch and rotate ending
+        for the old pair and beginning for a new one */
+    static constexpr int maxGesturesPerReport = TouchFrame::maxContacts + 4;
+
+    struct Options
+    {
+        bool enabled = false;
+        double tapMaxMs = 250.0;            // Longest touch that counts as a tap
+        float tapSlop = 0.02f;              // Movement allowed for taps and long presses
+        double doubleTapMaxIntervalMs = 300.0;  // From the first tap's lift to the second's landing
+        float doubleTapSlop = 0.05f;        // Distance allowed between the two taps
+        double longPressMs = 500.0;
+        float swipeMinDistance = 0.08f;     // Distance a swipe must cover before it is recognised
+        float swipeMinSpeed = 0.0004f;      // Normalised units per ms (0.4 screen widths per second)
+        float swipeDirectionRatio = 2.0f;   // Main axis travel relative to the other axis
+        float pinchThreshold = 0.1f;        // Relative change of the pair's distance
+        float rotateThreshold = 0.26f;      // Radians (about 15 degrees)
+    };
+
+    //==============================================================================
+    GestureRecognizer() = default;
+
+    /** Changes the options and forgets every contact. Call only while process() can't be running */
+    void setOptions(const Options& newOptions);
+
+    const Options& getOptions() const noexcept { return options; }
+
+    /** Updates the gestures with one report's contacts.
+        @returns the number of gestures recognised, read with getGesture()
+    */
+    int process(const TouchData* contacts, int numContacts, double reportTimeMs) noexcept;
+
+    /** Returns one of the gestures of the last process() call */
+    const Gesture& getGesture(int index) const noexcept { return gestures[(size_t) index]; }
+
+    /** Forgets every contact, pair and previous tap without reporting anything */
+    void reset() noexcept;
+
+private:
+    //==============================================================================
+    struct Contact
+    {
+        TouchData first, last;
+        double firstTimeMs = 0.0, lastTimeMs = 0.0;
+        bool canTap = true;             // Still within tapSlop and no long press
+        bool canSwipe = true;
+        bool isPaired = false;
+    };
+
+    struct Pair
+    {
+        bool isActive = false;
+        uint8_t deviceIndex = 0, firstId = 0, secondId = 0;
+        float startDistance = 0.0f, lastAngle = 0.0f, rotation = 0.0f;
+        float scale = 1.0f, centreX = 0.0f, centreY = 0.0f;
+        bool isPinching = false, isRotating = false;
+    };
+
+    void updateContact(Contact& contact, double reportTimeMs) noexcept;
+    void liftContact(Contact& contact, double reportTimeMs) noexcept;
+    void updatePair(int numReportContacts, double reportTimeMs) noexcept;
+    void endPair(double reportTimeMs) noexcept;
+    void addPairGesture(Gesture::Type type, Gesture::State state, double reportTimeMs) noexcept;
+    Gesture& addGesture(Gesture::Type type, const TouchData& contact, double reportTimeMs) noexcept;
+
+    //==============================================================================
+    Options options;
+    ContactStateMap<Contact> tracked;
+    std::array<Contact*, TouchFrame::maxContacts> reportContacts {};   // This report's contacts, in order
+    Pair pair;
+
+    bool hasPreviousTap = false;
+    float previousTapX = 0.0f, previousTapY = 0.0f;
+    double previousTapTimeMs = 0.0;
+
+    std::array<Gesture, maxGesturesPerReport> gestures {};
+    int numGestures = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(GestureRecognizer)
+};
+
+} // namespace bs_hid
@@ -0,0 +1,74 @@
+/*
+  ==============================================================================
+
+   HID Context Implementation
+
+  ==============================================================================
+*/
+
+// This file should only be included via bs_hid.cpp
+// But if compiled standalone, include the necessary headers
+#ifndef BS_HID_H_INCLUDED
+    #include "bs_hid.h"
+#endif
+
+namespace bs_hid
+{
+
+//==============================================================================
+HIDContext::HIDContext()
+{
+    initialised = (hid_init() == 0);
+
+    if (!initialised)
+        DBG("HIDContext: hid_init() failed");
+}
+
+HIDContext::~HIDContext()
+{
+    if (initialised)
+        hid_exit();
+}
+
+//==============================================================================
+std::vector<HIDDeviceInfo> HIDContext::enumerate(uint16_t vendorId, uint16_t productId) const
+{
+    std::vector<HIDDeviceInfo> devices;
+
+    forEachDevice(vendorId, productId, [&](const hid_device_info& info)
+    {
+        devices.push_back(createDeviceInfo(info));
+    });
+
+    return devices;
+}
+
+hid_device* HIDContext::openDevice(const HIDDeviceInfo& device) const
+{
+    if (!initialised)
+        return nullptr;
+
+    const juce::ScopedLock sl(hidapiLock);
+    return hid_open_path(device.path.toUTF8());
+}
+
+void HIDContext::closeDevice(hid_device* device) const
+{
+    if (device != nullptr)
+        hid_close(device);
+}
+
+//==============================================================================
+HIDDeviceInfo HIDContext::createDeviceInfo(const hid_device_info& info)
+{
+    HIDDeviceInfo deviceInfo;
+    deviceInfo.path = juce::String(info.path);
+    deviceInfo.vendorId = info.vendor_id;
+    deviceInfo.productId = info.product_id;
+    deviceInfo.manufacturer = info.manufacturer_string ? juce::String(info.manufacturer_string) : "Unknown";
+    deviceInfo.product = info.product_string ? juce::String(info.product_string) : "Unknown Product";
+    deviceInfo.serialNumber = info.serial_number ? juce::String(info.serial_number) : HIDDeviceInfo::noSerialNumber;
+    return deviceInfo;
+}
+
+} // namespace bs_hid
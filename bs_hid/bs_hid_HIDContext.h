@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+   HID Context - Process-wide, reference-counted hidapi initialisation
+
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace bs_hid
+{
+
+/**
+    Owns the process-wide hidapi state.
+
+    hid_init() and hid_exit() act on global state, so pairing them per call
+    lets one plugin instance tear hidapi down underneath another. Instead, every
+    consumer holds a juce::SharedResourcePointer<HIDContext>: hidapi is
+    initialised once per process, when the first pointer is created, and
+    released when the last one goes away.
+
+    @code
+    juce::SharedResourcePointer<bs_hid::HIDContext> hidContext;
+
+    if (auto* device = hidContext->openDevice(info))
+        ...
+    @endcode
+*/
+class HIDContext
+{
+public:
+    //==============================================================================
+    HIDContext();
+    ~HIDContext();
+
+    /** Returns true if hid_init() succeeded */
+    bool isInitialised() const noexcept { return initialised; }
+
+    //==============================================================================
+    /** Enumerates devices, optionally filtered by VID/PID (0 matches any) */
+    std::vector<HIDDeviceInfo> enumerate(uint16_t vendorId = 0, uint16_t productId = 0) const;
+
+    /** Calls fn(const hid_device_info&) for each matching device without
+        converting any strings. Used by HIDDeviceRegistry to diff device sets.
+    */
+    template <typename Callback>
+    void forEachDevice(uint16_t vendorId, uint16_t productId, Callback&& fn) const
+    {
+        if (!initialised)
+            return;
+
+        const juce::ScopedLock sl(hidapiLock);
+
+        auto* deviceList = hid_enumerate(vendorId, productId);
+
+        for (auto* current = deviceList; current != nullptr; current = current->next)
+            fn(*current);
+
+        hid_free_enumeration(deviceList);
+    }
+
+    //==============================================================================
+    /** Opens a device by path. Returns nullptr on failure */
+    hid_device* openDevice(const HIDDeviceInfo& device) const;
+
+    /** Closes a device opened with openDevice() */
+    void closeDevice(hid_device* device) const;
+
+    //==============================================================================
+    /** Converts a hidapi enumeration entry to an HIDDeviceInfo */
+    static HIDDeviceInfo createDeviceInfo(const hid_device_info& info);
+
+private:
+    //==============================================================================
+    bool initialised = false;
+
+    // hid_enumerate/hid_open_path are not guaranteed to be re-entrant on every backend
+    mutable juce::CriticalSection hidapiLock;
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HIDContext)
+};
+
+} // namespace bs_hid
@@ -21,6 +21,9 @@ struct HIDDeviceInfo
     juce::String product;
     juce::String serialNumber;
 
+    /** Stored in serialNumber when the device reports none */
+    static constexpr const char* noSerialNumber = "No Serial";
+
     HIDDeviceInfo() = default;
 
     HIDDeviceInfo(const juce::String& p, unsigned short vid, unsigned short pid,
@@ -28,6 +31,12 @@ struct HIDDeviceInfo
         : path(p), vendorId(vid), productId(pid),
           manufacturer(mfg), product(prod), serialNumber(serial)
     {}
+
+    /** False if the device has no serial number to tell it apart from others of its model */
+    bool hasSerialNumber() const
+    {
+        return serialNumber.isNotEmpty() && serialNumber != noSerialNumber;
+    }
 };
 
 } // namespace bs_hid
@@ -12,97 +12,545 @@
     #include "bs_hid.h"
 #endif
 
+#if JUCE_LINUX
+    #include <sys/epoll.h>
+    #include <sys/eventfd.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <cerrno>
+#endif
+
 namespace bs_hid
 {
 
+//==============================================================================
+namespace
+{
+    // epoll token for the wake eventfd; device tokens are their indices
+    constexpr uint32_t wakeToken = 0xFFFFFFFF;
+
+    /** Matches a reappearing device by serial number, or by path if it has none */
+    bool isSameDevice(const HIDDeviceInfo& a, const HIDDeviceInfo& b)
+    {
+        if (a.vendorId != b.vendorId || a.productId != b.productId)
+            return false;
+
+        if (a.hasSerialNumber() || b.hasSerialNumber())
+            return a.serialNumber == b.serialNumber;
+
+        return a.path == b.path;
+    }
+}
+
+//==============================================================================
+SurfaceMapping SurfaceMapping::fromRectangles(juce::Rectangle<int> deviceBounds, juce::Rectangle<int> surfaceBounds)
+{
+    SurfaceMapping mapping;
+
+    if (deviceBounds.getWidth() > 0)
+        mapping.scaleX = (float) surfaceBounds.getWidth() / (float) deviceBounds.getWidth();
+
+    if (deviceBounds.getHeight() > 0)
+        mapping.scaleY = (float) surfaceBounds.getHeight() / (float) deviceBounds.getHeight();
+
+    mapping.offsetX = (float) surfaceBounds.getX() - (float) deviceBounds.getX() * mapping.scaleX;
+    mapping.offsetY = (float) surfaceBounds.getY() - (float) deviceBounds.getY() * mapping.scaleY;
+    return mapping;
+}
+
+void SurfaceMapping::apply(TouchData& touch) const noexcept
+{
+    touch.x = (uint16_t) juce::jlimit(0, 65535, juce::roundToInt((float) touch.x * scaleX + offsetX));
+    touch.y = (uint16_t) juce::jlimit(0, 65535, juce::roundToInt((float) touch.y * scaleY + offsetY));
+}
+
+//==============================================================================
+void HIDDeviceManager::ReportTiming::addReport(double reportTimeMs, bool wasTouchActive) noexcept
+{
+    // Only measure interval if previous report also had active touch
+    if (wasTouchActive && lastReportTimeMs > 0.0)
+    {
+        double intervalMs = reportTimeMs - lastReportTimeMs;
+
+        // Update statistics
+        reportIntervalMs.store(intervalMs, std::memory_order_relaxed);
+
+        double currentMin = minReportIntervalMs.load(std::memory_order_relaxed);
+        if (intervalMs < currentMin)
+            minReportIntervalMs.store(intervalMs, std::memory_order_relaxed);
+
+        double currentMax = maxReportIntervalMs.load(std::memory_order_relaxed);
+        if (intervalMs > currentMax)
+            maxReportIntervalMs.store(intervalMs, std::memory_order_relaxed);
+
+        runningIntervalSum += intervalMs;
+        int count = reportCount.fetch_add(1, std::memory_order_relaxed) + 1;
+        avgReportIntervalMs.store(runningIntervalSum / count, std::memory_order_relaxed);
+    }
+
+    lastReportTimeMs = reportTimeMs;
+}
+
+HIDDeviceManager::ReportStats HIDDeviceManager::ReportTiming::getStats() const noexcept
+{
+    ReportStats stats;
+    double avgInterval = avgReportIntervalMs.load(std::memory_order_relaxed);
+    stats.avgIntervalMs = avgInterval;
+    stats.minIntervalMs = minReportIntervalMs.load(std::memory_order_relaxed);
+    stats.maxIntervalMs = maxReportIntervalMs.load(std::memory_order_relaxed);
+    stats.sampleCount = reportCount.load(std::memory_order_relaxed);
+
+    if (avgInterval > 0.0)
+        stats.reportRateHz = 1000.0 / avgInterval;
+
+    return stats;
+}
+
 //==============================================================================
 HIDDeviceManager::HIDDeviceManager()
     : juce::Thread("HIDPollingThread")
 {
+   #if JUCE_LINUX
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (epollFd >= 0 && wakeFd >= 0)
+    {
+        epoll_event event {};
+        event.events = EPOLLIN;
+        event.data.u32 = wakeToken;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+    }
+    else
+    {
+        DBG("HIDDeviceManager: epoll unavailable, falling back to polling");
+
+        if (epollFd >= 0)
+            close(epollFd);
+
+        epollFd = -1;
+    }
+   #endif
 }
 
 HIDDeviceManager::~HIDDeviceManager()
 {
     disconnectFromDevice();
-    signalThreadShouldExit();
-    waitForThreadToExit(2000);
+    stopReaderThread();
+
+   #if JUCE_LINUX
+    if (epollFd >= 0)
+        close(epollFd);
+
+    if (wakeFd >= 0)
+        close(wakeFd);
+   #endif
 }
 
 //==============================================================================
-std::vector<HIDDeviceInfo> HIDDeviceManager::getAvailableDevices()
+std::vector<HIDDeviceInfo> HIDDeviceManager::getAvailableDevices() const
 {
-    std::vector<HIDDeviceInfo> devices;
+    return deviceRegistry->getDevices();
+}
 
-    if (hid_init() != 0)
-        return devices;
+std::vector<HIDDeviceInfo> HIDDeviceManager::getAvailableDevices(uint16_t vendorId, uint16_t productId) const
+{
+    return deviceRegistry->getDevices(vendorId, productId);
+}
 
-    struct hid_device_info* deviceList = hid_enumerate(0x0, 0x0);
-    struct hid_device_info* current = deviceList;
+bool HIDDeviceManager::connectToDevice(const HIDDeviceInfo& device)
+{
+    disconnectFromDevice();
+
+    // Calibrating from now on changes this panel's profile. Its reports already map through
+    // that profile, which addDevice() resolves, so this only picks what the calibration UI edits
+    if (calibrationManager != nullptr)
+        calibrationManager->selectProfile(device);
+
+    return addDevice(device) >= 0;
+}
 
-    while (current)
+void HIDDeviceManager::disconnectFromDevice()
+{
+    stopReaderThread();
+
+    bool hadContacts = false;
+
+    for (auto& slot : devices)
     {
-        HIDDeviceInfo info;
-        info.path = juce::String(current->path);
-        info.vendorId = current->vendor_id;
-        info.productId = current->product_id;
-        info.manufacturer = current->manufacturer_string ? juce::String(current->manufacturer_string) : "Unknown";
-        info.product = current->product_string ? juce::String(current->product_string) : "Unknown Product";
-        info.serialNumber = current->serial_number ? juce::String(current->serial_number) : "No Serial";
+        if (slot != nullptr)
+        {
+            hadContacts = releaseDeviceContacts(*slot) || hadContacts;
+            closeDeviceSlot(*slot);
+            slot.reset();
+        }
+    }
 
-        devices.push_back(info);
-        current = current->next;
+    // The reader is stopped, so this thread may publish the release frame
+    if (hadContacts)
+    {
+        bool hadActiveContacts = currentFrame.hasActiveContacts();
+        mergeDeviceContacts();
+        publishMergedFrame(hadActiveContacts);
     }
 
-    hid_free_enumeration(deviceList);
-    hid_exit();
+    lostDevices.clear();
+    hasPolledDevices = false;
+}
 
-    return devices;
+bool HIDDeviceManager::isDeviceConnected() const
+{
+    return getPrimaryDeviceIndex() >= 0;
 }
 
-bool HIDDeviceManager::connectToDevice(const HIDDeviceInfo& device)
+//==============================================================================
+int HIDDeviceManager::addDevice(const HIDDeviceInfo& device, const SurfaceMapping& mapping)
 {
-    disconnectFromDevice();
+    return addDeviceAtIndex(device, mapping, -1);
+}
 
-    if (hid_init() != 0)
-        return false;
+int HIDDeviceManager::addDeviceAtIndex(const HIDDeviceInfo& device, const SurfaceMapping& mapping, int preferredIndex)
+{
+    removeFailedDevices();
 
-    connectedDevice = hid_open_path(device.path.toUTF8());
-    if (!connectedDevice)
+    for (int i = 0; i < maxDevices; ++i)
+        if (devices[(size_t) i] != nullptr && devices[(size_t) i]->info.path == device.path)
+            return i;
+
+    int deviceIndex = -1;
+
+    if (juce::isPositiveAndBelow(preferredIndex, maxDevices) && devices[(size_t) preferredIndex] == nullptr)
     {
-        hid_exit();
-        return false;
+        deviceIndex = preferredIndex;
+    }
+    else
+    {
+        for (int i = 0; i < maxDevices && deviceIndex < 0; ++i)
+            if (devices[(size_t) i] == nullptr)
+                deviceIndex = i;
     }
 
-    hid_set_nonblocking(connectedDevice, 1);
-    connectedDeviceInfo = device;
+    if (deviceIndex < 0)
+    {
+        DBG("HIDDeviceManager: Too many devices connected");
+        return -1;
+    }
+
+    auto slot = std::make_unique<DeviceSlot>();
+    slot->info = device;
+    slot->mapping = mapping;
+    slot->onsetDetector.setOptions(onsetOptions);
+    slot->gestures.setOptions(gestureOptions);
+    slot->predictor.setOptions(predictorOptions);
+
+    // Each device maps through its own profile, reconnects included. This never waits for the disk
+    if (calibrationManager != nullptr)
+        slot->calibration = &calibrationManager->getDeviceCalibration(device);
+
+    // Each device gets the parser for its own report format
+    if (device.vendorId == 0x03EB && device.productId == 0x8A6E)
+        slot->parser = ParserType::eloTouch;
+    else if (device.vendorId == 0x2575 && device.productId == 0x7317)
+        slot->parser = ParserType::standardDigitizer;
+
+    // Opening happens before the reader stops, so other devices keep running meanwhile
+    if (!openDeviceSlot(*slot))
+        return -1;
+
+    stopReaderThread();
+
+   #if JUCE_LINUX
+    if (slot->fileDescriptor >= 0)
+    {
+        epoll_event event {};
+        event.events = EPOLLIN;
+        event.data.u32 = (uint32_t) deviceIndex;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, slot->fileDescriptor, &event);
+    }
+   #endif
+
+    devices[(size_t) deviceIndex] = std::move(slot);
+    updatePrimaryDeviceInfo();
+    startReaderThread();
+
+    return deviceIndex;
+}
+
+void HIDDeviceManager::removeDevice(int deviceIndex)
+{
+    if (!juce::isPositiveAndBelow(deviceIndex, maxDevices) || devices[(size_t) deviceIndex] == nullptr)
+        return;
+
+    stopReaderThread();
+
+    auto& slot = devices[(size_t) deviceIndex];
+    bool hadContacts = releaseDeviceContacts(*slot);
+
+    closeDeviceSlot(*slot);
+    slot.reset();
+
+    // Release the removed device's contacts; the reader is stopped, so this thread may publish
+    if (hadContacts)
+    {
+        bool hadActiveContacts = currentFrame.hasActiveContacts();
+        mergeDeviceContacts();
+        publishMergedFrame(hadActiveContacts);
+    }
+
+    updatePrimaryDeviceInfo();
+    startReaderThread();
+}
+
+int HIDDeviceManager::getNumConnectedDevices() const
+{
+    return (int) getConnectedDeviceIndices().size();
+}
+
+std::vector<int> HIDDeviceManager::getConnectedDeviceIndices() const
+{
+    std::vector<int> indices;
+
+    for (int i = 0; i < maxDevices; ++i)
+        if (devices[(size_t) i] != nullptr && !devices[(size_t) i]->failed.load(std::memory_order_relaxed))
+            indices.push_back(i);
+
+    return indices;
+}
+
+HIDDeviceInfo HIDDeviceManager::getDeviceInfo(int deviceIndex) const
+{
+    if (juce::isPositiveAndBelow(deviceIndex, maxDevices) && devices[(size_t) deviceIndex] != nullptr)
+        return devices[(size_t) deviceIndex]->info;
+
+    return {};
+}
+
+void HIDDeviceManager::setCalibrationManager(TouchCalibrationManager* manager)
+{
+    stopReaderThread();
+    calibrationManager = manager;
+
+    for (auto& slot : devices)
+        if (slot != nullptr)
+            slot->calibration = manager != nullptr ? &manager->getDeviceCalibration(slot->info) : nullptr;
+
+    startReaderThread();
+}
+
+void HIDDeviceManager::setPredictorOptions(const TouchPredictor::Options& options)
+{
+    stopReaderThread();
+    predictorOptions = options;
 
-    // Reset diagnostic statistics
-    lastReportTimeTicks = 0;
-    reportIntervalMs.store(0.0, std::memory_order_relaxed);
-    minReportIntervalMs.store(999999.0, std::memory_order_relaxed);
-    maxReportIntervalMs.store(0.0, std::memory_order_relaxed);
-    avgReportIntervalMs.store(0.0, std::memory_order_relaxed);
-    reportCount.store(0, std::memory_order_relaxed);
-    runningIntervalSum = 0.0;
+    for (auto& slot : devices)
+        if (slot != nullptr)
+            slot->predictor.setOptions(predictorOptions);
 
-    // Start real-time thread for minimal latency HID polling
+    startReaderThread();
+}
+
+void HIDDeviceManager::setZoneMap(std::shared_ptr<const ZoneMap> map)
+{
+    jassert(map == nullptr || map->isCompiled());
+
+    stopReaderThread();
+
+    // Pads held under the old layout are released, or their notes would never end. The reader is
+    // stopped, so listeners still never run concurrently
+    for (auto& slot : devices)
+        if (slot != nullptr)
+            slot->zones.releaseZones([this](const ZoneEvent& event) { notifyZoneListeners(event); });
+
+    zoneMap = std::move(map);
+    startReaderThread();
+}
+
+void HIDDeviceManager::setOnsetOptions(const TouchOnsetDetector::Options& options)
+{
+    stopReaderThread();
+    onsetOptions = options;
+
+    for (auto& slot : devices)
+        if (slot != nullptr)
+            slot->onsetDetector.setOptions(onsetOptions);
+
+    startReaderThread();
+}
+
+void HIDDeviceManager::setGestureOptions(const GestureRecognizer::Options& options)
+{
+    stopReaderThread();
+    gestureOptions = options;
+
+    for (auto& slot : devices)
+        if (slot != nullptr)
+            slot->gestures.setOptions(gestureOptions);
+
+    startReaderThread();
+}
+
+TouchPredictor::ErrorStats HIDDeviceManager::getPredictionErrorStats() const
+{
+    return getPredictionErrorStats(getPrimaryDeviceIndex());
+}
+
+TouchPredictor::ErrorStats HIDDeviceManager::getPredictionErrorStats(int deviceIndex) const
+{
+    if (juce::isPositiveAndBelow(deviceIndex, maxDevices) && devices[(size_t) deviceIndex] != nullptr)
+        return devices[(size_t) deviceIndex]->predictor.getErrorStats();
+
+    return {};
+}
+
+void HIDDeviceManager::resetPredictionErrorStats()
+{
+    for (auto& slot : devices)
+        if (slot != nullptr)
+            slot->predictor.resetErrorStats();
+}
+
+void HIDDeviceManager::setSurfaceMapping(int deviceIndex, const SurfaceMapping& mapping)
+{
+    if (!juce::isPositiveAndBelow(deviceIndex, maxDevices) || devices[(size_t) deviceIndex] == nullptr)
+        return;
+
+    stopReaderThread();
+    devices[(size_t) deviceIndex]->mapping = mapping;
+    startReaderThread();
+}
+
+//==============================================================================
+void HIDDeviceManager::startReaderThread()
+{
+    hasPolledDevices = false;
+    bool hasDevices = false;
+
+    for (auto& slot : devices)
+    {
+        if (slot != nullptr)
+        {
+            hasDevices = true;
+
+            if (slot->fileDescriptor < 0)
+                hasPolledDevices = true;
+        }
+    }
+
+    if (!hasDevices)
+        return;
+
+    // Start real-time thread for minimal latency HID reading
     juce::Thread::RealtimeOptions realtimeOptions;
-    realtimeOptions.withPriority(8); // High priority (0-10 scale)
-    startRealtimeThread(realtimeOptions);
+    startRealtimeThread(realtimeOptions.withPriority(8)); // High priority (0-10 scale)
+}
+
+void HIDDeviceManager::stopReaderThread()
+{
+    if (!isThreadRunning())
+        return;
+
+    signalThreadShouldExit();
+
+   #if JUCE_LINUX
+    if (wakeFd >= 0)
+    {
+        uint64_t one = 1;
+        juce::ignoreUnused(write(wakeFd, &one, sizeof(one)));
+    }
+   #endif
+
+    waitForThreadToExit(1000);
+}
+
+bool HIDDeviceManager::openDeviceSlot(DeviceSlot& slot)
+{
+   #if JUCE_LINUX
+    // hidraw nodes are read directly so they can be multiplexed with epoll.
+    // hidapi's hidraw backend does exactly the same read() underneath.
+    if (epollFd >= 0 && slot.info.path.startsWith("/dev/hidraw"))
+    {
+        slot.fileDescriptor = open(slot.info.path.toRawUTF8(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+
+        if (slot.fileDescriptor >= 0)
+            return true;
 
+        DBG("HIDDeviceManager: Could not open " << slot.info.path << " directly, using hidapi");
+    }
+   #endif
+
+    slot.handle = hidContext->openDevice(slot.info);
+
+    if (slot.handle == nullptr)
+        return false;
+
+    hid_set_nonblocking(slot.handle, 1);
     return true;
 }
 
-void HIDDeviceManager::disconnectFromDevice()
+void HIDDeviceManager::closeDeviceSlot(DeviceSlot& slot)
 {
-    if (connectedDevice)
+   #if JUCE_LINUX
+    if (slot.fileDescriptor >= 0)
     {
-        signalThreadShouldExit();
-        waitForThreadToExit(1000);
-        hid_close(connectedDevice);
-        hid_exit();
-        connectedDevice = nullptr;
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, slot.fileDescriptor, nullptr);
+        close(slot.fileDescriptor);
+        slot.fileDescriptor = -1;
     }
+   #endif
+
+    if (slot.handle != nullptr)
+    {
+        hidContext->closeDevice(slot.handle);
+        slot.handle = nullptr;
+    }
+}
+
+void HIDDeviceManager::removeFailedDevices()
+{
+    bool anyFailed = false;
+
+    for (auto& slot : devices)
+        if (slot != nullptr && slot->failed.load(std::memory_order_acquire))
+            anyFailed = true;
+
+    if (!anyFailed)
+        return;
+
+    stopReaderThread();
+
+    for (int i = 0; i < maxDevices; ++i)
+    {
+        auto& slot = devices[(size_t) i];
+
+        if (slot != nullptr && slot->failed.load(std::memory_order_relaxed))
+        {
+            DBG("HIDDeviceManager: Lost device " << i << ": " << slot->info.product);
+
+            lostDevices.push_back({ slot->info, slot->mapping, i });
+            closeDeviceSlot(*slot);
+            slot.reset();
+        }
+    }
+
+    updatePrimaryDeviceInfo();
+    startReaderThread();
+}
+
+int HIDDeviceManager::getPrimaryDeviceIndex() const
+{
+    for (int i = 0; i < maxDevices; ++i)
+        if (devices[(size_t) i] != nullptr && !devices[(size_t) i]->failed.load(std::memory_order_relaxed))
+            return i;
+
+    return -1;
+}
+
+void HIDDeviceManager::updatePrimaryDeviceInfo()
+{
+    auto primary = getPrimaryDeviceIndex();
+
+    if (primary >= 0)
+        connectedDeviceInfo = devices[(size_t) primary]->info;
 }
 
 //==============================================================================
@@ -126,148 +574,320 @@ TouchData HIDDeviceManager::getLatestTouchData() const
     data.y = (uint16_t)((packed >> 16) & 0xFFFF);
     data.isActive = (packed & (1ULL << 32)) != 0;
     data.contactId = (uint8_t)((packed >> 33) & 0xFF);
-    data.timestamp = (juce::int64)((packed >> 41) & 0x7FFFFF);
+    data.timestamp = (juce::int64)((packed >> 41) & 0x7FFFFF) * 1000;
 
     return data;
 }
 
 std::vector<TouchData> HIDDeviceManager::getAllTouches() const
 {
-    juce::ScopedLock lock(touchArrayLock);
-    return currentTouches;
+    const auto frame = latestFrame.load();
+    return std::vector<TouchData>(frame.contacts.begin(), frame.contacts.begin() + frame.numContacts);
 }
 
 HIDDeviceManager::ReportStats HIDDeviceManager::getReportStats() const
 {
-    ReportStats stats;
-    double avgInterval = avgReportIntervalMs.load(std::memory_order_relaxed);
-    stats.avgIntervalMs = avgInterval;
-    stats.minIntervalMs = minReportIntervalMs.load(std::memory_order_relaxed);
-    stats.maxIntervalMs = maxReportIntervalMs.load(std::memory_order_relaxed);
-    stats.sampleCount = reportCount.load(std::memory_order_relaxed);
-
-    if (avgInterval > 0.0)
-        stats.reportRateHz = 1000.0 / avgInterval;
+    return getReportStats(getPrimaryDeviceIndex());
+}
 
+HIDDeviceManager::ReportStats HIDDeviceManager::getReportStats(int deviceIndex) const
+{
+    if (! juce::isPositiveAndBelow(deviceIndex, maxDevices) || devices[(size_t) deviceIndex] == nullptr)
+        return {};
+
+    const auto& slot = *devices[(size_t) deviceIndex];
+    auto stats = slot.timing.getStats();
+    stats.scanIntervalMs = slot.scanClock.getScanIntervalMs();
+    stats.droppedReports = slot.scanClock.getNumDropped();
+    stats.mergedReports = slot.scanClock.getNumMerged();
     return stats;
 }
 
 //==============================================================================
 void HIDDeviceManager::run()
 {
-    while (!threadShouldExit())
+   #if JUCE_LINUX
+    if (epollFd >= 0)
     {
-        if (connectedDevice)
-            readHIDEvents();
+        epoll_event events[maxDevices + 1];
 
+        while (!threadShouldExit())
+        {
+            // Sleep until a report arrives, unless some device can only be polled
+            int numEvents = epoll_wait(epollFd, events, maxDevices + 1, hasPolledDevices ? 1 : -1);
+
+            for (int i = 0; i < numEvents; ++i)
+            {
+                if (events[i].data.u32 == wakeToken)
+                {
+                    uint64_t value;
+                    juce::ignoreUnused(read(wakeFd, &value, sizeof(value)));
+                    continue;
+                }
+
+                readDevice((int) events[i].data.u32);
+            }
+
+            if (hasPolledDevices)
+                pollHIDDevices();
+        }
+
+        return;
+    }
+   #endif
+
+    while (!threadShouldExit())
+    {
+        pollHIDDevices();
         wait(1); // Sleep for 1ms between polls
     }
 }
 
-void HIDDeviceManager::readHIDEvents()
+void HIDDeviceManager::pollHIDDevices()
 {
-    if (!connectedDevice)
+    for (int i = 0; i < maxDevices; ++i)
+        if (devices[(size_t) i] != nullptr && devices[(size_t) i]->handle != nullptr)
+            readDevice(i);
+}
+
+void HIDDeviceManager::readDevice(int deviceIndex)
+{
+    auto& slot = *devices[(size_t) deviceIndex];
+
+    if (slot.failed.load(std::memory_order_relaxed))
         return;
 
     unsigned char buffer[256];
-    int bytesRead = hid_read(connectedDevice, buffer, sizeof(buffer));
+    int bytesRead = 0;
+
+   #if JUCE_LINUX
+    if (slot.fileDescriptor >= 0)
+    {
+        auto result = read(slot.fileDescriptor, buffer, sizeof(buffer));
+
+        if (result < 0 && (errno == EAGAIN || errno == EINTR))
+            return;
+
+        bytesRead = (int) result;
+    }
+    else
+   #endif
+    {
+        bytesRead = hid_read(slot.handle, buffer, sizeof(buffer));
+    }
+
+    // Stamped once, as soon as the report is in hand, on the monotonic clock everything else uses
+    const double readTimeMs = juce::Time::getMillisecondCounterHiRes();
 
     if (bytesRead > 0)
     {
-        parseInputReport(buffer, bytesRead);
+        parseInputReport(deviceIndex, buffer, bytesRead, readTimeMs);
     }
     else if (bytesRead < 0)
     {
-        disconnectFromDevice();
+        handleDeviceFailure(deviceIndex);
     }
 }
 
-void HIDDeviceManager::parseInputReport(unsigned char* data, int length)
+void HIDDeviceManager::handleDeviceFailure(int deviceIndex)
+{
+    auto& slot = *devices[(size_t) deviceIndex];
+
+   #if JUCE_LINUX
+    // Stop epoll reporting the hung-up descriptor; the message thread closes it later
+    if (slot.fileDescriptor >= 0)
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, slot.fileDescriptor, nullptr);
+   #endif
+
+    slot.failed.store(true, std::memory_order_release);
+
+    if (releaseDeviceContacts(slot) || slot.wasTouchActive)
+    {
+        slot.wasTouchActive = false;
+
+        bool hadActiveContacts = currentFrame.hasActiveContacts();
+        mergeDeviceContacts();
+        publishMergedFrame(hadActiveContacts);
+    }
+}
+
+void HIDDeviceManager::parseInputReport(int deviceIndex, unsigned char* data, int length, double reportTimeMs)
 {
     if (length <= 0)
         return;
 
+    auto& slot = *devices[(size_t) deviceIndex];
     unsigned char reportId = data[0];
 
-    // Store previous touch state
-    TouchData previousTouch = getLatestTouchData();
-    bool wasTouchActive = previousTouch.isActive;
+    // Previous touch state of this device
+    bool wasTouchActive = slot.wasTouchActive;
+
+    // When the panel scanned the contacts, if it says; otherwise when the report was read.
+    // Every stage below works in scan time, so USB and scheduling jitter don't reach it
+    double scanTimeMs = reportTimeMs;
 
-    // Parse based on device type
+    if (slot.parser == ParserType::standardDigitizer)
+    {
+        const int scanTime = TouchParser::parseStandardScanTime(data, length, reportId);
+
+        if (scanTime >= 0)
+            scanTimeMs = slot.scanClock.addReport((uint16_t) scanTime, reportTimeMs, wasTouchActive);
+    }
+
+    const auto timestamp = (juce::int64) (scanTimeMs * 1000.0);
+
+    // Parse based on device type, straight into the slot's fixed contact array: nothing on the
+    // read thread allocates per report
     TouchData newTouch;
-    std::vector<TouchData> allTouches;
+    int numParsed = 0;
 
-    // ELO Touch (Atmel maXTouch)
-    if (connectedDeviceInfo.vendorId == 0x03EB && connectedDeviceInfo.productId == 0x8A6E)
+    if (slot.parser == ParserType::eloTouch)
     {
-        newTouch = TouchParser::parseELOTouch(data, length, reportId);
+        newTouch = TouchParser::parseELOTouch(data, length, reportId, timestamp);
         if (newTouch.isActive)
-            allTouches.push_back(newTouch);
+            slot.contacts[(size_t) numParsed++] = newTouch;
     }
-    // Standard HID multi-touch digitizer
-    else if (connectedDeviceInfo.vendorId == 0x2575 && connectedDeviceInfo.productId == 0x7317 && reportId == 1)
+    else if (slot.parser == ParserType::standardDigitizer && reportId == 1)
     {
-        newTouch = TouchParser::parseStandardTouch(data, length, reportId, maxTouchPoints);
-        allTouches = TouchParser::parseStandardTouchMulti(data, length, reportId, maxTouchPoints);
+        newTouch = TouchParser::parseStandardTouch(data, length, reportId, maxTouchPoints, timestamp);
+        numParsed = TouchParser::parseStandardTouchMulti(data, length, reportId, maxTouchPoints, timestamp,
+                                                         slot.contacts.data(), TouchFrame::maxContacts);
     }
 
-    // Update multi-touch state
+    // Tag contacts with their device and map them into the shared surface
+    newTouch.deviceIndex = (uint8_t) deviceIndex;
+    slot.mapping.apply(newTouch);
+
+    auto calibration = slot.calibration != nullptr ? slot.calibration->load()
+                                                   : TouchCalibrationManager::CalibrationSnapshot();
+    slot.filterOptions = calibration.filter;
+    auto normalised = calibration.apply(newTouch);
+    newTouch.normX = normalised.x;
+    newTouch.normY = normalised.y;
+
+    slot.numContacts = numParsed;
+
+    for (int i = 0; i < slot.numContacts; ++i)
     {
-        juce::ScopedLock lock(touchArrayLock);
-        currentTouches = allTouches;
+        auto& contact = slot.contacts[(size_t) i];
+        contact.deviceIndex = (uint8_t) deviceIndex;
+        slot.mapping.apply(contact);
     }
 
+    // Calibrate, filter and track only this report's contacts; other devices' contacts keep theirs.
+    // Onsets are judged before filtering, which would hide the landing movement
+    calibration.applyToContacts(slot.contacts.data(), slot.numContacts);
+    slot.numContacts = slot.onsetDetector.process(slot.contacts.data(), slot.numContacts, scanTimeMs);
+    processDeviceContacts(slot, scanTimeMs);
+
+    lastReportTimeMs = reportTimeMs;
+    lastScanTimeMs = scanTimeMs;
+
+    // Update multi-touch state and the frame for this report
+    bool hadActiveContacts = currentFrame.hasActiveContacts();
+    mergeDeviceContacts();
+
     // Update single touch state (for backward compatibility)
     updateTouchState(newTouch);
 
     // Measure HID report timing ONLY for active touch reports
     if (newTouch.isActive)
+        slot.timing.addReport(reportTimeMs, wasTouchActive);
+
+    slot.wasTouchActive = newTouch.isActive;
+
+    // Notify listeners if touch state changed
+    if (newTouch.isActive || wasTouchActive)
     {
-        juce::int64 currentTimeTicks = juce::Time::getHighResolutionTicks();
+        notifyListeners(newTouch);
+    }
 
-        // Only measure interval if previous report also had active touch
-        if (wasTouchActive && lastReportTimeTicks > 0)
-        {
-            // Calculate interval between reports (convert ticks to milliseconds)
-            juce::int64 ticksPerSecond = juce::Time::getHighResolutionTicksPerSecond();
-            double intervalSeconds = (double)(currentTimeTicks - lastReportTimeTicks) / (double)ticksPerSecond;
-            double intervalMs = intervalSeconds * 1000.0;
+    publishMergedFrame(hadActiveContacts);
 
-            // Update statistics
-            reportIntervalMs.store(intervalMs, std::memory_order_relaxed);
+    // Taps shorter than the onset window got their Began in the report they lifted in.
+    // Release them in a frame of their own now, as the panel may send nothing more
+    if (slot.onsetDetector.hasHeldContacts())
+    {
+        slot.numContacts = slot.onsetDetector.releaseHeld(slot.contacts.data(), slot.numContacts);
+        processDeviceContacts(slot, scanTimeMs);
 
-            double currentMin = minReportIntervalMs.load(std::memory_order_relaxed);
-            if (intervalMs < currentMin)
-                minReportIntervalMs.store(intervalMs, std::memory_order_relaxed);
+        hadActiveContacts = currentFrame.hasActiveContacts();
+        mergeDeviceContacts();
+        publishMergedFrame(hadActiveContacts);
+    }
+}
 
-            double currentMax = maxReportIntervalMs.load(std::memory_order_relaxed);
-            if (intervalMs > currentMax)
-                maxReportIntervalMs.store(intervalMs, std::memory_order_relaxed);
+void HIDDeviceManager::processDeviceContacts(DeviceSlot& slot, double scanTimeMs)
+{
+    slot.filter.process(slot.contacts.data(), slot.numContacts, scanTimeMs, slot.filterOptions);
+    slot.predictor.process(slot.contacts.data(), slot.numContacts, scanTimeMs);
 
-            runningIntervalSum += intervalMs;
-            int count = reportCount.fetch_add(1, std::memory_order_relaxed) + 1;
-            avgReportIntervalMs.store(runningIntervalSum / count, std::memory_order_relaxed);
-        }
+    // Zones are resolved at the published position, so they agree with what consumers see
+    slot.zones.process(zoneMap.get(), slot.contacts.data(), slot.numContacts,
+                       [this](const ZoneEvent& event) { notifyZoneListeners(event); });
+
+    if (gestureOptions.enabled)
+    {
+        const int numGestures = slot.gestures.process(slot.contacts.data(), slot.numContacts, scanTimeMs);
 
-        lastReportTimeTicks = currentTimeTicks;
+        for (int i = 0; i < numGestures; ++i)
+            notifyGestureListeners(slot.gestures.getGesture(i));
     }
+}
 
-    // Notify listeners if touch state changed
-    if (newTouch.isActive || wasTouchActive)
+bool HIDDeviceManager::releaseDeviceContacts(DeviceSlot& slot)
+{
+    if (slot.numContacts == 0)
+        return false;
+
+    // A lost device's contacts lift like any other, so zone and gesture listeners end their pads,
+    // pinches and rotations. The caller publishes the merged frame
+    slot.numContacts = 0;
+    slot.onsetDetector.reset();
+    processDeviceContacts(slot, lastScanTimeMs);
+    return true;
+}
+
+void HIDDeviceManager::mergeDeviceContacts()
+{
+    currentFrame.numContacts = 0;
+
+    for (auto& slot : devices)
     {
-        notifyListeners(newTouch);
+        if (slot == nullptr)
+            continue;
+
+        for (int i = 0; i < slot->numContacts && currentFrame.numContacts < TouchFrame::maxContacts; ++i)
+            currentFrame.contacts[(size_t) currentFrame.numContacts++] = slot->contacts[(size_t) i];
+    }
+
+    currentFrame.timestamp = (juce::int64) (lastScanTimeMs * 1000.0);
+    currentFrame.receiveTimeMs = lastReportTimeMs;
+    currentFrame.scanTimeMs = lastScanTimeMs;
+    currentFrame.predictionHorizonMs = predictorOptions.enabled ? (float) predictorOptions.horizonMs : 0.0f;
+
+    latestFrame.store(currentFrame);
+}
+
+void HIDDeviceManager::publishMergedFrame(bool hadActiveContacts)
+{
+    // Frames are published while contacts are down, plus the release frame
+    if (currentFrame.hasActiveContacts() || hadActiveContacts)
+    {
+        ++currentFrame.sequence;
+        notifyFrameListeners(currentFrame);
     }
 }
 
 void HIDDeviceManager::updateTouchState(const TouchData& newTouch)
 {
     // Pack touch data into single atomic 64-bit value
-    // Layout: x(16) + y(16) + active(1) + contactId(8) + timestamp(23)
+    // Layout: x(16) + y(16) + active(1) + contactId(8) + timestamp(23, low bits in milliseconds)
     uint64_t packed = ((uint64_t)newTouch.x) |
                       (((uint64_t)newTouch.y) << 16) |
                       (newTouch.isActive ? (1ULL << 32) : 0) |
                       (((uint64_t)newTouch.contactId) << 33) |
-                      (((uint64_t)(newTouch.timestamp & 0x7FFFFF)) << 41);
+                      (((uint64_t)((newTouch.timestamp / 1000) & 0x7FFFFF)) << 41);
 
     packedTouchState.store(packed, std::memory_order_release);
 }
@@ -277,6 +897,21 @@ void HIDDeviceManager::notifyListeners(const TouchData& touch)
     listeners.call([&](Listener& l) { l.touchDetected(touch); });
 }
 
+void HIDDeviceManager::notifyFrameListeners(const TouchFrame& frame)
+{
+    listeners.call([&](Listener& l) { l.touchFrameReceived(frame); });
+}
+
+void HIDDeviceManager::notifyZoneListeners(const ZoneEvent& event)
+{
+    listeners.call([&](Listener& l) { l.zoneEventReceived(event); });
+}
+
+void HIDDeviceManager::notifyGestureListeners(const Gesture& gesture)
+{
+    listeners.call([&](Listener& l) { l.gestureRecognised(gesture); });
+}
+
 //==============================================================================
 // Auto-reconnect functionality
 
@@ -299,41 +934,54 @@ void HIDDeviceManager::disableAutoReconnect()
 
 void HIDDeviceManager::timerCallback()
 {
-    // Check if device is still connected
-    if (!isDeviceConnected() && autoReconnectEnabled)
-    {
-        DBG("Device disconnected, attempting auto-reconnect...");
+    // Close devices the reader thread reported as failed
+    removeFailedDevices();
+
+    if (autoReconnectEnabled)
         attemptAutoReconnect();
-    }
 }
 
 void HIDDeviceManager::attemptAutoReconnect()
 {
-    if (autoReconnectDevices.empty())
+    // Restore devices that dropped out, at their old index and surface mapping
+    for (auto it = lostDevices.begin(); it != lostDevices.end();)
+    {
+        bool restored = false;
+
+        for (auto& device : getAvailableDevices(it->info.vendorId, it->info.productId))
+        {
+            if (isSameDevice(device, it->info) && addDeviceAtIndex(device, it->mapping, it->deviceIndex) >= 0)
+            {
+                DBG("Restored device " << it->deviceIndex << ": " << device.manufacturer << " - " << device.product);
+                restored = true;
+                break;
+            }
+        }
+
+        it = restored ? lostDevices.erase(it) : std::next(it);
+    }
+
+    if (isDeviceConnected() || autoReconnectDevices.empty())
         return;
 
-    // Get available devices
-    auto devices = getAvailableDevices();
+    DBG("Device disconnected, attempting auto-reconnect...");
 
-    // Look for any device matching our auto-reconnect list
+    // Look for any device matching our auto-reconnect list (filtered from the registry cache)
     for (const auto& [targetVendorId, targetProductId] : autoReconnectDevices)
     {
-        for (auto& device : devices)
+        for (auto& device : getAvailableDevices(targetVendorId, targetProductId))
         {
-            if (device.vendorId == targetVendorId && device.productId == targetProductId)
-            {
-                DBG("Found auto-reconnect device: VID:0x" << juce::String::toHexString((int)device.vendorId)
-                    << " PID:0x" << juce::String::toHexString((int)device.productId));
+            DBG("Found auto-reconnect device: VID:0x" << juce::String::toHexString((int)device.vendorId)
+                << " PID:0x" << juce::String::toHexString((int)device.productId));
 
-                if (connectToDevice(device))
-                {
-                    DBG("Successfully reconnected to: " << device.manufacturer << " - " << device.product);
-                    return;
-                }
-                else
-                {
-                    DBG("Failed to reconnect to device");
-                }
+            if (connectToDevice(device))
+            {
+                DBG("Successfully reconnected to: " << device.manufacturer << " - " << device.product);
+                return;
+            }
+            else
+            {
+                DBG("Failed to reconnect to device");
             }
         }
     }
@@ -11,15 +11,38 @@
 namespace bs_hid
 {
 
+/** Maps a device's raw coordinates into the shared surface: surface = raw * scale + offset */
+struct SurfaceMapping
+{
+    float scaleX = 1.0f;
+    float scaleY = 1.0f;
+    float offsetX = 0.0f;
+    float offsetY = 0.0f;
+
+    /** Maps deviceBounds (raw device coordinates) onto surfaceBounds */
+    static SurfaceMapping fromRectangles(juce::Rectangle<int> deviceBounds,
+                                         juce::Rectangle<int> surfaceBounds);
+
+    /** Applies the mapping, clamping to the 16-bit coordinate range */
+    void apply(TouchData& touch) const noexcept;
+};
+
+//==============================================================================
 /**
     Manages HID device connections and provides callbacks for touch events.
 
     This class handles:
     - Enumerating available HID devices
-    - Connecting/disconnecting from devices
-    - Running a high-priority polling thread
+    - Connecting/disconnecting from one or more devices
+    - Running a single high-priority reader thread for all of them
     - Parsing HID reports and generating touch callbacks
     - Automatic reconnection on device disconnect
+
+    Several devices can be connected at once with addDevice(). Each one gets its
+    own parser and report statistics, and its contacts are mapped into a shared
+    surface and merged into one TouchFrame, tagged with TouchData::deviceIndex.
+    On Linux the hidraw nodes are multiplexed with epoll, so the reader thread
+    sleeps until a report arrives and adding devices never adds threads.
 */
 class HIDDeviceManager : public juce::Thread,
                          public juce::Timer
@@ -34,33 +57,80 @@ public:
 
         /** Called when a touch event is detected */
         virtual void touchDetected(const TouchData& touchData) = 0;
+
+        /** Called with every contact decoded from one report.
+            Like touchDetected(), this runs on the HID polling thread. */
+        virtual void touchFrameReceived(const TouchFrame& frame) { juce::ignoreUnused(frame); }
+
+        /** Called on the HID polling thread when a contact presses, enters, leaves or
+            releases a zone of the map set with setZoneMap(), before its frame is published.
+            setZoneMap() releases the contacts held in the old map's zones on its own thread,
+            while the polling thread is stopped */
+        virtual void zoneEventReceived(const ZoneEvent& event) { juce::ignoreUnused(event); }
+
+        /** Called on the HID polling thread for each gesture recognised while gesture
+            recognition is enabled (see setGestureOptions()), before its frame is published */
+        virtual void gestureRecognised(const Gesture& gesture) { juce::ignoreUnused(gesture); }
     };
 
+    //==============================================================================
+    /** Maximum number of simultaneously connected devices */
+    static constexpr int maxDevices = 8;
+
     //==============================================================================
     HIDDeviceManager();
     ~HIDDeviceManager() override;
 
     //==============================================================================
-    /** Enumerates all available HID devices */
-    std::vector<HIDDeviceInfo> getAvailableDevices();
+    /** Returns the cached list of available HID devices (never blocks on enumeration) */
+    std::vector<HIDDeviceInfo> getAvailableDevices() const;
+
+    /** Returns cached devices matching VID/PID (0 matches any) */
+    std::vector<HIDDeviceInfo> getAvailableDevices(uint16_t vendorId, uint16_t productId) const;
 
-    /** Connects to a specific HID device */
+    /** Returns the process-wide device registry, e.g. to listen for hotplug changes */
+    HIDDeviceRegistry& getDeviceRegistry() const { return *deviceRegistry; }
+
+    /** Connects to a specific HID device, replacing any connected devices.
+        If a calibration manager is set, it switches to the device's profile. */
     bool connectToDevice(const HIDDeviceInfo& device);
 
-    /** Disconnects from the current device */
+    /** Disconnects from all devices. Their contacts are lifted first, so listeners see every
+        zone release and gesture end */
     void disconnectFromDevice();
 
-    /** Returns true if a device is currently connected */
-    bool isDeviceConnected() const { return connectedDevice != nullptr; }
+    /** Returns true if at least one device is currently connected */
+    bool isDeviceConnected() const;
 
-    /** Returns information about the connected device */
+    /** Returns information about the primary (lowest index) connected device */
     const HIDDeviceInfo& getConnectedDeviceInfo() const { return connectedDeviceInfo; }
 
+    //==============================================================================
+    /** Connects an additional device alongside the ones already connected.
+        @returns the device index used to tag its contacts, or -1 on failure
+    */
+    int addDevice(const HIDDeviceInfo& device, const SurfaceMapping& mapping = {});
+
+    /** Disconnects one device, lifting its contacts first. A device that fails is lifted the same way */
+    void removeDevice(int deviceIndex);
+
+    /** Returns the number of connected devices */
+    int getNumConnectedDevices() const;
+
+    /** Returns the indices of all connected devices */
+    std::vector<int> getConnectedDeviceIndices() const;
+
+    /** Returns information about one connected device */
+    HIDDeviceInfo getDeviceInfo(int deviceIndex) const;
+
+    /** Changes where a device's contacts land in the shared surface */
+    void setSurfaceMapping(int deviceIndex, const SurfaceMapping& mapping);
+
     //==============================================================================
     /** Adds a listener to receive touch events */
     void addListener(Listener* listener);
 
-    /** Removes a listener */
+    /** Removes a listener. Once this returns, the reader thread will not call it again */
     void removeListener(Listener* listener);
 
     //==============================================================================
@@ -70,6 +140,56 @@ public:
     /** Get the maximum number of touch points */
     int getMaxTouchPoints() const { return maxTouchPoints; }
 
+    /** Calibrates every published contact (TouchData::normX/normY) with this manager, each
+        device through its own profile (TouchCalibrationManager::getDeviceCalibration()).
+        Without one, contacts are normalised over the raw 0..32768 range. Each device's
+        contacts then go through the jitter filter of that same profile
+        (TouchCalibrationManager::setFilterOptions() sets the active profile's).
+        The calibration manager must outlive this object or be reset to nullptr first.
+    */
+    void setCalibrationManager(TouchCalibrationManager* manager);
+
+    /** Returns the calibration manager used for published contacts, if any */
+    TouchCalibrationManager* getCalibrationManager() const noexcept { return calibrationManager; }
+
+    /** Enables latency-compensating prediction for every device's contacts. With a
+        horizon set, published normX/normY are extrapolated that far ahead. */
+    void setPredictorOptions(const TouchPredictor::Options& options);
+
+    /** Returns the current prediction settings */
+    TouchPredictor::Options getPredictorOptions() const { return predictorOptions; }
+
+    /** Prediction error of the primary device, measured against later reports */
+    TouchPredictor::ErrorStats getPredictionErrorStats() const;
+
+    /** Prediction error of one device */
+    TouchPredictor::ErrorStats getPredictionErrorStats(int deviceIndex) const;
+
+    /** Starts a new prediction error measurement on every device */
+    void resetPredictionErrorStats();
+
+    /** Resolves every contact against a compiled zone map, tagging it with TouchData::zone
+        and sending zone events to listeners. Pass nullptr to stop. Contacts held in a zone
+        of the previous map are released from it first. */
+    void setZoneMap(std::shared_ptr<const ZoneMap> map);
+
+    /** Returns the zone map in use, if any */
+    std::shared_ptr<const ZoneMap> getZoneMap() const { return zoneMap; }
+
+    /** Changes how contacts' onset velocity is measured. Every contact is published
+        with a TouchPhase; its onsetVelocity is final on its TouchPhase::began report. */
+    void setOnsetOptions(const TouchOnsetDetector::Options& options);
+
+    /** Returns the current onset detection settings */
+    TouchOnsetDetector::Options getOnsetOptions() const { return onsetOptions; }
+
+    /** Enables or changes gesture recognition. Each device's contacts are recognised
+        separately and gestures are sent to Listener::gestureRecognised(). */
+    void setGestureOptions(const GestureRecognizer::Options& options);
+
+    /** Returns the current gesture recognition settings */
+    GestureRecognizer::Options getGestureOptions() const { return gestureOptions; }
+
     //==============================================================================
     /** Enable automatic reconnection for specific device VID/PID pairs
         @param vendorProductPairs Vector of {vendorId, productId} pairs to auto-reconnect
@@ -91,6 +211,9 @@ public:
     /** Get all current active touches */
     std::vector<TouchData> getAllTouches() const;
 
+    /** The most recent merged frame, from any thread without blocking the reader */
+    TouchFrame getLatestFrame() const noexcept { return latestFrame.load(); }
+
     /** Diagnostics: Get HID report statistics */
     struct ReportStats
     {
@@ -99,10 +222,70 @@ public:
         double maxIntervalMs = 0.0;
         double avgIntervalMs = 0.0;
         int sampleCount = 0;
+
+        // From the device's Scan Time; all 0 if it reports none (see ScanTimeClock)
+        double scanIntervalMs = 0.0;    // How often the panel scans
+        int droppedReports = 0;         // Scans that never arrived
+        int mergedReports = 0;          // Reports delivered in the same batch as the one before
     };
+
+    /** Report statistics of the primary device */
     ReportStats getReportStats() const;
 
+    /** Report statistics of one device */
+    ReportStats getReportStats(int deviceIndex) const;
+
 private:
+    //==============================================================================
+    enum class ParserType
+    {
+        unknown,
+        eloTouch,               // ELO Touch (Atmel maXTouch)
+        standardDigitizer       // Standard HID multi-touch digitizer
+    };
+
+    /** Report interval statistics for one device. Written on the reader thread only */
+    struct ReportTiming
+    {
+        double lastReportTimeMs = 0.0;
+        double runningIntervalSum = 0.0;
+        std::atomic<double> reportIntervalMs{0.0};
+        std::atomic<double> minReportIntervalMs{999999.0};
+        std::atomic<double> maxReportIntervalMs{0.0};
+        std::atomic<double> avgReportIntervalMs{0.0};
+        std::atomic<int> reportCount{0};
+
+        void addReport(double reportTimeMs, bool wasTouchActive) noexcept;
+        ReportStats getStats() const noexcept;
+    };
+
+    /** One connected device. Slots are only created or destroyed while the reader thread is stopped */
+    struct DeviceSlot
+    {
+        HIDDeviceInfo info;
+        hid_device* handle = nullptr;   // hidapi handle, polled when no descriptor is available
+        int fileDescriptor = -1;        // hidraw node read directly under epoll (Linux)
+        ParserType parser = ParserType::unknown;
+        SurfaceMapping mapping;
+
+        // The device's own calibration profile, resolved when it is added; null without a manager
+        const SeqLockValue<TouchCalibrationManager::CalibrationSnapshot>* calibration = nullptr;
+        TouchFilter::Options filterOptions;     // From that profile, as of the latest report
+
+        std::array<TouchData, TouchFrame::maxContacts> contacts {};
+        int numContacts = 0;
+        bool wasTouchActive = false;
+        std::atomic<bool> failed{false};    // Set by the reader thread when a read fails
+
+        ReportTiming timing;
+        ScanTimeClock scanClock;
+        TouchOnsetDetector onsetDetector;
+        TouchFilter filter;
+        TouchPredictor predictor;
+        ZoneTracker zones;
+        GestureRecognizer gestures;
+    };
+
     //==============================================================================
     // Thread run method
     void run() override;
@@ -113,46 +296,81 @@ private:
     // Auto-reconnect helper
     void attemptAutoReconnect();
 
+    // Reader thread control. Device slots may only change while it is stopped
+    void startReaderThread();
+    void stopReaderThread();
+    bool openDeviceSlot(DeviceSlot& slot);
+    void closeDeviceSlot(DeviceSlot& slot);
+    int addDeviceAtIndex(const HIDDeviceInfo& device, const SurfaceMapping& mapping, int preferredIndex);
+    void removeFailedDevices();
+    void updatePrimaryDeviceInfo();
+    int getPrimaryDeviceIndex() const;
+
     // HID reading and parsing
-    void readHIDEvents();
-    void parseInputReport(unsigned char* data, int length);
-    void parseELOTouchData(unsigned char* data, int length, unsigned char reportId);
-    void parseStandardTouchData(unsigned char* data, int length, unsigned char reportId);
+    void pollHIDDevices();
+    void readDevice(int deviceIndex);
+    void parseInputReport(int deviceIndex, unsigned char* data, int length, double reportTimeMs);
+    void handleDeviceFailure(int deviceIndex);
+    void processDeviceContacts(DeviceSlot& slot, double scanTimeMs);
+    bool releaseDeviceContacts(DeviceSlot& slot);
+    void mergeDeviceContacts();
+    void publishMergedFrame(bool hadActiveContacts);
 
     // Touch state management
     void updateTouchState(const TouchData& newTouch);
     void notifyListeners(const TouchData& touch);
+    void notifyFrameListeners(const TouchFrame& frame);
+    void notifyZoneListeners(const ZoneEvent& event);
+    void notifyGestureListeners(const Gesture& gesture);
 
     //==============================================================================
-    hid_device* connectedDevice = nullptr;
+    juce::SharedResourcePointer<HIDContext> hidContext;
+    juce::SharedResourcePointer<HIDDeviceRegistry> deviceRegistry;
+
+    std::array<std::unique_ptr<DeviceSlot>, maxDevices> devices;
     HIDDeviceInfo connectedDeviceInfo;
+    bool hasPolledDevices = false;
+
+   #if JUCE_LINUX
+    int epollFd = -1;
+    int wakeFd = -1;        // eventfd that interrupts epoll_wait when the thread is stopped
+   #endif
 
-    // Listener management
-    juce::ListenerList<Listener> listeners;
+    // Devices that failed while connected, restored by auto-reconnect (message thread only)
+    struct LostDevice
+    {
+        HIDDeviceInfo info;
+        SurfaceMapping mapping;
+        int deviceIndex = -1;
+    };
+    std::vector<LostDevice> lostDevices;
+
+    // Listener management: iterated lock-free on the reader thread
+    RealtimeListenerList<Listener> listeners;
 
     // Touch state (using atomic for thread-safe communication)
     std::atomic<uint64_t> packedTouchState{0};  // Packed: x(16) + y(16) + active(1) + contactId(8) + timestamp(23)
 
-    // Multi-touch state (protected by mutex)
-    mutable juce::CriticalSection touchArrayLock;
-    std::vector<TouchData> currentTouches;
+    // Multi-touch state: the merged frame, published by the reader for any thread
+    SeqLockValue<TouchFrame> latestFrame;
+
+    // Frame published to listeners, merged from every device (HID thread only)
+    TouchFrame currentFrame;
+    double lastReportTimeMs = 0.0;
+    double lastScanTimeMs = 0.0;
 
     // Configuration
     int maxTouchPoints = 10;
+    TouchCalibrationManager* calibrationManager = nullptr;   // Only changed while the reader is stopped
+    TouchPredictor::Options predictorOptions;                 // Likewise
+    TouchOnsetDetector::Options onsetOptions;                 // Likewise
+    std::shared_ptr<const ZoneMap> zoneMap;                   // Likewise
+    GestureRecognizer::Options gestureOptions;                // Likewise
 
     // Auto-reconnect configuration
     bool autoReconnectEnabled = false;
     std::vector<std::pair<uint16_t, uint16_t>> autoReconnectDevices; // {vendorId, productId} pairs
 
-    // Diagnostic timing
-    juce::int64 lastReportTimeTicks = 0;
-    std::atomic<double> reportIntervalMs{0.0};
-    std::atomic<double> minReportIntervalMs{999999.0};
-    std::atomic<double> maxReportIntervalMs{0.0};
-    std::atomic<double> avgReportIntervalMs{0.0};
-    std::atomic<int> reportCount{0};
-    double runningIntervalSum = 0.0;
-
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HIDDeviceManager)
 };
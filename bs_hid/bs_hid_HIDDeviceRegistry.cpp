@@ -0,0 +1,127 @@
+/*
+  ==============================================================================
+
+   HID Device Registry Implementation
+
+  ==============================================================================
+*/
+
+// This file should only be included via bs_hid.cpp
+// But if compiled standalone, include the necessary headers
+#ifndef BS_HID_H_INCLUDED
+    #include "bs_hid.h"
+#endif
+
+namespace bs_hid
+{
+
+//==============================================================================
+HIDDeviceRegistry::HIDDeviceRegistry()
+    : juce::Thread("HIDHotplugThread"),
+      cachedDevices(std::make_shared<const DeviceList>())
+{
+    // First scan is synchronous so the first owner can connect straight away.
+    // Every later owner in the process gets the cached list for free.
+    rescan();
+
+    startThread(juce::Thread::Priority::background);
+}
+
+HIDDeviceRegistry::~HIDDeviceRegistry()
+{
+    stopThread(2000);
+}
+
+//==============================================================================
+std::shared_ptr<const HIDDeviceRegistry::DeviceList> HIDDeviceRegistry::getCachedList() const
+{
+    const juce::SpinLock::ScopedLockType sl(cacheLock);
+    return cachedDevices;
+}
+
+std::vector<HIDDeviceInfo> HIDDeviceRegistry::getDevices() const
+{
+    return *getCachedList();
+}
+
+std::vector<HIDDeviceInfo> HIDDeviceRegistry::getDevices(uint16_t vendorId, uint16_t productId) const
+{
+    std::vector<HIDDeviceInfo> matches;
+
+    for (const auto& device : *getCachedList())
+    {
+        if ((vendorId == 0 || device.vendorId == vendorId) &&
+            (productId == 0 || device.productId == productId))
+            matches.push_back(device);
+    }
+
+    return matches;
+}
+
+void HIDDeviceRegistry::refresh()
+{
+    notify();
+}
+
+//==============================================================================
+void HIDDeviceRegistry::run()
+{
+    while (!threadShouldExit())
+    {
+        wait(scanIntervalMs.load());
+
+        if (threadShouldExit())
+            break;
+
+        if (rescan())
+            sendChangeMessage();
+    }
+}
+
+bool HIDDeviceRegistry::rescan()
+{
+    auto previous = getCachedList();
+
+    // Index the current cache by path so unchanged devices keep their strings
+    std::map<juce::String, const HIDDeviceInfo*> known;
+    for (const auto& device : *previous)
+        known[device.path] = &device;
+
+    auto updated = std::make_shared<DeviceList>();
+    bool changed = false;
+
+    hidContext->forEachDevice(0, 0, [&](const hid_device_info& info)
+    {
+        auto path = juce::String(info.path);
+        auto existing = known.find(path);
+
+        if (existing != known.end())
+        {
+            updated->push_back(*existing->second);
+        }
+        else
+        {
+            updated->push_back(HIDContext::createDeviceInfo(info));
+            changed = true;
+        }
+    });
+
+    // Anything that vanished also counts as a change
+    if (updated->size() != previous->size())
+        changed = true;
+
+    if (!changed)
+        return false;
+
+    {
+        const juce::SpinLock::ScopedLockType sl(cacheLock);
+        cachedDevices = std::move(updated);
+    }
+
+    generation.fetch_add(1, std::memory_order_release);
+
+    DBG("HIDDeviceRegistry: Device set changed, " << getCachedList()->size() << " device(s)");
+    return true;
+}
+
+} // namespace bs_hid
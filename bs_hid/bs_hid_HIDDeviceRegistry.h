@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+   HID Device Registry - Cached, hotplug-refreshed device list
+
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace bs_hid
+{
+
+/**
+    Process-wide cache of the connected HID devices.
+
+    The registry enumerates once on construction and then watches for hotplug
+    on a low-priority background thread. HIDDeviceInfo entries are only built
+    when a device path appears, so unchanged devices keep their cached strings
+    and getDevices() never touches hidapi. A change message is broadcast (on
+    the message thread) whenever the device set changes.
+
+    Share it with juce::SharedResourcePointer<HIDDeviceRegistry>.
+*/
+class HIDDeviceRegistry : public juce::ChangeBroadcaster,
+                          private juce::Thread
+{
+public:
+    //==============================================================================
+    HIDDeviceRegistry();
+    ~HIDDeviceRegistry() override;
+
+    //==============================================================================
+    /** Returns the cached device list. Never enumerates, safe from the message thread */
+    std::vector<HIDDeviceInfo> getDevices() const;
+
+    /** Returns cached devices matching VID/PID (0 matches any) */
+    std::vector<HIDDeviceInfo> getDevices(uint16_t vendorId, uint16_t productId) const;
+
+    /** Asks the background thread to rescan immediately */
+    void refresh();
+
+    /** Incremented every time the device set changes */
+    int getGeneration() const noexcept { return generation.load(std::memory_order_acquire); }
+
+    //==============================================================================
+    /** Set how often the hotplug watcher rescans (default: 1000ms) */
+    void setScanIntervalMs(int intervalMs) { scanIntervalMs.store(juce::jmax(50, intervalMs)); }
+
+    /** Get the hotplug scan interval */
+    int getScanIntervalMs() const { return scanIntervalMs.load(); }
+
+private:
+    //==============================================================================
+    using DeviceList = std::vector<HIDDeviceInfo>;
+
+    void run() override;
+
+    /** Enumerates device paths and rebuilds the cache if the set changed.
+        Returns true if the cache was updated */
+    bool rescan();
+
+    std::shared_ptr<const DeviceList> getCachedList() const;
+
+    //==============================================================================
+    juce::SharedResourcePointer<HIDContext> hidContext;
+
+    // Swapped wholesale on hotplug; readers only hold the lock for a pointer copy
+    std::shared_ptr<const DeviceList> cachedDevices;
+    mutable juce::SpinLock cacheLock;
+
+    std::atomic<int> generation{0};
+    std::atomic<int> scanIntervalMs{1000};
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HIDDeviceRegistry)
+};
+
+} // namespace bs_hid
@@ -0,0 +1,173 @@
+/*
+  ==============================================================================
+
+   HID Hub Implementation
+
+  ==============================================================================
+*/
+
+// This file should only be included via bs_hid.cpp
+// But if compiled standalone, include the necessary headers
+#ifndef BS_HID_H_INCLUDED
+    #include "bs_hid.h"
+#endif
+
+namespace bs_hid
+{
+
+//==============================================================================
+HIDHub::Subscriber::Subscriber(HIDHub& hub, int queueCapacity)
+    : Subscriber(hub, Options { Delivery::queued, queueCapacity, 60, {} })
+{
+}
+
+HIDHub::Subscriber::Subscriber(HIDHub& hub, Options options)
+    : owner(hub),
+      delivery(options.delivery),
+      callback(std::move(options.callback)),
+      fifo(delivery == Delivery::queued ? juce::jmax(2, options.queueCapacity) : 2),
+      queue(delivery == Delivery::queued ? (size_t) juce::jmax(2, options.queueCapacity) : 0)
+{
+    // Realtime and coalesced subscribers have nothing to do without a callback
+    jassert(delivery == Delivery::queued || callback != nullptr);
+
+    if (delivery == Delivery::coalesced)
+        startTimerHz(juce::jmax(1, options.rateHz));
+
+    owner.addSubscriber(this);
+}
+
+HIDHub::Subscriber::~Subscriber()
+{
+    stopTimer();
+    owner.removeSubscriber(this);
+}
+
+void HIDHub::Subscriber::pushFrame(const TouchFrame& frame)
+{
+    latestFrame.store(frame);
+
+    if (delivery == Delivery::realtime)
+    {
+        callback(frame);
+        return;
+    }
+
+    if (delivery != Delivery::queued)
+        return;
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(1, start1, size1, start2, size2);
+
+    if (size1 > 0)
+    {
+        queue[(size_t) start1] = frame;
+        fifo.finishedWrite(1);
+    }
+    else
+    {
+        droppedFrames.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void HIDHub::Subscriber::timerCallback()
+{
+    auto frame = latestFrame.load();
+
+    // Only deliver when something new arrived since the last tick
+    if (frame.sequence == lastDeliveredSequence)
+        return;
+
+    lastDeliveredSequence = frame.sequence;
+    callback(frame);
+}
+
+bool HIDHub::Subscriber::popFrame(TouchFrame& frame) noexcept
+{
+    if (delivery != Delivery::queued)
+        return false;
+
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(1, start1, size1, start2, size2);
+
+    if (size1 == 0)
+        return false;
+
+    frame = queue[(size_t) start1];
+    fifo.finishedRead(1);
+    return true;
+}
+
+//==============================================================================
+HIDHub::HIDHub()
+{
+    calibrationManager.loadFromFile();
+    deviceManager.setCalibrationManager(&calibrationManager);
+    deviceManager.addListener(this);
+
+    connectToKnownTouchDevice();
+    deviceManager.enableAutoReconnect(getKnownTouchDevices(), 2000);
+}
+
+HIDHub::~HIDHub()
+{
+    deviceManager.disableAutoReconnect();
+    deviceManager.disconnectFromDevice();
+    deviceManager.removeListener(this);
+}
+
+//==============================================================================
+const std::vector<std::pair<uint16_t, uint16_t>>& HIDHub::getKnownTouchDevices()
+{
+    static const std::vector<std::pair<uint16_t, uint16_t>> knownDevices
+    {
+        { 0x03EB, 0x8A6E },  // ELO Touch (Atmel maXTouch)
+        { 0x2575, 0x7317 }   // Standard touch digitizer
+    };
+
+    return knownDevices;
+}
+
+bool HIDHub::connectToKnownTouchDevice()
+{
+    if (deviceManager.isDeviceConnected())
+        return true;
+
+    for (const auto& [vendorId, productId] : getKnownTouchDevices())
+    {
+        for (const auto& device : deviceManager.getAvailableDevices(vendorId, productId))
+        {
+            if (deviceManager.connectToDevice(device))
+            {
+                DBG("HIDHub: Connected to " << device.manufacturer << " - " << device.product);
+                return true;
+            }
+        }
+    }
+
+    DBG("HIDHub: No known touch device found");
+    return false;
+}
+
+//==============================================================================
+void HIDHub::addSubscriber(Subscriber* subscriber)
+{
+    subscribers.add(subscriber);
+}
+
+void HIDHub::removeSubscriber(Subscriber* subscriber)
+{
+    subscribers.remove(subscriber);
+}
+
+int HIDHub::getNumSubscribers() const noexcept
+{
+    return subscribers.size();
+}
+
+void HIDHub::touchFrameReceived(const TouchFrame& frame)
+{
+    subscribers.call([&](Subscriber& subscriber) { subscriber.pushFrame(frame); });
+}
+
+} // namespace bs_hid
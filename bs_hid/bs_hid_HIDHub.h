@@ -0,0 +1,163 @@
+/*
+  ==============================================================================
+
+   HID Hub - One device connection shared by every plugin instance in a process
+
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace bs_hid
+{
+
+/**
+    Shares a single HIDDeviceManager between every consumer in the process.
+
+    Each physical device is opened once and read by one polling thread.
+    Decoded frames are fanned out to every Subscriber through a lock-free
+    latest-frame snapshot and, depending on its delivery class, a lock-free
+    FIFO, so any number of plugin instances can follow the same touchscreen
+    without competing for it.
+
+    Hold it with juce::SharedResourcePointer<HIDHub>. The hub connects to the
+    first known touch device on creation and keeps auto-reconnect enabled.
+
+    @code
+    juce::SharedResourcePointer<bs_hid::HIDHub> hidHub;
+    bs_hid::HIDHub::Subscriber hidSubscriber { *hidHub };
+
+    void processBlock (...)
+    {
+        bs_hid::TouchFrame frame;
+        while (hidSubscriber.popFrame (frame))
+            ...
+    }
+    @endcode
+*/
+class HIDHub : private HIDDeviceManager::Listener
+{
+public:
+    //==============================================================================
+    HIDHub();
+    ~HIDHub() override;
+
+    //==============================================================================
+    /** How a Subscriber receives frames */
+    enum class Delivery
+    {
+        realtime,   // Callback runs inline on the HID thread for every frame. Must be wait-free
+        queued,     // Every frame goes through a lock-free FIFO; the consumer calls popFrame()
+        coalesced   // Only the latest frame is kept; the callback runs on the message thread at a fixed rate
+    };
+
+    /** Called with each delivered frame (see Delivery for the calling thread) */
+    using FrameCallback = std::function<void(const TouchFrame&)>;
+
+    /**
+        A consumer's view of the hub's frame stream.
+
+        Both read methods are lock-free and allocation-free, so they are safe
+        to call from the audio thread. popFrame() must only be called from one
+        consumer thread.
+
+        Only realtime subscribers run code on the HID thread. Queued and
+        coalesced subscribers cost the HID thread one frame copy each, so a
+        slow consumer can never delay the others.
+    */
+    class Subscriber : private juce::Timer
+    {
+    public:
+        struct Options
+        {
+            Delivery delivery = Delivery::queued;
+            int queueCapacity = 256;        // queued: number of frames buffered
+            int rateHz = 60;                // coalesced: callback rate
+            FrameCallback callback;         // realtime and coalesced
+        };
+
+        /** Subscribes with queued delivery. queueCapacity is the number of frames buffered */
+        explicit Subscriber(HIDHub& hub, int queueCapacity = 256);
+
+        /** Subscribes with the given delivery class */
+        Subscriber(HIDHub& hub, Options options);
+
+        /** Unsubscribes. Once this returns, the hub no longer touches this object */
+        ~Subscriber() override;
+
+        /** Returns this subscriber's delivery class */
+        Delivery getDelivery() const noexcept { return delivery; }
+
+        //==============================================================================
+        /** Returns the most recently published frame */
+        TouchFrame getLatestFrame() const noexcept { return latestFrame.load(); }
+
+        /** Returns the primary contact of the most recent frame */
+        TouchData getLatestTouchData() const noexcept { return latestFrame.load().getPrimaryTouch(); }
+
+        /** Pops the oldest queued frame. Returns false if the queue is empty or
+            this subscriber is not queued */
+        bool popFrame(TouchFrame& frame) noexcept;
+
+        /** Number of frames dropped because the queue was full */
+        int getNumDroppedFrames() const noexcept { return droppedFrames.load(std::memory_order_relaxed); }
+
+    private:
+        friend class HIDHub;
+
+        /** Called from the HID thread */
+        void pushFrame(const TouchFrame& frame);
+
+        /** Coalesced delivery on the message thread */
+        void timerCallback() override;
+
+        HIDHub& owner;
+        const Delivery delivery;
+        FrameCallback callback;
+        uint32_t lastDeliveredSequence = 0;
+        SeqLockValue<TouchFrame> latestFrame;
+        juce::AbstractFifo fifo;
+        std::vector<TouchFrame> queue;
+        std::atomic<int> droppedFrames{0};
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Subscriber)
+    };
+
+    //==============================================================================
+    /** Returns the shared device manager, e.g. for diagnostics or manual device selection.
+        Connecting or disconnecting here affects every subscriber. */
+    HIDDeviceManager& getDeviceManager() noexcept { return deviceManager; }
+
+    /** Returns the calibration applied to every published frame */
+    TouchCalibrationManager& getCalibrationManager() noexcept { return calibrationManager; }
+
+    /** Connects to the first available device from getKnownTouchDevices() */
+    bool connectToKnownTouchDevice();
+
+    /** VID/PID pairs of the touch devices the hub connects to automatically */
+    static const std::vector<std::pair<uint16_t, uint16_t>>& getKnownTouchDevices();
+
+    /** Returns the number of currently registered subscribers */
+    int getNumSubscribers() const noexcept;
+
+private:
+    //==============================================================================
+    void addSubscriber(Subscriber* subscriber);
+    void removeSubscriber(Subscriber* subscriber);
+
+    // HIDDeviceManager::Listener (HID thread)
+    void touchDetected(const TouchData&) override {}
+    void touchFrameReceived(const TouchFrame& frame) override;
+
+    //==============================================================================
+    TouchCalibrationManager calibrationManager;     // Declared first: outlives the device manager
+    HIDDeviceManager deviceManager;
+
+    // Iterated lock-free on the HID thread; removal waits for in-flight dispatches
+    RealtimeListenerList<Subscriber> subscribers;
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HIDHub)
+};
+
+} // namespace bs_hid
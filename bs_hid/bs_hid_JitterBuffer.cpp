@@ -0,0 +1,215 @@
+/*
+  ==============================================================================
+
+   Jitter Buffer Implementation
+
+  ==============================================================================
+*/
+
+// This file should only be included via bs_hid.cpp
+// But if compiled standalone, include the necessary headers
+#ifndef BS_HID_H_INCLUDED
+    #include "bs_hid.h"
+#endif
+
+namespace bs_hid
+{
+
+//==============================================================================
+void JitterBuffer::Histogram::add(double valueMs) noexcept
+{
+    // Old measurements fade by halving, so a count never overflows
+    if (total >= (1u << 20))
+    {
+        total = 0;
+
+        for (auto& bin : bins)
+        {
+            bin /= 2;
+            total += bin;
+        }
+    }
+
+    const int bin = juce::jlimit(0, numBins - 1, (int) (valueMs / binWidthMs));
+    ++bins[(size_t) bin];
+    ++total;
+}
+
+double JitterBuffer::Histogram::getQuantile(double quantile) const noexcept
+{
+    if (total == 0)
+        return 0.0;
+
+    const double target = quantile * total;
+    double count = 0.0;
+
+    // The upper edge of the bin, so the result covers every value in it
+    for (int i = 0; i < numBins; ++i)
+    {
+        count += bins[(size_t) i];
+
+        if (count >= target)
+            return (i + 1) * binWidthMs;
+    }
+
+    return numBins * binWidthMs;
+}
+
+//==============================================================================
+void JitterBuffer::reset() noexcept
+{
+    hasBlock = false;
+    numWaiting = 0;
+    clearMeasurements();
+    publishedStats.store(stats);
+}
+
+void JitterBuffer::clearMeasurements() noexcept
+{
+    requiredDelay.clear();
+    reportJitter.clear();
+    callbackJitter.clear();
+    lastReportMs = averageIntervalMs = 0.0;
+    autoDelayMs = 0.0;
+    stats = {};
+}
+
+void JitterBuffer::beginBlock(const AudioClock& clock, int numSamples) noexcept
+{
+    currentOptions = options.load();
+
+    if (resetRequested.exchange(false, std::memory_order_acq_rel))
+        clearMeasurements();
+
+    // After a stall, and at the start when whatever queued up before playback is stale,
+    // this block's frames are kept out of the measurements
+    resyncedThisBlock = clock.wasReset();
+
+    if (resyncedThisBlock && hasBlock)
+        ++stats.numResyncs;
+
+    if (! resyncedThisBlock)
+        callbackJitter.add(std::abs(clock.getCallbackErrorMs()));
+
+    hasBlock = true;
+    mapping = clock.getCurrentMapping();
+    blockStartSample = clock.getBlockStartSample();
+    blockStartMs = clock.getBlockStartMs();
+    blockSamples = numSamples;
+    blockDurationMs = numSamples / mapping.samplesPerMs;
+
+    updateDelay();
+
+    stats.delayMs = delayMs;
+    stats.requiredDelayMs = requiredDelay.getQuantile(currentOptions.quantile);
+    stats.reportJitterMs = reportJitter.getQuantile(0.99);
+    stats.callbackJitterMs = callbackJitter.getQuantile(0.99);
+    publishedStats.store(stats);
+}
+
+void JitterBuffer::updateDelay() noexcept
+{
+    const double measuredMs = requiredDelay.getQuantile(currentOptions.quantile) + currentOptions.marginMs;
+
+    if (! stats.isSized)
+    {
+        if ((int) requiredDelay.getCount() >= currentOptions.minMeasurements)
+        {
+            autoDelayMs = measuredMs;
+            stats.isSized = true;
+        }
+        else
+        {
+            // Until measured: a callback period of waiting, and as much again for jitter
+            autoDelayMs = 2.0 * blockDurationMs + currentOptions.marginMs;
+        }
+    }
+    else
+    {
+        // Growing shifts the timing once; shrinking would too, so it waits for resetMeasurements()
+        autoDelayMs = juce::jmax(autoDelayMs, measuredMs);
+    }
+
+    // Past the histograms' range a measurement only says "at least maxDelayMs", so hold there
+    const double wantedMs = currentOptions.fixedDelayMs > 0.0 ? currentOptions.fixedDelayMs : autoDelayMs;
+    stats.isDelayClamped = wantedMs > maxDelayMs;
+    delayMs = juce::jmin(wantedMs, maxDelayMs);
+}
+
+//==============================================================================
+void JitterBuffer::push(const TouchFrame& frame) noexcept
+{
+    const double reportMs = frame.scanTimeMs;
+
+    // Report jitter: how far each interval strays from the recent average
+    if (lastReportMs > 0.0)
+    {
+        const double intervalMs = reportMs - lastReportMs;
+
+        if (intervalMs > 0.0 && intervalMs < maxReportGapMs)
+        {
+            if (averageIntervalMs > 0.0)
+                reportJitter.add(std::abs(intervalMs - averageIntervalMs));
+
+            averageIntervalMs = averageIntervalMs > 0.0 ? averageIntervalMs + (intervalMs - averageIntervalMs) * 0.05
+                                                        : intervalMs;
+        }
+    }
+
+    lastReportMs = reportMs;
+
+    // The delay this frame needed: from its report to the start of the first block able to play it
+    if (! resyncedThisBlock)
+        requiredDelay.add(juce::jmax(0.0, blockStartMs - reportMs));
+
+    if (numWaiting == capacity)
+    {
+        oldest = (oldest + 1) % capacity;
+        --numWaiting;
+        ++stats.numDropped;
+    }
+
+    frames[(size_t) ((oldest + numWaiting) % capacity)] = frame;
+    ++numWaiting;
+}
+
+bool JitterBuffer::popDueFrame(TouchFrame& frame, int& sampleOffset) noexcept
+{
+    if (numWaiting == 0)
+        return false;
+
+    const auto& next = frames[(size_t) oldest];
+    const double offsetSamples = mapping.timeToSample(next.scanTimeMs + delayMs) - (double) blockStartSample;
+    int offset = juce::roundToInt(offsetSamples);
+
+    // Due in a later block
+    if (offset >= blockSamples)
+        return false;
+
+    if (offset < 0)
+    {
+        ++stats.numLate;
+        stats.worstLateMs = juce::jmax(stats.worstLateMs, -offsetSamples / mapping.samplesPerMs);
+        offset = 0;
+    }
+
+    frame = next;
+    sampleOffset = offset;
+    oldest = (oldest + 1) % capacity;
+    --numWaiting;
+    ++stats.numFrames;
+    return true;
+}
+
+bool JitterBuffer::flushFrame(TouchFrame& frame) noexcept
+{
+    if (numWaiting == 0)
+        return false;
+
+    frame = frames[(size_t) oldest];
+    oldest = (oldest + 1) % capacity;
+    --numWaiting;
+    return true;
+}
+
+} // namespace bs_hid
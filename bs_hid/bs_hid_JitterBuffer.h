@@ -0,0 +1,165 @@
+/*
+  ==============================================================================
+
+   Jitter Buffer - Plays touch frames at a constant delay after their reports
+
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace bs_hid
+{
+
+/**
+    Holds touch frames on the audio thread and plays each one exactly
+    getDelayMs() after its TouchFrame::scanTimeMs, so every touch reaches
+    the output with the same latency.
+
+    Played as soon as possible, a frame waits anywhere from nothing to a whole
+    callback period plus the callback's own jitter before a block picks it up,
+    so the delay from touch to sound varies by more than a block. For rhythmic
+    playing a constant delay is better than a small one that wanders.
+
+    Each frame is due at scanTimeMs + delay, placed on the sample timeline
+    by an AudioClock so that neither the callbacks' jitter nor the sound
+    card's drift moves it. It is handed out in the block that contains that
+    moment, at the matching sample offset.
+
+    For every frame the buffer measures how much delay it would have needed to
+    be on time: how far the start of the first block that could play it lies
+    after its report. That combines how long the report took to arrive, where
+    in the callback period it landed and how late the callback ran. The delay
+    is sized from a histogram of those measurements, to the smallest value
+    that keeps Options::quantile of the frames on time, plus a margin. Once
+    sized it only ever grows, so the latency stays constant while playing;
+    resetMeasurements() starts again. The histogram covers up to maxDelayMs,
+    the longest delay used, automatic or fixed. Beyond it frames play late
+    and Stats::isDelayClamped reports it.
+    Histograms of report interval jitter and callback jitter are kept as well,
+    for diagnostics.
+
+    A frame that still arrives too late is played at the start of the block and
+    counted in Stats::numLate.
+
+    Call beginBlock() at the start of every processBlock(), then push() every
+    new frame, then popDueFrame() until it returns false. None of them allocate
+    or lock. getStats(), setOptions() and resetMeasurements() can be called from
+    any thread.
+*/
+class JitterBuffer
+{
+public:
+    //==============================================================================
+    static constexpr double maxDelayMs = 100.0;     // Longest delay from report to playback
+    static constexpr int capacity = 256;            // Frames waiting to play: maxDelayMs at 2.5 kHz
+    static constexpr double binWidthMs = 0.125;
+    static constexpr int numBins = (int) (maxDelayMs / binWidthMs);     // Histograms cover 0..maxDelayMs
+
+    struct Options
+    {
+        double fixedDelayMs = 0.0;      // Delay from report to playback, up to maxDelayMs; 0 sizes it from the measurements
+        double quantile = 0.999;        // Fraction of frames the automatic delay keeps on time
+        double marginMs = 0.5;          // Added to the automatic delay
+        int minMeasurements = 200;      // Frames measured before the delay is first sized
+    };
+
+    struct Stats
+    {
+        double delayMs = 0.0;               // Delay from report to playback now in use
+        double requiredDelayMs = 0.0;       // Delay that would have kept Options::quantile of frames on time
+        double reportJitterMs = 0.0;        // 99th percentile deviation of report intervals
+        double callbackJitterMs = 0.0;      // 99th percentile deviation of callback times
+        double worstLateMs = 0.0;           // Furthest past its time a frame has been played
+        uint32_t numFrames = 0;             // Frames played
+        uint32_t numLate = 0;               // Frames that arrived after their time
+        uint32_t numDropped = 0;            // Frames lost because the buffer was full
+        uint32_t numResyncs = 0;            // Times the audio clock restarted after a stall
+        bool isSized = false;               // False while the automatic delay is still a first guess
+        bool isDelayClamped = false;        // The delay wanted is beyond maxDelayMs, so frames may play late
+    };
+
+    //==============================================================================
+    JitterBuffer() = default;
+
+    /** Forgets every frame and measurement. Call from prepareToPlay() */
+    void reset() noexcept;
+
+    /** Starts a block of numSamples, after AudioClock::update() for it */
+    void beginBlock(const AudioClock& clock, int numSamples) noexcept;
+
+    /** Queues a frame to play getDelayMs() after its scanTimeMs */
+    void push(const TouchFrame& frame) noexcept;
+
+    /** Takes the next frame due in this block and its sample offset, or returns false */
+    bool popDueFrame(TouchFrame& frame, int& sampleOffset) noexcept;
+
+    /** Takes the oldest waiting frame even if it is not due yet, or returns false.
+        Use it to play everything still held when switching to immediate delivery */
+    bool flushFrame(TouchFrame& frame) noexcept;
+
+    /** Where the audio clock puts the current block's first sample */
+    double getBlockStartMs() const noexcept { return blockStartMs; }
+
+    /** Delay from report to playback in use for the current block */
+    double getDelayMs() const noexcept { return delayMs; }
+
+    //==============================================================================
+    /** Changes the options from the next block */
+    void setOptions(const Options& newOptions) noexcept { options.store(newOptions); }
+    Options getOptions() const noexcept { return options.load(); }
+
+    /** Forgets the measurements, so the delay is sized again from the next frames */
+    void resetMeasurements() noexcept { resetRequested.store(true, std::memory_order_release); }
+
+    /** Counters and measured jitter, as of the start of the current block */
+    Stats getStats() const noexcept { return publishedStats.load(); }
+
+private:
+    //==============================================================================
+    class Histogram
+    {
+    public:
+        void add(double valueMs) noexcept;
+        double getQuantile(double quantile) const noexcept;
+        uint32_t getCount() const noexcept { return total; }
+        void clear() noexcept { bins = {}; total = 0; }
+
+    private:
+        std::array<uint32_t, numBins> bins {};
+        uint32_t total = 0;
+    };
+
+    static constexpr double maxReportGapMs = 50.0;      // Longer gaps between reports are new touches
+
+    void clearMeasurements() noexcept;
+    void updateDelay() noexcept;
+
+    //==============================================================================
+    SeqLockValue<Options> options;
+    SeqLockValue<Stats> publishedStats;
+    std::atomic<bool> resetRequested { false };
+
+    Options currentOptions;
+    Stats stats;
+
+    // The current block on the audio clock
+    AudioClock::Mapping mapping;
+    juce::int64 blockStartSample = 0;
+    int blockSamples = 0;
+    double blockStartMs = 0.0, blockDurationMs = 0.0;
+    bool hasBlock = false, resyncedThisBlock = false;
+    double delayMs = 0.0, autoDelayMs = 0.0;
+
+    // Measurements
+    Histogram requiredDelay, reportJitter, callbackJitter;
+    double lastReportMs = 0.0, averageIntervalMs = 0.0;
+
+    // Frames waiting, oldest first
+    std::array<TouchFrame, capacity> frames;
+    int oldest = 0, numWaiting = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(JitterBuffer)
+};
+
+} // namespace bs_hid
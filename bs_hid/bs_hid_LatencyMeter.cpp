@@ -0,0 +1,143 @@
+/*
+  ==============================================================================
+
+   Latency Meter Implementation
+
+  ==============================================================================
+*/
+
+// This file should only be included via bs_hid.cpp
+// But if compiled standalone, include the necessary headers
+#ifndef BS_HID_H_INCLUDED
+    #include "bs_hid.h"
+#endif
+
+namespace bs_hid
+{
+
+//==============================================================================
+void LatencyMeter::prepare(double sampleRate) noexcept
+{
+    samplesPerMs = sampleRate * 0.001;
+    clickPending = false;
+    holdOffUntil = 0;
+    clearMeasurements();
+}
+
+void LatencyMeter::clearMeasurements() noexcept
+{
+    stats = {};
+    distribution = {};
+    recent = {};
+    nextRecent = 0;
+
+    publishedStats.store(stats);
+    publishedDistribution.store(distribution);
+    publishedRecent.store(recent);
+}
+
+//==============================================================================
+void LatencyMeter::addClick(double touchTimeMs, juce::int64 samplePosition) noexcept
+{
+    // The one before is still out: whichever returns next couldn't be told apart
+    if (clickPending)
+    {
+        ++stats.numMissed;
+        publishedStats.store(stats);
+    }
+
+    clickPending = true;
+    clickTouchMs = touchTimeMs;
+    clickSample = samplePosition;
+}
+
+void LatencyMeter::processInput(const float* input, int blockOffset, int numSamples, const AudioClock& clock) noexcept
+{
+    currentOptions = options.load();
+
+    if (resetRequested.exchange(false, std::memory_order_acq_rel))
+        clearMeasurements();
+
+    const juce::int64 start = clock.getBlockStartSample() + blockOffset;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const juce::int64 position = start + i;
+
+        if (position < holdOffUntil || std::abs(input[i]) < currentOptions.threshold)
+            continue;
+
+        holdOffUntil = position + (juce::int64) (currentOptions.holdOffMs * samplesPerMs);
+
+        // Anything arriving before the click was written can't be it
+        if (clickPending && position >= clickSample)
+        {
+            clickPending = false;
+            addMeasurement(clock.sampleToTime((double) position) - clickTouchMs,
+                           (double) (position - clickSample) / samplesPerMs);
+        }
+        else
+        {
+            ++stats.numUnmatched;
+            publishedStats.store(stats);
+        }
+    }
+
+    if (clickPending && (double) (start + numSamples - clickSample) > currentOptions.timeoutMs * samplesPerMs)
+    {
+        clickPending = false;
+        ++stats.numMissed;
+        publishedStats.store(stats);
+    }
+}
+
+//==============================================================================
+void LatencyMeter::addMeasurement(double latencyMs, double roundTripMs) noexcept
+{
+    stats.lastMs = latencyMs;
+    stats.roundTripMs = roundTripMs;
+    ++stats.numMeasurements;
+
+    const int bin = juce::jlimit(0, numBins - 1, (int) (latencyMs / binWidthMs));
+    ++distribution[(size_t) bin];
+
+    recent.latencyMs[(size_t) nextRecent] = latencyMs;
+    nextRecent = (nextRecent + 1) % maxMeasurements;
+    recent.numMeasurements = juce::jmin(recent.numMeasurements + 1, maxMeasurements);
+
+    // The spread is left to getStats(), off the audio thread
+    publishedStats.store(stats);
+    publishedDistribution.store(distribution);
+    publishedRecent.store(recent);
+}
+
+LatencyMeter::Stats LatencyMeter::getStats() const
+{
+    auto result = publishedStats.load();
+    auto measured = publishedRecent.load();
+    const int n = measured.numMeasurements;
+
+    if (n == 0)
+        return result;
+
+    auto& sorted = measured.latencyMs;
+    std::sort(sorted.begin(), sorted.begin() + n);
+
+    double sum = 0.0, sumSquares = 0.0;
+
+    for (int i = 0; i < n; ++i)
+    {
+        sum += sorted[(size_t) i];
+        sumSquares += sorted[(size_t) i] * sorted[(size_t) i];
+    }
+
+    result.minMs = sorted[0];
+    result.maxMs = sorted[(size_t) n - 1];
+    result.medianMs = sorted[(size_t) n / 2];
+    result.p95Ms = sorted[(size_t) juce::jmin(n - 1, (int) (n * 0.95))];
+    result.meanMs = sum / n;
+    result.stdDevMs = std::sqrt(juce::jmax(0.0, sumSquares / n - result.meanMs * result.meanMs));
+    return result;
+}
+
+} // namespace bs_hid
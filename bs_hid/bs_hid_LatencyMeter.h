@@ -0,0 +1,136 @@
+/*
+  ==============================================================================
+
+   Latency Meter - Touch-to-audio latency from clicks returned through a loopback
+
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace bs_hid
+{
+
+/**
+    Measures how long each touch takes to come out as sound, by listening for
+    its click on the audio input.
+
+    The output is wired back to the input, by a cable or a simulated loopback.
+    Every click written for a touch is passed to addClick() together with the
+    touch's report time; processInput() then watches the input for the click
+    to return. The first sample above Options::threshold is the onset, and
+    its position, placed on the report clock by an AudioClock, gives the
+    latency: from the report to the click coming back.
+
+    With a cable the click also passes the input converter on its way back,
+    so the result includes the input latency as well as the output latency.
+    Stats::roundTripMs shows how much of it is the audio path alone. Through
+    a simulated loopback with no delay the click returns at the sample it was
+    written, which measures the software path: report to output buffer.
+
+    Only one click is followed at a time. A click that doesn't return within
+    Options::timeoutMs, or is overtaken by the next one, counts as missed; an
+    onset with no click waiting counts as unmatched.
+
+    Call addClick() and processInput() on the audio thread; neither allocates,
+    locks or sorts. getStats() works out the percentiles from the published
+    measurements, so call it from the UI rather than the audio thread.
+    getStats(), getDistribution(), setOptions() and resetMeasurements() can be
+    called from any thread.
+*/
+class LatencyMeter
+{
+public:
+    //==============================================================================
+    static constexpr int numBins = 200;
+    static constexpr double binWidthMs = 0.5;           // The distribution covers 0..100 ms
+    static constexpr int maxMeasurements = 1024;        // Recent measurements the percentiles come from
+
+    struct Options
+    {
+        float threshold = 0.1f;         // Input level that marks the click's onset
+        double timeoutMs = 500.0;       // A click not back by then is missed
+        double holdOffMs = 50.0;        // Onsets this soon after the last are its ringing
+    };
+
+    /** The spread covers the last maxMeasurements touches, the counters every touch since the reset */
+    struct Stats
+    {
+        double lastMs = 0.0;            // Report to returned click, for the newest touch
+        double minMs = 0.0;
+        double medianMs = 0.0;
+        double p95Ms = 0.0;
+        double maxMs = 0.0;
+        double meanMs = 0.0;
+        double stdDevMs = 0.0;
+        double roundTripMs = 0.0;       // Click written to click returned, for the newest touch
+        uint32_t numMeasurements = 0;
+        uint32_t numMissed = 0;         // Clicks that never came back
+        uint32_t numUnmatched = 0;      // Onsets with no click waiting
+    };
+
+    /** Measurements counted per binWidthMs, the last bin holding everything above */
+    using Distribution = std::array<uint32_t, numBins>;
+
+    //==============================================================================
+    LatencyMeter() = default;
+
+    /** Forgets the click being followed and every measurement. Call from prepareToPlay() */
+    void prepare(double sampleRate) noexcept;
+
+    /** A click for the touch reported at touchTimeMs was written at this output sample position */
+    void addClick(double touchTimeMs, juce::int64 samplePosition) noexcept;
+
+    /** Looks for onsets in numSamples of input starting at blockOffset in the current block,
+        after AudioClock::update() for it */
+    void processInput(const float* input, int blockOffset, int numSamples, const AudioClock& clock) noexcept;
+
+    //==============================================================================
+    void setOptions(const Options& newOptions) noexcept { options.store(newOptions); }
+    Options getOptions() const noexcept { return options.load(); }
+
+    /** Forgets the measurements from the next block */
+    void resetMeasurements() noexcept { resetRequested.store(true, std::memory_order_release); }
+
+    /** Sorts a copy of the recent measurements for the spread, so it is not for the audio thread */
+    Stats getStats() const;
+    Distribution getDistribution() const noexcept { return publishedDistribution.load(); }
+
+private:
+    //==============================================================================
+    /** The last maxMeasurements latencies, the oldest overwritten first */
+    struct Recent
+    {
+        std::array<double, maxMeasurements> latencyMs {};
+        int numMeasurements = 0;
+    };
+
+    void addMeasurement(double latencyMs, double roundTripMs) noexcept;
+    void clearMeasurements() noexcept;
+
+    //==============================================================================
+    SeqLockValue<Options> options;
+    SeqLockValue<Stats> publishedStats;                 // Counters and the newest touch only
+    SeqLockValue<Distribution> publishedDistribution;
+    SeqLockValue<Recent> publishedRecent;
+    std::atomic<bool> resetRequested { false };
+
+    double samplesPerMs = 44.1;
+    Options currentOptions;
+
+    // The click on its way back
+    bool clickPending = false;
+    double clickTouchMs = 0.0;
+    juce::int64 clickSample = 0;
+    juce::int64 holdOffUntil = 0;
+
+    // Measurements
+    Stats stats;
+    Distribution distribution {};
+    Recent recent;
+    int nextRecent = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LatencyMeter)
+};
+
+} // namespace bs_hid
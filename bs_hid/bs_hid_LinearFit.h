@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+   Linear Fit - Exponentially weighted least-squares line between two clocks
+
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace bs_hid
+{
+
+/**
+    A least-squares line through (x, y) points, each older point weighted
+    down by the decay passed with every new one.
+
+    Used to relate two clocks that run at nearly the same rate, where x and y
+    grow without bound: the sums are kept relative to the newest point, so
+    they stay small and keep their precision however long it runs.
+
+    Plain arithmetic on a few doubles; add() never allocates or locks.
+*/
+class LinearFit
+{
+public:
+    //==============================================================================
+    /** Forgets every point and starts again from this one */
+    void reset(double x, double y) noexcept
+    {
+        referenceX = x;
+        referenceY = y;
+        sumW = 1.0;
+        sumX = sumY = sumXX = sumXY = 0.0;
+    }
+
+    /** Multiplies the weight of every earlier point by weightDecay, then adds this one */
+    void add(double x, double y, double weightDecay) noexcept
+    {
+        sumW *= weightDecay;
+        sumX *= weightDecay;
+        sumY *= weightDecay;
+        sumXX *= weightDecay;
+        sumXY *= weightDecay;
+
+        // Move the origin to the new point: only the new point is ever added at (0, 0)
+        const double dx = x - referenceX;
+        const double dy = y - referenceY;
+
+        sumXY += dx * dy * sumW - dx * sumY - dy * sumX;
+        sumXX += dx * dx * sumW - 2.0 * dx * sumX;
+        sumX -= dx * sumW;
+        sumY -= dy * sumW;
+
+        referenceX = x;
+        referenceY = y;
+        sumW += 1.0;
+    }
+
+    //==============================================================================
+    /** The weighted mean of the points, which the line runs through */
+    double getMeanX() const noexcept { return referenceX + sumX / sumW; }
+    double getMeanY() const noexcept { return referenceY + sumY / sumW; }
+
+    /** The newest point's x, to work out the next point's decay from */
+    double getLastX() const noexcept { return referenceX; }
+
+    /** The least-squares slope, limited to [minSlope, maxSlope]. Until the points span
+        at least minSpreadX it can't be measured, and fallbackSlope is returned */
+    double getSlope(double fallbackSlope, double minSlope, double maxSlope, double minSpreadX) const noexcept
+    {
+        const double meanX = sumX / sumW;
+        const double meanY = sumY / sumW;
+        const double varianceX = sumXX / sumW - meanX * meanX;
+
+        if (varianceX <= minSpreadX * minSpreadX)
+            return fallbackSlope;
+
+        return juce::jlimit(minSlope, maxSlope, (sumXY / sumW - meanX * meanY) / varianceX);
+    }
+
+private:
+    //==============================================================================
+    double referenceX = 0.0, referenceY = 0.0;
+    double sumW = 0.0, sumX = 0.0, sumY = 0.0, sumXX = 0.0, sumXY = 0.0;
+};
+
+} // namespace bs_hid
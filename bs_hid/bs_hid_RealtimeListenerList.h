@@ -0,0 +1,184 @@
+/*
+  ==============================================================================
+
+   Realtime Listener List - Lock-free iteration with RCU-style registration
+
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace bs_hid
+{
+
+/**
+    A listener list that a realtime thread can iterate without locks.
+
+    Registration never modifies the array the dispatch thread is reading.
+    add() and remove() build a new immutable array and publish it with one
+    atomic pointer swap. call() only touches two atomic counters around the
+    iteration, so it never blocks and never allocates.
+
+    Old arrays are reclaimed after a grace period: remove() flips the reader
+    epoch and waits until every call() that started under the previous epoch
+    has finished. Once remove() returns, no callback on the removed listener
+    is in flight or will ever start, so the listener can be deleted straight
+    away, e.g. when an editor closes mid-performance.
+
+    remove() must not be called from inside one of this list's callbacks,
+    because it would wait for itself (debug builds assert on this for any list
+    of the same listener type). add() never waits and is safe anywhere.
+*/
+template <typename ListenerType>
+class RealtimeListenerList
+{
+public:
+    //==============================================================================
+    RealtimeListenerList() = default;
+
+    ~RealtimeListenerList()
+    {
+        delete current.load();
+
+        for (auto* snapshot : retired)
+            delete snapshot;
+    }
+
+    //==============================================================================
+    /** Adds a listener if it is not already registered. Never blocks the dispatch thread */
+    void add(ListenerType* listener)
+    {
+        if (listener == nullptr)
+            return;
+
+        const juce::ScopedLock sl(writeLock);
+        auto* oldSnapshot = current.load(std::memory_order_relaxed);
+
+        if (oldSnapshot != nullptr && std::find(oldSnapshot->begin(), oldSnapshot->end(), listener) != oldSnapshot->end())
+            return;
+
+        auto* newSnapshot = oldSnapshot != nullptr ? new Snapshot(*oldSnapshot) : new Snapshot();
+        newSnapshot->push_back(listener);
+
+        publish(newSnapshot, oldSnapshot);
+    }
+
+    /** Removes a listener. Once this returns, no callback to it is running or can start */
+    void remove(ListenerType* listener)
+    {
+        // Removing from inside a callback of this list would wait for itself
+        jassert(getCallDepth() == 0);
+
+        const juce::ScopedLock sl(writeLock);
+        auto* oldSnapshot = current.load(std::memory_order_relaxed);
+
+        if (oldSnapshot == nullptr)
+            return;
+
+        auto* newSnapshot = new Snapshot();
+        newSnapshot->reserve(oldSnapshot->size());
+
+        for (auto* l : *oldSnapshot)
+            if (l != listener)
+                newSnapshot->push_back(l);
+
+        publish(newSnapshot, oldSnapshot);
+        synchronise();
+    }
+
+    /** Returns the number of registered listeners */
+    int size() const noexcept
+    {
+        const juce::ScopedLock sl(writeLock);
+        auto* snapshot = current.load(std::memory_order_relaxed);
+        return snapshot != nullptr ? (int) snapshot->size() : 0;
+    }
+
+    bool isEmpty() const noexcept { return size() == 0; }
+
+    //==============================================================================
+    /** Calls fn(ListenerType&) on every listener. Lock-free and allocation-free */
+    template <typename Callback>
+    void call(Callback&& fn) const
+    {
+        const auto epoch = enterReader();
+
+        if (auto* snapshot = current.load(std::memory_order_seq_cst))
+            for (auto* listener : *snapshot)
+                fn(*listener);
+
+        exitReader(epoch);
+    }
+
+private:
+    //==============================================================================
+    using Snapshot = std::vector<ListenerType*>;
+
+    uint32_t enterReader() const noexcept
+    {
+        ++getCallDepth();
+
+        for (;;)
+        {
+            auto epoch = readerEpoch.load(std::memory_order_seq_cst);
+            readerCounts[epoch & 1].fetch_add(1, std::memory_order_seq_cst);
+
+            // If a writer flipped the epoch in between, it may not wait for this
+            // counter; register again under the new epoch
+            if (readerEpoch.load(std::memory_order_seq_cst) == epoch)
+                return epoch;
+
+            readerCounts[epoch & 1].fetch_sub(1, std::memory_order_seq_cst);
+        }
+    }
+
+    void exitReader(uint32_t epoch) const noexcept
+    {
+        readerCounts[epoch & 1].fetch_sub(1, std::memory_order_release);
+        --getCallDepth();
+    }
+
+    /** Swaps in a new array. The old one is reclaimed at the next grace period */
+    void publish(Snapshot* newSnapshot, Snapshot* oldSnapshot)
+    {
+        current.store(newSnapshot, std::memory_order_seq_cst);
+
+        if (oldSnapshot != nullptr)
+            retired.push_back(oldSnapshot);
+    }
+
+    /** Waits until every reader that could still see a retired array has finished */
+    void synchronise()
+    {
+        auto epoch = readerEpoch.load(std::memory_order_relaxed);
+        readerEpoch.store(epoch + 1, std::memory_order_seq_cst);
+
+        // Readers hold the counter for one pass over the listeners
+        while (readerCounts[epoch & 1].load(std::memory_order_acquire) != 0)
+            std::this_thread::yield();
+
+        for (auto* snapshot : retired)
+            delete snapshot;
+
+        retired.clear();
+    }
+
+    static int& getCallDepth() noexcept
+    {
+        static thread_local int depth = 0;
+        return depth;
+    }
+
+    //==============================================================================
+    std::atomic<Snapshot*> current{nullptr};
+    std::vector<Snapshot*> retired;
+
+    mutable std::atomic<uint32_t> readerEpoch{0};
+    mutable std::atomic<int> readerCounts[2] {};
+
+    mutable juce::CriticalSection writeLock;
+
+    JUCE_DECLARE_NON_COPYABLE(RealtimeListenerList)
+};
+
+} // namespace bs_hid
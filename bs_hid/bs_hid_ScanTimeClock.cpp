@@ -0,0 +1,106 @@
+/*
+  ==============================================================================
+
+   Scan Time Clock Implementation
+
+  ==============================================================================
+*/
+
+// This file should only be included via bs_hid.cpp
+// But if compiled standalone, include the necessary headers
+#ifndef BS_HID_H_INCLUDED
+    #include "bs_hid.h"
+#endif
+
+namespace bs_hid
+{
+
+//==============================================================================
+double ScanTimeClock::addReport(uint16_t scanTime, double readTimeMs, bool continuous) noexcept
+{
+    if (! hasReport)
+    {
+        hasReport = true;
+        lastScanTime = scanTime;
+        lastReadMs = readTimeMs;
+        restart(readTimeMs);
+        return readTimeMs;
+    }
+
+    const int scanUnits = (uint16_t) (scanTime - lastScanTime);
+    const double readIntervalMs = readTimeMs - lastReadMs;
+    double scanIntervalNowMs = scanUnits * unitMs;
+
+    // Whole wraps that went by unseen during a pause
+    if (readIntervalMs > wrapMs * 0.5)
+        scanIntervalNowMs += wrapMs * juce::jmax(0.0, std::round((readIntervalMs - scanIntervalNowMs) / wrapMs));
+
+    // While a touch streams the count is trusted, even when the host read late. After a pause
+    // the device may have restarted it, so a count that disagrees with the host is bridged
+    if (continuous)
+        countGaps(scanUnits, readIntervalMs);
+    else if (std::abs(scanIntervalNowMs - readIntervalMs) > maxDisagreementMs)
+        scanIntervalNowMs = readIntervalMs;
+
+    lastScanTime = scanTime;
+    lastReadMs = readTimeMs;
+    deviceMs += scanIntervalNowMs;
+
+    fit.add(deviceMs, readTimeMs, std::exp(-scanIntervalNowMs / windowMs));
+
+    const double rate = fit.getSlope(1.0, 1.0 - maxDrift, 1.0 + maxDrift, minSpreadMs);
+    const double lineMs = fit.getMeanY() + (deviceMs - fit.getMeanX()) * rate;
+    const double delayMs = readTimeMs - lineMs;
+
+    // A count that runs at another rate soon drifts away from the host: start again, and meanwhile
+    // fall back to the read time
+    if (std::abs(delayMs) > maxDisagreementMs)
+    {
+        restart(readTimeMs);
+        return readTimeMs;
+    }
+
+    smallestDelayMs = juce::jmin(delayMs, smallestDelayMs + scanIntervalNowMs * delayRisePerMs);
+
+    // Never later than it was read
+    return juce::jmin(readTimeMs, lineMs + smallestDelayMs);
+}
+
+void ScanTimeClock::restart(double readTimeMs) noexcept
+{
+    fit.reset(deviceMs, readTimeMs);
+    smallestDelayMs = 0.0;
+}
+
+void ScanTimeClock::countGaps(int scanUnits, double readIntervalMs) noexcept
+{
+    // The same scan split over several reports
+    if (scanUnits <= 0)
+        return;
+
+    intervals[(size_t) nextInterval] = scanUnits;
+    nextInterval = (nextInterval + 1) % numIntervals;
+    periodKnown = periodKnown || nextInterval == 0;
+
+    // The period is the shortest recent interval: lost reports only ever make one longer
+    int period = scanUnits;
+
+    for (int interval : intervals)
+        if (interval > 0)
+            period = juce::jmin(period, interval);
+
+    scanIntervalMs.store(period * unitMs, std::memory_order_relaxed);
+
+    if (! periodKnown)
+        return;
+
+    const int missing = juce::roundToInt((double) scanUnits / period) - 1;
+
+    if (missing > 0)
+        numDropped.fetch_add(missing, std::memory_order_relaxed);
+
+    if (readIntervalMs < scanUnits * unitMs * mergedFraction)
+        numMerged.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace bs_hid
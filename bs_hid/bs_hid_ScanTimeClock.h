@@ -0,0 +1,101 @@
+/*
+  ==============================================================================
+
+   Scan Time Clock - When the panel sampled each report, from its Scan Time
+
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace bs_hid
+{
+
+/**
+    Turns a digitizer's Scan Time field into the moment the panel scanned the
+    contacts, on the Time::getMillisecondCounterHiRes() clock.
+
+    The host only sees when a report arrived, which adds USB polling, driver
+    and thread wake-up delays that vary by a millisecond or more. Standard
+    digitizers also stamp every report with a 16-bit Scan Time, counted in
+    100 microsecond units when the panel scanned, which doesn't vary.
+
+    addReport() unwraps the count, which wraps every 6.5 seconds; across a
+    pause between touches the whole wraps are worked out from the host time.
+    It then fits the device clock to the host clock. A least-squares line over
+    the last few seconds gives the rate difference, and the smallest delay
+    seen recently places it, since the fastest reports are the ones the stack
+    delayed least. The result is the scan moment plus that smallest delay: the
+    host can't tell the constant part of the transport from the panel's own
+    latency.
+
+    The scan times also show what the stream lost. A gap of whole scan periods
+    means reports the panel made that never arrived (dropped). A report read
+    almost together with the previous one, though scanned a period later, was
+    delivered in the same batch (merged), so both reached the host at once.
+
+    A scan time that disagrees with the host by more than 50 ms, as when a
+    device restarts its count on the first touch after a pause, is bridged
+    with the host time so the unwrapped time stays continuous. A device whose
+    count doesn't use the standard unit can't be fitted; its reports keep
+    their read time.
+
+    Call addReport() on the reader thread only. The counters can be read from
+    any thread.
+*/
+class ScanTimeClock
+{
+public:
+    //==============================================================================
+    static constexpr double unitMs = 0.1;       // HID Scan Time counts 100 microseconds
+
+    ScanTimeClock() = default;
+
+    /** Adds a report with this scan time, read at readTimeMs, and returns when the panel scanned it.
+        continuous is true if the report before it had contacts down, so a gap means lost reports
+        rather than a pause */
+    double addReport(uint16_t scanTime, double readTimeMs, bool continuous) noexcept;
+
+    //==============================================================================
+    /** Reports the panel made that never arrived */
+    int getNumDropped() const noexcept { return numDropped.load(std::memory_order_relaxed); }
+
+    /** Reports that arrived in the same batch as the one before */
+    int getNumMerged() const noexcept { return numMerged.load(std::memory_order_relaxed); }
+
+    /** The panel's scan period, or 0 until it has been seen */
+    double getScanIntervalMs() const noexcept { return scanIntervalMs.load(std::memory_order_relaxed); }
+
+private:
+    //==============================================================================
+    static constexpr double wrapMs = 65536 * unitMs;
+    static constexpr double windowMs = 10000.0;         // Time constant of the fit's weighting
+    static constexpr double minSpreadMs = 200.0;        // Points must span this before the rate is measured
+    static constexpr double maxDrift = 0.002;           // Rates further from the host's are not believed
+    static constexpr double maxDisagreementMs = 50.0;   // Scan and host time further apart than this are not trusted
+    static constexpr double delayRisePerMs = 0.00005;   // How fast the smallest delay may rise: 0.05 ms per second
+    static constexpr int numIntervals = 32;             // Recent scan intervals the period is taken from
+    static constexpr double mergedFraction = 0.25;      // Read this much closer together than scanned: one batch
+
+    void restart(double readTimeMs) noexcept;
+    void countGaps(int scanUnits, double readIntervalMs) noexcept;
+
+    //==============================================================================
+    bool hasReport = false;
+    uint16_t lastScanTime = 0;
+    double lastReadMs = 0.0;
+    double deviceMs = 0.0;              // Unwrapped scan time
+    LinearFit fit;                      // Read time against scan time
+    double smallestDelayMs = 0.0;       // Lowest read time seen above the line, rising slowly
+
+    std::array<int, numIntervals> intervals {};
+    int nextInterval = 0;
+    bool periodKnown = false;           // Once every interval slot has been filled
+
+    std::atomic<int> numDropped { 0 }, numMerged { 0 };
+    std::atomic<double> scanIntervalMs { 0.0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ScanTimeClock)
+};
+
+} // namespace bs_hid
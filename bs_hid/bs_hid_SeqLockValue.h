@@ -0,0 +1,90 @@
+/*
+  ==============================================================================
+
+   SeqLock Value - Lock-free single-writer snapshot
+
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace bs_hid
+{
+
+/**
+    Holds a trivially copyable value written by one thread and read by any
+    number of others without locks.
+
+    store() is wait-free, so it is safe on the realtime HID thread. load()
+    never blocks the writer; it retries if it overlaps a store, which for
+    small values is a handful of nanoseconds at worst.
+
+    The value is kept in atomic words, so concurrent access is race-free
+    without relying on memcpy of shared memory.
+*/
+template <typename Type>
+class SeqLockValue
+{
+public:
+    static_assert(std::is_trivially_copyable<Type>::value, "SeqLockValue requires a trivially copyable type");
+
+    SeqLockValue() noexcept                             { store(Type()); }
+    explicit SeqLockValue(const Type& initial) noexcept { store(initial); }
+
+    //==============================================================================
+    /** Publishes a new value. Only ever call this from a single writer thread */
+    void store(const Type& value) noexcept
+    {
+        uint64_t buffer[numWords] = {};
+        std::memcpy(buffer, &value, sizeof(Type));
+
+        auto seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);   // odd: write in progress
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (int i = 0; i < numWords; ++i)
+            words[i].store(buffer[i], std::memory_order_relaxed);
+
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    /** Returns a consistent copy of the most recently stored value */
+    Type load() const noexcept
+    {
+        uint64_t buffer[numWords];
+
+        for (;;)
+        {
+            auto before = sequence.load(std::memory_order_acquire);
+
+            if ((before & 1) == 0)
+            {
+                for (int i = 0; i < numWords; ++i)
+                    buffer[i] = words[i].load(std::memory_order_relaxed);
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+
+                if (sequence.load(std::memory_order_relaxed) == before)
+                    break;
+            }
+        }
+
+        Type result;
+        std::memcpy(&result, buffer, sizeof(Type));
+        return result;
+    }
+
+    /** Returns a counter that changes every time a new value is stored */
+    uint32_t getVersion() const noexcept { return sequence.load(std::memory_order_acquire) >> 1; }
+
+private:
+    //==============================================================================
+    static constexpr int numWords = (int) ((sizeof(Type) + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+
+    std::atomic<uint32_t> sequence{0};
+    std::atomic<uint64_t> words[numWords];
+
+    JUCE_DECLARE_NON_COPYABLE(SeqLockValue)
+};
+
+} // namespace bs_hid
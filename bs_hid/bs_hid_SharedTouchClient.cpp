@@ -0,0 +1,164 @@
+/*
+  ==============================================================================
+
+   Shared Touch Client Implementation
+
+  ==============================================================================
+*/
+
+// This file should only be included via bs_hid.cpp
+// But if compiled standalone, include the necessary headers
+#ifndef BS_HID_H_INCLUDED
+    #include "bs_hid.h"
+#endif
+
+#if BS_HID_ENABLE_SHARED_MEMORY
+
+namespace bs_hid
+{
+
+//==============================================================================
+SharedTouchClient::SharedTouchClient(const juce::String& name)
+    : juce::Thread("SharedTouchClientThread"),
+      segmentName(name)
+{
+    juce::Thread::RealtimeOptions realtimeOptions;
+    startRealtimeThread(realtimeOptions.withPriority(8));
+}
+
+SharedTouchClient::~SharedTouchClient()
+{
+    stopThread(2000);
+}
+
+//==============================================================================
+void SharedTouchClient::addListener(Listener* listener)
+{
+    listeners.add(listener);
+}
+
+void SharedTouchClient::removeListener(Listener* listener)
+{
+    listeners.remove(listener);
+}
+
+//==============================================================================
+bool SharedTouchClient::isAttached() const
+{
+    const juce::ScopedLock sl(ringLock);
+    return ring != nullptr && ring->isPublisherAlive();
+}
+
+bool SharedTouchClient::isDeviceConnected() const
+{
+    const juce::ScopedLock sl(ringLock);
+    return ring != nullptr && ring->isPublisherAlive() && ring->getDeviceStatus().isConnected;
+}
+
+HIDDeviceInfo SharedTouchClient::getConnectedDeviceInfo() const
+{
+    const juce::ScopedLock sl(ringLock);
+
+    if (ring != nullptr)
+        return ring->getDeviceStatus().deviceInfo;
+
+    return {};
+}
+
+std::vector<TouchData> SharedTouchClient::getAllTouches() const
+{
+    auto frame = latestFrame.load();
+    return std::vector<TouchData>(frame.contacts.begin(), frame.contacts.begin() + frame.numContacts);
+}
+
+//==============================================================================
+bool SharedTouchClient::attach()
+{
+    auto newRing = SharedTouchRing::open(segmentName);
+
+    if (newRing == nullptr || !newRing->isPublisherAlive())
+    {
+        // The daemon is gone: unmap its segment rather than holding it until it comes back
+        if (ring != nullptr)
+            setRing(nullptr);
+
+        return false;
+    }
+
+    setRing(std::move(newRing));
+
+    DBG("SharedTouchClient: Attached to " << segmentName);
+    return true;
+}
+
+void SharedTouchClient::setRing(std::unique_ptr<SharedTouchRing> newRing)
+{
+    {
+        const juce::ScopedLock sl(ringLock);
+        std::swap(ring, newRing);
+    }
+
+    // newRing now holds the old segment, unmapped here outside the lock
+}
+
+void SharedTouchClient::run()
+{
+    uint64_t nextIndex = 0;
+
+    while (!threadShouldExit())
+    {
+        // (Re)attach when there is no daemon or it stopped updating its heartbeat
+        if (ring == nullptr || !ring->isPublisherAlive())
+        {
+            if (!attach())
+            {
+                wait(500);
+                continue;
+            }
+
+            nextIndex = ring->getWriteIndex();
+        }
+
+        if (!ring->waitForFrame(nextIndex, 100))
+            continue;
+
+        auto writeIndex = ring->getWriteIndex();
+
+        // Fell more than a full ring behind: skip to the oldest frame still present
+        if (writeIndex - nextIndex > SharedTouchRing::capacity)
+        {
+            auto skipped = writeIndex - SharedTouchRing::capacity - nextIndex;
+            droppedFrames.fetch_add((int) skipped, std::memory_order_relaxed);
+            nextIndex = writeIndex - SharedTouchRing::capacity;
+        }
+
+        for (; nextIndex < writeIndex; ++nextIndex)
+        {
+            TouchFrame frame;
+            uint32_t eventFlags = 0;
+
+            if (ring->readFrame(nextIndex, frame, eventFlags))
+                dispatch(frame, eventFlags);
+            else
+                droppedFrames.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void SharedTouchClient::dispatch(const TouchFrame& frame, uint32_t eventFlags)
+{
+    latestFrame.store(frame);
+
+    // Same contract as HIDDeviceManager: touch events while down, plus the release
+    if (frame.hasActiveContacts() || (eventFlags & SharedTouchRing::touchEnded) != 0)
+    {
+        auto primary = frame.getPrimaryTouch();
+        listeners.call([&](Listener& l) { l.touchDetected(primary); });
+    }
+
+    listeners.call([&](Listener& l) { l.touchFrameReceived(frame); });
+}
+
+} // namespace bs_hid
+
+#endif // BS_HID_ENABLE_SHARED_MEMORY
@@ -0,0 +1,94 @@
+/*
+  ==============================================================================
+
+   Shared Touch Client - Reads touch frames published by the touch daemon
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#if BS_HID_ENABLE_SHARED_MEMORY
+
+namespace bs_hid
+{
+
+/**
+    Receives touch frames from the touch daemon through shared memory.
+
+    Use this in place of HIDDeviceManager when another process (the daemon)
+    owns the device. It offers the same Listener interface and the same
+    state getters, so consumers do not need to know where frames come from.
+
+    Listeners are called from the client's reader thread, which wakes as
+    soon as the daemon publishes. Frames are copied out of shared memory
+    under the ring's per-slot seqlock, so a listener never sees a torn frame.
+
+    If the daemon is not running yet, or restarts, the client reattaches
+    automatically and unmaps the segment it was attached to.
+*/
+class SharedTouchClient : private juce::Thread
+{
+public:
+    using Listener = HIDDeviceManager::Listener;
+
+    //==============================================================================
+    explicit SharedTouchClient(const juce::String& segmentName = SharedTouchRing::defaultName);
+    ~SharedTouchClient() override;
+
+    //==============================================================================
+    /** Adds a listener to receive touch events */
+    void addListener(Listener* listener);
+
+    /** Removes a listener. Once this returns, the reader thread will not call it again */
+    void removeListener(Listener* listener);
+
+    //==============================================================================
+    /** Returns true if the daemon is alive and has a device connected */
+    bool isDeviceConnected() const;
+
+    /** Returns information about the daemon's connected device */
+    HIDDeviceInfo getConnectedDeviceInfo() const;
+
+    /** Returns true if the client is attached to a live daemon */
+    bool isAttached() const;
+
+    //==============================================================================
+    /** Get the most recent primary touch */
+    TouchData getLatestTouchData() const noexcept { return latestFrame.load().getPrimaryTouch(); }
+
+    /** Get all current active touches */
+    std::vector<TouchData> getAllTouches() const;
+
+    /** Get the most recent frame (copied out of a lock-free snapshot) */
+    TouchFrame getLatestFrame() const noexcept { return latestFrame.load(); }
+
+    /** Number of frames that were overwritten before the reader thread got to them */
+    int getNumDroppedFrames() const noexcept { return droppedFrames.load(std::memory_order_relaxed); }
+
+private:
+    //==============================================================================
+    void run() override;
+    bool attach();
+    void setRing(std::unique_ptr<SharedTouchRing> newRing);
+    void dispatch(const TouchFrame& frame, uint32_t eventFlags);
+
+    //==============================================================================
+    juce::String segmentName;
+
+    // Only the reader thread replaces the ring; it reads it without the lock,
+    // other threads hold ringLock so the segment cannot be unmapped under them
+    std::unique_ptr<SharedTouchRing> ring;
+    juce::CriticalSection ringLock;
+
+    RealtimeListenerList<Listener> listeners;
+    SeqLockValue<TouchFrame> latestFrame;
+    std::atomic<int> droppedFrames{0};
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SharedTouchClient)
+};
+
+} // namespace bs_hid
+
+#endif // BS_HID_ENABLE_SHARED_MEMORY
@@ -0,0 +1,324 @@
+/*
+  ==============================================================================
+
+   Shared Touch Ring Implementation
+
+  ==============================================================================
+*/
+
+// This file should only be included via bs_hid.cpp
+// But if compiled standalone, include the necessary headers
+#ifndef BS_HID_H_INCLUDED
+    #include "bs_hid.h"
+#endif
+
+#if BS_HID_ENABLE_SHARED_MEMORY
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#if JUCE_LINUX
+    #include <linux/futex.h>
+    #include <sys/syscall.h>
+    #include <ctime>
+    #include <climits>
+#endif
+
+namespace bs_hid
+{
+
+//==============================================================================
+namespace
+{
+    void copyToFixedString(char* dest, size_t destSize, const juce::String& source)
+    {
+        auto utf8 = source.toRawUTF8();
+        std::strncpy(dest, utf8, destSize - 1);
+        dest[destSize - 1] = 0;
+    }
+
+    // Seqlock payloads are moved as relaxed atomic words, so a reader racing the
+    // writer reads stale or mixed words (caught by the sequence check), never UB
+    template <typename Type, size_t numWords>
+    void storeWords(std::atomic<uint64_t> (&words)[numWords], const Type& value) noexcept
+    {
+        static_assert(sizeof(Type) <= numWords * sizeof(uint64_t), "payload does not fit");
+
+        uint64_t buffer[numWords] = {};
+        std::memcpy(buffer, &value, sizeof(Type));
+
+        for (size_t i = 0; i < numWords; ++i)
+            words[i].store(buffer[i], std::memory_order_relaxed);
+    }
+
+    template <typename Type, size_t numWords>
+    void loadWords(const std::atomic<uint64_t> (&words)[numWords], Type& value) noexcept
+    {
+        static_assert(sizeof(Type) <= numWords * sizeof(uint64_t), "payload does not fit");
+
+        uint64_t buffer[numWords];
+
+        for (size_t i = 0; i < numWords; ++i)
+            buffer[i] = words[i].load(std::memory_order_relaxed);
+
+        std::memcpy(&value, buffer, sizeof(Type));
+    }
+
+   #if JUCE_LINUX
+    // Shared (not FUTEX_PRIVATE) so waits and wakes work across processes
+    long futexWait(std::atomic<uint32_t>* word, uint32_t expected, int timeoutMs)
+    {
+        timespec timeout { timeoutMs / 1000, (long) (timeoutMs % 1000) * 1000000L };
+        return syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+    }
+
+    long futexWakeAll(std::atomic<uint32_t>* word)
+    {
+        return syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    }
+   #endif
+}
+
+//==============================================================================
+SharedTouchRing::SharedTouchRing(const juce::String& segmentName, int fd, Layout* mappedLayout, bool owner)
+    : name(segmentName), fileDescriptor(fd), layout(mappedLayout), isOwner(owner)
+{
+}
+
+SharedTouchRing::~SharedTouchRing()
+{
+    if (layout != nullptr)
+        munmap(layout, sizeof(Layout));
+
+    if (fileDescriptor >= 0)
+        close(fileDescriptor);
+
+    if (isOwner)
+        shm_unlink(name.toRawUTF8());
+}
+
+std::unique_ptr<SharedTouchRing> SharedTouchRing::create(const juce::String& segmentName)
+{
+    // Start from a fresh segment so stale readers of a previous daemon notice the restart
+    shm_unlink(segmentName.toRawUTF8());
+
+    int fd = shm_open(segmentName.toRawUTF8(), O_CREAT | O_RDWR, 0666);
+    if (fd < 0)
+    {
+        DBG("SharedTouchRing: shm_open failed for " << segmentName);
+        return nullptr;
+    }
+
+    if (ftruncate(fd, (off_t) sizeof(Layout)) != 0)
+    {
+        DBG("SharedTouchRing: ftruncate failed");
+        close(fd);
+        shm_unlink(segmentName.toRawUTF8());
+        return nullptr;
+    }
+
+    void* mapped = mmap(nullptr, sizeof(Layout), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED)
+    {
+        DBG("SharedTouchRing: mmap failed");
+        close(fd);
+        shm_unlink(segmentName.toRawUTF8());
+        return nullptr;
+    }
+
+    // A new segment is zero-filled, which is a valid state for every atomic in it
+    auto* layout = static_cast<Layout*>(mapped);
+    layout->header.capacity = capacity;
+    layout->header.slotSize = (uint32_t) sizeof(Slot);
+    layout->header.version = layoutVersion;
+    layout->header.heartbeatMs.store(juce::Time::currentTimeMillis(), std::memory_order_relaxed);
+
+    // Written last so open() never accepts a half-initialised header
+    std::atomic_thread_fence(std::memory_order_release);
+    layout->header.magic = layoutMagic;
+
+    return std::unique_ptr<SharedTouchRing>(new SharedTouchRing(segmentName, fd, layout, true));
+}
+
+std::unique_ptr<SharedTouchRing> SharedTouchRing::open(const juce::String& segmentName)
+{
+    int fd = shm_open(segmentName.toRawUTF8(), O_RDWR, 0);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t) info.st_size < sizeof(Layout))
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    void* mapped = mmap(nullptr, sizeof(Layout), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED)
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    auto* layout = static_cast<Layout*>(mapped);
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    // Reject segments written by an incompatible build (e.g. a different TouchFrame layout)
+    if (layout->header.magic != layoutMagic
+        || layout->header.version != layoutVersion
+        || layout->header.capacity != capacity
+        || layout->header.slotSize != (uint32_t) sizeof(Slot))
+    {
+        DBG("SharedTouchRing: Incompatible segment " << segmentName);
+        munmap(mapped, sizeof(Layout));
+        close(fd);
+        return nullptr;
+    }
+
+    return std::unique_ptr<SharedTouchRing>(new SharedTouchRing(segmentName, fd, layout, false));
+}
+
+//==============================================================================
+void SharedTouchRing::publish(const TouchFrame& frame, uint32_t eventFlags) noexcept
+{
+    auto& header = layout->header;
+    const auto index = header.writeIndex.load(std::memory_order_relaxed);
+    auto& slot = layout->slots[index & (capacity - 1)];
+
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    Payload payload;
+    payload.eventFlags = eventFlags;
+    payload.frame = frame;
+    storeWords(slot.payload, payload);
+
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+    header.writeIndex.store(index + 1, std::memory_order_release);
+
+    header.wakeCounter.fetch_add(1, std::memory_order_release);
+
+   #if JUCE_LINUX
+    // Skip the syscall entirely when nobody is blocked
+    if (header.numWaiters.load(std::memory_order_seq_cst) > 0)
+        futexWakeAll(&header.wakeCounter);
+   #endif
+}
+
+void SharedTouchRing::setDeviceStatus(const DeviceStatus& status)
+{
+    auto& header = layout->header;
+    auto seq = header.deviceStatusSequence.load(std::memory_order_relaxed);
+
+    header.deviceStatusSequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    DeviceStatusBlock block = {};
+    block.isConnected = status.isConnected ? 1u : 0u;
+    block.vendorId = status.deviceInfo.vendorId;
+    block.productId = status.deviceInfo.productId;
+    copyToFixedString(block.path, sizeof(block.path), status.deviceInfo.path);
+    copyToFixedString(block.manufacturer, sizeof(block.manufacturer), status.deviceInfo.manufacturer);
+    copyToFixedString(block.product, sizeof(block.product), status.deviceInfo.product);
+    copyToFixedString(block.serialNumber, sizeof(block.serialNumber), status.deviceInfo.serialNumber);
+    storeWords(header.deviceStatus, block);
+
+    header.deviceStatusSequence.store(seq + 2, std::memory_order_release);
+}
+
+void SharedTouchRing::updateHeartbeat() noexcept
+{
+    layout->header.heartbeatMs.store(juce::Time::currentTimeMillis(), std::memory_order_relaxed);
+}
+
+//==============================================================================
+uint64_t SharedTouchRing::getWriteIndex() const noexcept
+{
+    return layout->header.writeIndex.load(std::memory_order_acquire);
+}
+
+bool SharedTouchRing::readFrame(uint64_t index, TouchFrame& frame, uint32_t& eventFlags) const noexcept
+{
+    const auto& slot = getSlot(index);
+    const auto expected = 2 * index + 2;
+
+    if (slot.sequence.load(std::memory_order_acquire) != expected)
+        return false;
+
+    Payload payload;
+    loadWords(slot.payload, payload);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    if (slot.sequence.load(std::memory_order_relaxed) != expected)
+        return false;
+
+    frame = payload.frame;
+    eventFlags = payload.eventFlags;
+    return true;
+}
+
+bool SharedTouchRing::waitForFrame(uint64_t lastSeenIndex, int timeoutMs) const noexcept
+{
+    auto& header = layout->header;
+
+   #if JUCE_LINUX
+    // Read the futex word before re-checking the index, so a publish in between
+    // changes the word and the wait returns immediately instead of sleeping
+    auto seen = header.wakeCounter.load(std::memory_order_acquire);
+
+    if (getWriteIndex() != lastSeenIndex)
+        return true;
+
+    header.numWaiters.fetch_add(1, std::memory_order_seq_cst);
+    futexWait(&header.wakeCounter, seen, timeoutMs);
+    header.numWaiters.fetch_sub(1, std::memory_order_seq_cst);
+   #else
+    for (int waited = 0; waited < timeoutMs && getWriteIndex() == lastSeenIndex; ++waited)
+        juce::Thread::sleep(1);
+   #endif
+
+    return getWriteIndex() != lastSeenIndex;
+}
+
+SharedTouchRing::DeviceStatus SharedTouchRing::getDeviceStatus() const
+{
+    const auto& header = layout->header;
+    DeviceStatusBlock block;
+
+    for (;;)
+    {
+        auto before = header.deviceStatusSequence.load(std::memory_order_acquire);
+
+        if ((before & 1) == 0)
+        {
+            loadWords(header.deviceStatus, block);
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (header.deviceStatusSequence.load(std::memory_order_relaxed) == before)
+                break;
+        }
+
+        juce::Thread::yield();
+    }
+
+    DeviceStatus status;
+    status.isConnected = block.isConnected != 0;
+    status.deviceInfo = HIDDeviceInfo(juce::String::fromUTF8(block.path), block.vendorId, block.productId,
+                                      juce::String::fromUTF8(block.manufacturer),
+                                      juce::String::fromUTF8(block.product),
+                                      juce::String::fromUTF8(block.serialNumber));
+    return status;
+}
+
+bool SharedTouchRing::isPublisherAlive(int maxAgeMs) const noexcept
+{
+    auto age = juce::Time::currentTimeMillis() - layout->header.heartbeatMs.load(std::memory_order_relaxed);
+    return age >= 0 && age < maxAgeMs;
+}
+
+} // namespace bs_hid
+
+#endif // BS_HID_ENABLE_SHARED_MEMORY
@@ -0,0 +1,174 @@
+/*
+  ==============================================================================
+
+   Shared Touch Ring - Cross-process touch frame ring in POSIX shared memory
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#if BS_HID_ENABLE_SHARED_MEMORY
+
+namespace bs_hid
+{
+
+/**
+    A single-producer, multi-consumer ring of TouchFrames in POSIX shared memory.
+
+    The touch daemon owns the device and publishes every decoded frame here;
+    any number of processes can map the segment and copy frames out of it.
+    Each slot is a seqlock: its payload is stored as relaxed atomic words
+    between two sequence stores, so a reader copies it without a data race
+    and detects a slot that was overwritten during the copy and skips it.
+
+    Readers block in waitForFrame(). On Linux this is a futex on a word in
+    the segment, which the publisher only wakes when someone is waiting.
+    Other platforms fall back to a 1ms poll.
+
+    All fields in the segment are plain data or lock-free atomics, which are
+    address-free and therefore valid across processes.
+*/
+class SharedTouchRing
+{
+public:
+    //==============================================================================
+    static constexpr const char* defaultName = "/bs_hid_touch";
+    static constexpr uint32_t capacity = 256;     // Must be a power of two
+
+    /** Event flags published alongside each frame */
+    enum EventFlags : uint32_t
+    {
+        touchBegan = 1 << 0,    // First contact went down in this frame
+        touchEnded = 1 << 1     // Last contact was released in this frame
+    };
+
+    /** Connection state of the device owned by the publisher */
+    struct DeviceStatus
+    {
+        bool isConnected = false;
+        HIDDeviceInfo deviceInfo;
+    };
+
+    //==============================================================================
+    /** Creates (or recreates) the segment. Used by the publishing daemon */
+    static std::unique_ptr<SharedTouchRing> create(const juce::String& name = defaultName);
+
+    /** Maps an existing segment. Returns nullptr if no publisher has created it */
+    static std::unique_ptr<SharedTouchRing> open(const juce::String& name = defaultName);
+
+    ~SharedTouchRing();
+
+    //==============================================================================
+    // Publisher side (single writer)
+
+    /** Writes a frame into the next slot and wakes waiting readers. Wait-free */
+    void publish(const TouchFrame& frame, uint32_t eventFlags) noexcept;
+
+    /** Updates the connected device shown to clients */
+    void setDeviceStatus(const DeviceStatus& status);
+
+    /** Marks the publisher as alive. Call periodically */
+    void updateHeartbeat() noexcept;
+
+    //==============================================================================
+    // Reader side
+
+    /** Total number of frames published so far. Frame i lives in slot i % capacity */
+    uint64_t getWriteIndex() const noexcept;
+
+    /** Copies frame `index` and its event flags out of shared memory. Returns false,
+        leaving the outputs unspecified, if the frame is not available or was
+        overwritten during the copy.
+    */
+    bool readFrame(uint64_t index, TouchFrame& frame, uint32_t& eventFlags) const noexcept;
+
+    /** Blocks until the write index moves past lastSeenIndex or the timeout expires.
+        Returns true if a new frame is available */
+    bool waitForFrame(uint64_t lastSeenIndex, int timeoutMs) const noexcept;
+
+    /** Returns the device status last set by the publisher */
+    DeviceStatus getDeviceStatus() const;
+
+    /** Returns true if the publisher updated its heartbeat within maxAgeMs */
+    bool isPublisherAlive(int maxAgeMs = 2000) const noexcept;
+
+    /** Returns the segment name */
+    const juce::String& getName() const noexcept { return name; }
+
+private:
+    //==============================================================================
+    struct Payload
+    {
+        uint32_t eventFlags;
+        TouchFrame frame;
+    };
+
+    static constexpr size_t payloadWords = (sizeof(Payload) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    struct alignas(64) Slot
+    {
+        std::atomic<uint64_t> sequence;    // 2*index+1 while writing, 2*index+2 when complete
+        std::atomic<uint64_t> payload[payloadWords];
+    };
+
+    struct DeviceStatusBlock
+    {
+        uint32_t isConnected;
+        uint16_t vendorId;
+        uint16_t productId;
+        char path[256];
+        char manufacturer[128];
+        char product[128];
+        char serialNumber[64];
+    };
+
+    static constexpr size_t deviceStatusWords = (sizeof(DeviceStatusBlock) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    struct alignas(64) Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t capacity;
+        uint32_t slotSize;
+
+        alignas(64) std::atomic<uint64_t> writeIndex;
+        std::atomic<uint32_t> wakeCounter;       // futex word
+        std::atomic<uint32_t> numWaiters;
+        std::atomic<int64_t> heartbeatMs;
+
+        alignas(64) std::atomic<uint32_t> deviceStatusSequence;
+        std::atomic<uint64_t> deviceStatus[deviceStatusWords];
+    };
+
+    struct Layout
+    {
+        Header header;
+        Slot slots[capacity];
+    };
+
+    static constexpr uint32_t layoutMagic = 0x42534854;    // 'BSHT'
+    static constexpr uint32_t layoutVersion = 9;
+
+    static_assert((capacity & (capacity - 1)) == 0, "capacity must be a power of two");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared atomics must be lock-free");
+    static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared atomics must be lock-free");
+    static_assert(std::is_trivially_copyable<Payload>::value, "slot payload is copied as raw words");
+
+    //==============================================================================
+    SharedTouchRing(const juce::String& name, int fd, Layout* layout, bool isOwner);
+
+    const Slot& getSlot(uint64_t index) const noexcept { return layout->slots[index & (capacity - 1)]; }
+
+    juce::String name;
+    int fileDescriptor = -1;
+    Layout* layout = nullptr;
+    bool isOwner = false;
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SharedTouchRing)
+};
+
+} // namespace bs_hid
+
+#endif // BS_HID_ENABLE_SHARED_MEMORY
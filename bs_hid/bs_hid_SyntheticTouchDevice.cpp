@@ -0,0 +1,87 @@
+/*
+  ==============================================================================
+
+   Synthetic Touch Device Implementation
+
+  ==============================================================================
+*/
+
+// This file should only be included via bs_hid.cpp
+// But if compiled standalone, include the necessary headers
+#ifndef BS_HID_H_INCLUDED
+    #include "bs_hid.h"
+#endif
+
+namespace bs_hid
+{
+
+//==============================================================================
+SyntheticTouchDevice::SyntheticTouchDevice(const Options& o)
+    : options(o)
+{
+}
+
+HIDDeviceInfo SyntheticTouchDevice::getDeviceInfo()
+{
+    return HIDDeviceInfo("synthetic", 0, 0, "bs_hid", "Synthetic Touch", {});
+}
+
+//==============================================================================
+int SyntheticTouchDevice::read(unsigned char* buffer, int bufferSize, double nowMs) noexcept
+{
+    if (bufferSize < reportLength)
+        return -1;
+
+    if (! started)
+    {
+        started = true;
+        startMs = scanMs = nowMs;
+        readyMs = nowMs + options.minDelayMs;
+    }
+
+    // The queue overflowed while nobody read: the oldest scans are gone
+    while (nowMs - readyMs > maxBacklogMs)
+        scheduleNext();
+
+    if (nowMs < readyMs)
+        return 0;
+
+    const double elapsedMs = scanMs - startMs;
+    const bool down = std::fmod(elapsedMs, options.tapIntervalMs) < options.tapLengthMs;
+
+    if (down && ! wasDown)
+        lastTapDownMs.store(scanMs, std::memory_order_relaxed);
+
+    wasDown = down;
+
+    std::fill(buffer, buffer + reportLength, (unsigned char) 0);
+    buffer[0] = 1;
+
+    // First contact slot: tip switch and contact ID 0, then X and Y, little endian
+    if (down)
+    {
+        buffer[1] = 0x01;
+        buffer[2] = buffer[4] = (unsigned char) (centreCoord & 0xFF);
+        buffer[3] = buffer[5] = (unsigned char) (centreCoord >> 8);
+    }
+
+    const auto scanTime = (uint16_t) (juce::int64) (elapsedMs / ScanTimeClock::unitMs);
+    buffer[reportLength - 3] = (unsigned char) (scanTime & 0xFF);
+    buffer[reportLength - 2] = (unsigned char) (scanTime >> 8);
+    buffer[reportLength - 1] = down ? 1 : 0;
+
+    scheduleNext();
+    return reportLength;
+}
+
+void SyntheticTouchDevice::scheduleNext() noexcept
+{
+    scanMs += options.reportIntervalMs;
+
+    const double delayMs = options.minDelayMs + random.nextDouble() * (options.maxDelayMs - options.minDelayMs);
+
+    // Reports arrive in the order they were scanned
+    readyMs = juce::jmax(readyMs, scanMs + delayMs);
+}
+
+} // namespace bs_hid
@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+   Synthetic Touch Device - Standard digitizer reports generated in-process
+
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace bs_hid
+{
+
+/**
+    Stands in for a touchscreen: a single finger tapping at a steady rhythm,
+    delivered as standard digitizer input reports.
+
+    read() behaves like hid_read() on a non-blocking device. The panel
+    "scans" every Options::reportIntervalMs; each report becomes readable a
+    random delay between Options::minDelayMs and Options::maxDelayMs later,
+    in order, like reports crossing USB and the driver. A reader that falls
+    more than maxBacklogMs behind loses the oldest reports, as a device's
+    queue would.
+
+    Reports use the layout TouchParser::parseStandardTouch() reads: report
+    ID 1, five bytes per contact, then Scan Time and the contact count, so
+    everything downstream, ScanTimeClock included, sees a real device.
+
+    Used to test the HID path and the latency measurement without hardware.
+    Call read() from one thread only.
+*/
+class SyntheticTouchDevice
+{
+public:
+    //==============================================================================
+    static constexpr int reportLength = 44;
+    static constexpr uint16_t centreCoord = 16000;      // Where the finger taps, inside the valid range
+
+    struct Options
+    {
+        double reportIntervalMs = 4.0;      // Scan period: 250 Hz
+        double tapIntervalMs = 500.0;       // A tap starts this often
+        double tapLengthMs = 80.0;          // How long each tap stays down
+        double minDelayMs = 1.0;            // Scan to readable, shortest
+        double maxDelayMs = 3.0;            // and longest
+    };
+
+    SyntheticTouchDevice() = default;
+    explicit SyntheticTouchDevice(const Options& options);
+
+    /** How the device appears in device lists */
+    static HIDDeviceInfo getDeviceInfo();
+
+    /** Copies the next report readable at nowMs (Time::getMillisecondCounterHiRes()) into buffer
+        and returns its length, or returns 0 if none is ready yet, or -1 if buffer is too small */
+    int read(unsigned char* buffer, int bufferSize, double nowMs) noexcept;
+
+    /** When the most recent tap went down, on the same clock, or 0 before the first */
+    double getLastTapDownMs() const noexcept { return lastTapDownMs.load(std::memory_order_relaxed); }
+
+private:
+    //==============================================================================
+    static constexpr double maxBacklogMs = 100.0;
+
+    void scheduleNext() noexcept;
+
+    //==============================================================================
+    Options options;
+    juce::Random random;
+
+    bool started = false;
+    double startMs = 0.0;
+    double scanMs = 0.0, readyMs = 0.0;     // The next report: when it is scanned, and readable
+    bool wasDown = false;
+    std::atomic<double> lastTapDownMs { 0.0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SyntheticTouchDevice)
+};
+
+} // namespace bs_hid
@@ -12,11 +12,19 @@ namespace bs_hid
 {
 
 TouchCalibrationManager::TouchCalibrationManager()
+    : juce::Thread("TouchCalibrationWriter")
 {
     // Initialize with defaults
     resetToDefaults();
 }
 
+TouchCalibrationManager::~TouchCalibrationManager()
+{
+    // run() writes anything still pending before it exits
+    stopThread(5000);
+    flushPendingSave();
+}
+
 juce::File TouchCalibrationManager::getConfigDirectory() const
 {
     auto appDataDir = juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory);
@@ -31,39 +39,340 @@ juce::File TouchCalibrationManager::getConfigDirectory() const
 
 juce::File TouchCalibrationManager::getCalibrationFile() const
 {
-    return getConfigDirectory().getChildFile("touchScreen.xml");
+    const juce::ScopedLock sl(writeLock);
+    return getProfileFile(activeProfileKey);
+}
+
+juce::File TouchCalibrationManager::getProfileFile(const juce::String& key) const
+{
+    if (key.isEmpty())
+        return getConfigDirectory().getChildFile("touchScreen.xml");
+
+    return getProfilesDirectory().getChildFile(key + ".xml");
+}
+
+juce::File TouchCalibrationManager::getProfilesDirectory() const
+{
+    auto profilesDir = getConfigDirectory().getChildFile("Profiles");
+
+    if (!profilesDir.exists())
+        profilesDir.createDirectory();
+
+    return profilesDir;
+}
+
+//==============================================================================
+juce::String TouchCalibrationManager::getProfileKey(const HIDDeviceInfo& device)
+{
+    auto key = juce::String::toHexString((int) device.vendorId).paddedLeft('0', 4) + "-"
+             + juce::String::toHexString((int) device.productId).paddedLeft('0', 4) + "-";
+
+    // The path changes with the USB port, so it is only a fallback for panels without a serial
+    if (device.hasSerialNumber())
+        key << device.serialNumber;
+    else
+        key << "path-" << juce::String::toHexString(device.path.hashCode64());
+
+    return juce::File::createLegalFileName(key);
+}
+
+juce::String TouchCalibrationManager::getActiveProfileKey() const
+{
+    const juce::ScopedLock sl(writeLock);
+    return activeProfileKey;
+}
+
+void TouchCalibrationManager::selectProfile(const HIDDeviceInfo& device)
+{
+    switchToProfile(getProfileKey(device));
+}
+
+void TouchCalibrationManager::selectDefaultProfile()
+{
+    switchToProfile({});
+}
+
+const SeqLockValue<TouchCalibrationManager::CalibrationSnapshot>& TouchCalibrationManager::getDeviceCalibration(const HIDDeviceInfo& device)
+{
+    const auto key = getProfileKey(device);
+    const juce::ScopedLock sl(writeLock);
+
+    if (key != activeProfileKey && loadedProfiles.count(key) == 0)
+        addProfile(key);
+
+    return publishedProfiles[key];
+}
+
+void TouchCalibrationManager::switchToProfile(const juce::String& key)
+{
+    // Queued saves name their profile, so they needn't be flushed first
+    const juce::ScopedLock sl(writeLock);
+
+    if (key == activeProfileKey)
+        return;
+
+    loadedProfiles[activeProfileKey] = getCurrentState();
+
+    if (loadedProfiles.count(key) == 0)
+        addProfile(key);
+
+    activeProfileKey = key;
+    setCurrentState(loadedProfiles[key]);
+    loadedProfiles.erase(key);
+    publishSnapshot();
+
+    DBG("TouchCalibrationManager: Switched to profile " << (key.isEmpty() ? juce::String("(shared)") : key));
+}
+
+void TouchCalibrationManager::addProfile(const juce::String& key)
+{
+    // Not calibrated yet as far as this session knows: the shared calibration stands in until
+    // the profile's file, if it has one, has been read
+    const auto shared = activeProfileKey.isEmpty() ? getCurrentState() : loadedProfiles[{}];
+    loadedProfiles[key] = shared;
+    publishedProfiles[key].store(createSnapshot(shared));
+    profilesToLoad.addIfNotAlreadyThere(key);
+
+    if (!isThreadRunning())
+        startThread();
+
+    notify();
+}
+
+void TouchCalibrationManager::loadQueuedProfiles()
+{
+    for (;;)
+    {
+        const juce::ScopedLock sl(writeLock);
+
+        if (profilesToLoad.isEmpty())
+            return;
+
+        const auto key = profilesToLoad[0];
+        profilesToLoad.remove(0);
+
+        ProfileState state;
+
+        if (!readProfile(getProfileFile(key), state))
+            continue;
+
+        // The filter of a profile without one stays at the defaults, like a fresh file
+        if (key == activeProfileKey)
+        {
+            setCurrentState(state);
+            publishSnapshot();
+        }
+        else
+        {
+            loadedProfiles[key] = state;
+            publishedProfiles[key].store(createSnapshot(state));
+        }
+
+        DBG("TouchCalibrationManager: Loaded profile " << key);
+    }
+}
+
+namespace
+{
+    // Binary cache layout: header, bounds, model, matrix, filter, then an optional correction grid
+    constexpr int cacheMagic = 0x4C434853;  // "SHCL"
+    constexpr int cacheVersion = 2;
+
+    const char* getModelName(TouchCalibrationManager::TransformModel model)
+    {
+        switch (model)
+        {
+            case TouchCalibrationManager::TransformModel::affine:      return "affine";
+            case TouchCalibrationManager::TransformModel::projective:  return "projective";
+            case TouchCalibrationManager::TransformModel::bounds:      break;
+        }
+
+        return "bounds";
+    }
+
+    /** Solves the n x n system a * x = b in place by Gaussian elimination with partial pivoting */
+    template <size_t n>
+    bool solveLinearSystem(std::array<std::array<double, n>, n>& a, std::array<double, n>& b, std::array<double, n>& x)
+    {
+        for (size_t col = 0; col < n; ++col)
+        {
+            size_t pivot = col;
+
+            for (size_t row = col + 1; row < n; ++row)
+                if (std::abs(a[row][col]) > std::abs(a[pivot][col]))
+                    pivot = row;
+
+            if (std::abs(a[pivot][col]) < 1.0e-12)
+                return false;
+
+            std::swap(a[pivot], a[col]);
+            std::swap(b[pivot], b[col]);
+
+            for (size_t row = col + 1; row < n; ++row)
+            {
+                auto factor = a[row][col] / a[col][col];
+
+                for (size_t k = col; k < n; ++k)
+                    a[row][k] -= factor * a[col][k];
+
+                b[row] -= factor * b[col];
+            }
+        }
+
+        for (size_t i = n; i-- > 0;)
+        {
+            auto sum = b[i];
+
+            for (size_t k = i + 1; k < n; ++k)
+                sum -= a[i][k] * x[k];
+
+            x[i] = sum / a[i][i];
+        }
+
+        return true;
+    }
+
+    /** Accumulates one least-squares row into the normal equations (A^T A) x = A^T b */
+    template <size_t n>
+    void accumulateNormalEquations(std::array<std::array<double, n>, n>& ata, std::array<double, n>& atb,
+                                   const std::array<double, n>& row, double rhs)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            for (size_t j = 0; j < n; ++j)
+                ata[i][j] += row[i] * row[j];
+
+            atb[i] += row[i] * rhs;
+        }
+    }
+
+    /** Maps a point through a row-major 3x3 matrix */
+    juce::Point<double> mapThrough(const std::array<double, 9>& m, double x, double y)
+    {
+        auto w = m[6] * x + m[7] * y + m[8];
+        return { (m[0] * x + m[1] * y + m[2]) / w,
+                 (m[3] * x + m[4] * y + m[5]) / w };
+    }
+
+    /** Inverts a 3x3 matrix via its adjugate. Returns false if it is singular */
+    bool invert(const std::array<double, 9>& m, std::array<double, 9>& result)
+    {
+        result = { m[4] * m[8] - m[5] * m[7], m[2] * m[7] - m[1] * m[8], m[1] * m[5] - m[2] * m[4],
+                   m[5] * m[6] - m[3] * m[8], m[0] * m[8] - m[2] * m[6], m[2] * m[3] - m[0] * m[5],
+                   m[3] * m[7] - m[4] * m[6], m[1] * m[6] - m[0] * m[7], m[0] * m[4] - m[1] * m[3] };
+
+        auto det = m[0] * result[0] + m[1] * result[3] + m[2] * result[6];
+
+        if (std::abs(det) < 1.0e-18)
+            return false;
+
+        for (auto& v : result)
+            v /= det;
+
+        return true;
+    }
+
+    /** Keeps filter settings from a file or caller within a usable range */
+    TouchFilter::Options validateFilterOptions(TouchFilter::Options options)
+    {
+        options.minCutoffHz = juce::jlimit(0.01f, 1000.0f, options.minCutoffHz);
+        options.beta = juce::jlimit(0.0f, 1.0e6f, options.beta);
+        options.derivativeCutoffHz = juce::jlimit(0.01f, 1000.0f, options.derivativeCutoffHz);
+        return options;
+    }
 }
 
-std::unique_ptr<juce::XmlElement> TouchCalibrationManager::createDefaultXml() const
+std::unique_ptr<juce::XmlElement> TouchCalibrationManager::createDefaultXml(const CalibrationSnapshot& calibration) const
 {
+    const auto& bounds = calibration.bounds;
+
     auto xml = std::make_unique<juce::XmlElement>("TouchScreenCalibration");
     xml->setAttribute("version", "1.0");
 
-    auto* bounds = xml->createNewChildElement("Bounds");
-    bounds->createNewChildElement("MinX")->addTextElement(juce::String(currentBounds.minX));
-    bounds->createNewChildElement("MaxX")->addTextElement(juce::String(currentBounds.maxX));
-    bounds->createNewChildElement("MinY")->addTextElement(juce::String(currentBounds.minY));
-    bounds->createNewChildElement("MaxY")->addTextElement(juce::String(currentBounds.maxY));
+    auto* boundsElement = xml->createNewChildElement("Bounds");
+    boundsElement->createNewChildElement("MinX")->addTextElement(juce::String(bounds.minX));
+    boundsElement->createNewChildElement("MaxX")->addTextElement(juce::String(bounds.maxX));
+    boundsElement->createNewChildElement("MinY")->addTextElement(juce::String(bounds.minY));
+    boundsElement->createNewChildElement("MaxY")->addTextElement(juce::String(bounds.maxY));
+
+    if (calibration.model != TransformModel::bounds)
+    {
+        juce::StringArray values;
+
+        for (auto v : calibration.matrix)
+            values.add(juce::String(v, 9));
+
+        auto* transformElement = xml->createNewChildElement("Transform");
+        transformElement->setAttribute("model", getModelName(calibration.model));
+        transformElement->addTextElement(values.joinIntoString(" "));
+    }
+
+    if (auto* correction = calibration.correction)
+    {
+        juce::StringArray values;
+
+        for (auto error : correction->errors)
+        {
+            values.add(juce::String(error.x, 6));
+            values.add(juce::String(error.y, 6));
+        }
+
+        auto* correctionElement = xml->createNewChildElement("Correction");
+        correctionElement->setAttribute("columns", correction->columns);
+        correctionElement->setAttribute("rows", correction->rows);
+        correctionElement->setAttribute("x", correction->gridArea.getX());
+        correctionElement->setAttribute("y", correction->gridArea.getY());
+        correctionElement->setAttribute("width", correction->gridArea.getWidth());
+        correctionElement->setAttribute("height", correction->gridArea.getHeight());
+        correctionElement->addTextElement(values.joinIntoString(" "));
+    }
+
+    auto* filterElement = xml->createNewChildElement("Filter");
+    filterElement->setAttribute("enabled", calibration.filter.enabled);
+    filterElement->setAttribute("minCutoffHz", calibration.filter.minCutoffHz);
+    filterElement->setAttribute("beta", calibration.filter.beta);
+    filterElement->setAttribute("derivativeCutoffHz", calibration.filter.derivativeCutoffHz);
 
     auto* metadata = xml->createNewChildElement("Metadata");
     metadata->createNewChildElement("CalibrationDate")->addTextElement(juce::Time::getCurrentTime().toISO8601(true));
-    metadata->createNewChildElement("IsCalibrated")->addTextElement(currentBounds.isCalibrated ? "true" : "false");
+    metadata->createNewChildElement("IsCalibrated")->addTextElement(bounds.isCalibrated ? "true" : "false");
 
     return xml;
 }
 
 bool TouchCalibrationManager::loadFromFile()
 {
-    juce::ScopedLock sl(lock);
+    juce::ScopedLock sl(writeLock);
+
+    auto state = getCurrentState();
 
-    auto file = getCalibrationFile();
+    if (!readProfile(getCalibrationFile(), state))
+        return false;
 
+    setCurrentState(state);
+    publishSnapshot();
+    return true;
+}
+
+bool TouchCalibrationManager::readProfile(const juce::File& file, ProfileState& state)
+{
     if (!file.existsAsFile())
     {
         DBG("TouchCalibrationManager: No calibration file found, using defaults");
         return false;
     }
 
+    // The XML is authoritative; the cache is only used while it is at least as new,
+    // so a hand-edited XML still wins
+    auto cacheFile = file.withFileExtension("bin");
+
+    if (cacheFile.existsAsFile() && cacheFile.getLastModificationTime() >= file.getLastModificationTime()
+         && loadFromCache(cacheFile, state))
+    {
+        DBG("TouchCalibrationManager: Loaded " << getModelName(state.model) << " calibration from cache");
+        return true;
+    }
+
     // Parse XML file
     juce::XmlDocument xmlDoc(file);
     auto xml = xmlDoc.getDocumentElement();
@@ -75,16 +384,19 @@ bool TouchCalibrationManager::loadFromFile()
     }
 
     // Parse bounds
-    parseBoundsFromXml(xml.get());
+    parseBoundsFromXml(xml.get(), state);
+
+    // Rebuild a missing or stale cache for next time
+    writeCache(createSnapshot(state), cacheFile);
 
-    DBG("TouchCalibrationManager: Loaded calibration from file");
-    DBG("  X range: " << currentBounds.minX << " to " << currentBounds.maxX);
-    DBG("  Y range: " << currentBounds.minY << " to " << currentBounds.maxY);
+    DBG("TouchCalibrationManager: Loaded " << getModelName(state.model) << " calibration from file");
+    DBG("  X range: " << state.bounds.minX << " to " << state.bounds.maxX);
+    DBG("  Y range: " << state.bounds.minY << " to " << state.bounds.maxY);
 
     return true;
 }
 
-void TouchCalibrationManager::parseBoundsFromXml(const juce::XmlElement* xml)
+void TouchCalibrationManager::parseBoundsFromXml(const juce::XmlElement* xml, ProfileState& state)
 {
     if (xml == nullptr)
         return;
@@ -112,11 +424,11 @@ void TouchCalibrationManager::parseBoundsFromXml(const juce::XmlElement* xml)
         // Validate ranges
         if (minX < maxX && minY < maxY)
         {
-            currentBounds.minX = minX;
-            currentBounds.maxX = maxX;
-            currentBounds.minY = minY;
-            currentBounds.maxY = maxY;
-            currentBounds.isCalibrated = true;
+            state.bounds.minX = minX;
+            state.bounds.maxX = maxX;
+            state.bounds.minY = minY;
+            state.bounds.maxY = maxY;
+            state.bounds.isCalibrated = true;
         }
         else
         {
@@ -127,28 +439,296 @@ void TouchCalibrationManager::parseBoundsFromXml(const juce::XmlElement* xml)
     {
         DBG("TouchCalibrationManager: Missing bound elements, using defaults");
     }
+
+    // Optional multi-point transform; files written before it existed only have bounds
+    state.model = TransformModel::bounds;
+
+    if (auto* transformElement = xml->getChildByName("Transform"))
+    {
+        auto modelName = transformElement->getStringAttribute("model");
+        auto values = juce::StringArray::fromTokens(transformElement->getAllSubText(), false);
+        values.removeEmptyStrings();
+
+        if (values.size() == 9 && (modelName == "affine" || modelName == "projective"))
+        {
+            for (int i = 0; i < 9; ++i)
+                state.matrix[(size_t) i] = values[i].getFloatValue();
+
+            if (state.matrix[8] != 0.0f && state.bounds.isCalibrated)
+                state.model = modelName == "affine" ? TransformModel::affine : TransformModel::projective;
+            else
+                DBG("TouchCalibrationManager: Invalid transform in XML, using bounds");
+        }
+        else
+        {
+            DBG("TouchCalibrationManager: Malformed transform in XML, using bounds");
+        }
+    }
+
+    // Optional non-linear correction, rebaked against the linear calibration just loaded
+    state.correction = nullptr;
+
+    if (auto* correctionElement = xml->getChildByName("Correction"))
+    {
+        int columns = correctionElement->getIntAttribute("columns");
+        int rows = correctionElement->getIntAttribute("rows");
+        juce::Rectangle<float> gridArea ((float) correctionElement->getDoubleAttribute("x"),
+                                         (float) correctionElement->getDoubleAttribute("y"),
+                                         (float) correctionElement->getDoubleAttribute("width"),
+                                         (float) correctionElement->getDoubleAttribute("height"));
+
+        auto values = juce::StringArray::fromTokens(correctionElement->getAllSubText(), false);
+        values.removeEmptyStrings();
+
+        if (columns >= 2 && rows >= 2 && values.size() == columns * rows * 2 && !gridArea.isEmpty()
+             && state.bounds.isCalibrated)
+        {
+            std::vector<juce::Point<float>> errors;
+
+            for (int i = 0; i < values.size(); i += 2)
+                errors.push_back({ values[i].getFloatValue(), values[i + 1].getFloatValue() });
+
+            state.correction = createCorrection(columns, rows, gridArea, std::move(errors), createLinearSnapshot(state));
+        }
+        else
+        {
+            DBG("TouchCalibrationManager: Malformed correction grid in XML, ignoring it");
+        }
+    }
+
+    // Optional jitter filter; missing attributes keep their defaults
+    state.filter = {};
+
+    if (auto* filterElement = xml->getChildByName("Filter"))
+    {
+        state.filter.enabled = filterElement->getBoolAttribute("enabled", state.filter.enabled);
+        state.filter.minCutoffHz = (float) filterElement->getDoubleAttribute("minCutoffHz", state.filter.minCutoffHz);
+        state.filter.beta = (float) filterElement->getDoubleAttribute("beta", state.filter.beta);
+        state.filter.derivativeCutoffHz = (float) filterElement->getDoubleAttribute("derivativeCutoffHz", state.filter.derivativeCutoffHz);
+        state.filter = validateFilterOptions(state.filter);
+    }
+}
+
+bool TouchCalibrationManager::loadFromCache(const juce::File& cacheFile, ProfileState& state)
+{
+    juce::FileInputStream in(cacheFile);
+
+    if (!in.openedOk() || in.readInt() != cacheMagic || in.readInt() != cacheVersion)
+        return false;
+
+    CalibrationBounds bounds;
+    bounds.minX = in.readFloat();
+    bounds.maxX = in.readFloat();
+    bounds.minY = in.readFloat();
+    bounds.maxY = in.readFloat();
+    bounds.isCalibrated = in.readBool();
+
+    auto model = in.readInt();
+    std::array<float, 9> matrix;
+
+    for (auto& v : matrix)
+        v = in.readFloat();
+
+    TouchFilter::Options filter;
+    filter.enabled = in.readBool();
+    filter.minCutoffHz = in.readFloat();
+    filter.beta = in.readFloat();
+    filter.derivativeCutoffHz = in.readFloat();
+
+    const int columns = in.readInt();
+    const int rows = in.readInt();
+
+    if (model < (int) TransformModel::bounds || model > (int) TransformModel::projective
+         || columns < 0 || rows < 0 || columns > 64 || rows > 64)
+        return false;
+
+    // Reads past the end return zeros, so reject truncated or oversized files up front
+    const juce::int64 remaining = columns > 0 ? (juce::int64) (4 + 2 * columns * rows) * (juce::int64) sizeof(float) : 0;
+
+    if (in.getTotalLength() != in.getPosition() + remaining)
+        return false;
+
+    juce::Rectangle<float> gridArea;
+    std::vector<juce::Point<float>> errors;
+
+    if (columns > 0)
+    {
+        float x = in.readFloat(), y = in.readFloat(), w = in.readFloat(), h = in.readFloat();
+        gridArea = { x, y, w, h };
+
+        for (int i = 0; i < columns * rows; ++i)
+        {
+            float dx = in.readFloat();
+            errors.push_back({ dx, in.readFloat() });
+        }
+    }
+
+    if (bounds.isCalibrated && (bounds.minX >= bounds.maxX || bounds.minY >= bounds.maxY))
+        return false;
+
+    state.bounds = bounds;
+    state.model = (TransformModel) model;
+    state.matrix = matrix;
+    state.correction = nullptr;
+    state.filter = validateFilterOptions(filter);
+
+    if (columns >= 2 && rows >= 2 && !gridArea.isEmpty())
+        state.correction = createCorrection(columns, rows, gridArea, std::move(errors), createLinearSnapshot(state));
+
+    return true;
+}
+
+bool TouchCalibrationManager::writeCache(const CalibrationSnapshot& calibration, const juce::File& cacheFile) const
+{
+    juce::MemoryOutputStream out;
+    out.writeInt(cacheMagic);
+    out.writeInt(cacheVersion);
+
+    out.writeFloat(calibration.bounds.minX);
+    out.writeFloat(calibration.bounds.maxX);
+    out.writeFloat(calibration.bounds.minY);
+    out.writeFloat(calibration.bounds.maxY);
+    out.writeBool(calibration.bounds.isCalibrated);
+
+    out.writeInt((int) calibration.model);
+
+    for (auto v : calibration.matrix)
+        out.writeFloat(v);
+
+    out.writeBool(calibration.filter.enabled);
+    out.writeFloat(calibration.filter.minCutoffHz);
+    out.writeFloat(calibration.filter.beta);
+    out.writeFloat(calibration.filter.derivativeCutoffHz);
+
+    if (auto* correction = calibration.correction)
+    {
+        out.writeInt(correction->columns);
+        out.writeInt(correction->rows);
+        out.writeFloat(correction->gridArea.getX());
+        out.writeFloat(correction->gridArea.getY());
+        out.writeFloat(correction->gridArea.getWidth());
+        out.writeFloat(correction->gridArea.getHeight());
+
+        for (auto error : correction->errors)
+        {
+            out.writeFloat(error.x);
+            out.writeFloat(error.y);
+        }
+    }
+    else
+    {
+        out.writeInt(0);
+        out.writeInt(0);
+    }
+
+    // Write beside the target and rename over it, so a crash never leaves a partial file
+    juce::TemporaryFile temp(cacheFile);
+
+    return temp.getFile().replaceWithData(out.getData(), out.getDataSize())
+            && temp.overwriteTargetFileWithTemporary();
 }
 
 bool TouchCalibrationManager::saveToFile()
 {
-    juce::ScopedLock sl(lock);
+    return saveProfile(getActiveProfileKey());
+}
+
+bool TouchCalibrationManager::saveProfile(const juce::String& key)
+{
+    const juce::ScopedLock sl(saveLock);
+
+    // Works from the profile's published snapshot, so no lock is held while writing to disk
+    CalibrationSnapshot calibration;
+    juce::File file;
+
+    {
+        const juce::ScopedLock stateLock(writeLock);
+        calibration = publishedProfiles[key].load();
+        file = getProfileFile(key);
+    }
+
+    const auto& bounds = calibration.bounds;
+    auto xml = createDefaultXml(calibration);
 
-    auto file = getCalibrationFile();
-    auto xml = createDefaultXml();
+    // Write beside the target and rename over it, so a crash never leaves a partial file
+    juce::TemporaryFile temp(file);
 
-    if (!xml->writeTo(file))
+    if (!xml->writeTo(temp.getFile()) || !temp.overwriteTargetFileWithTemporary())
     {
         DBG("TouchCalibrationManager: Failed to write calibration file");
         return false;
     }
 
+    // After the XML, so the cache is never older than the file it mirrors
+    if (!writeCache(calibration, file.withFileExtension("bin")))
+        DBG("TouchCalibrationManager: Failed to write calibration cache");
+
     DBG("TouchCalibrationManager: Saved calibration to file");
-    DBG("  X range: " << currentBounds.minX << " to " << currentBounds.maxX);
-    DBG("  Y range: " << currentBounds.minY << " to " << currentBounds.maxY);
+    DBG("  X range: " << bounds.minX << " to " << bounds.maxX);
+    DBG("  Y range: " << bounds.minY << " to " << bounds.maxY);
 
     return true;
 }
 
+void TouchCalibrationManager::saveInBackground()
+{
+    {
+        const juce::ScopedLock sl(writeLock);
+        profilesToSave.addIfNotAlreadyThere(activeProfileKey);
+
+        // What is in memory now is newer than the profile's file
+        profilesToLoad.removeString(activeProfileKey);
+    }
+
+    if (!isThreadRunning())
+        startThread();
+
+    notify();
+}
+
+void TouchCalibrationManager::flushPendingSave()
+{
+    // Holding saveLock also waits out a write the background thread already started
+    const juce::ScopedLock sl(saveLock);
+    juce::StringArray keys;
+
+    {
+        const juce::ScopedLock stateLock(writeLock);
+        keys.swapWith(profilesToSave);
+    }
+
+    for (auto& key : keys)
+        saveProfile(key);
+}
+
+void TouchCalibrationManager::run()
+{
+    auto hasQueuedSaves = [this]
+    {
+        const juce::ScopedLock sl(writeLock);
+        return !profilesToSave.isEmpty();
+    };
+
+    while (!threadShouldExit())
+    {
+        wait(-1);
+
+        // A connected panel is waiting on its profile, so loads don't wait for saves to settle
+        loadQueuedProfiles();
+
+        if (!hasQueuedSaves())
+            continue;
+
+        // Let a burst of updates (e.g. a calibration followed by its correction grid) settle
+        while (!threadShouldExit() && wait(saveCoalesceMs))
+            loadQueuedProfiles();
+
+        flushPendingSave();
+    }
+
+    flushPendingSave();
+}
+
 void TouchCalibrationManager::setCalibrationPoints(const TouchData& topLeft, const TouchData& bottomRight)
 {
     // Validate both points
@@ -158,17 +738,16 @@ void TouchCalibrationManager::setCalibrationPoints(const TouchData& topLeft, con
         return;
     }
 
-    juce::ScopedLock sl(lock);
-
     // Calculate bounds (handle any order of points)
-    currentBounds.minX = juce::jmin((float)topLeft.x, (float)bottomRight.x);
-    currentBounds.maxX = juce::jmax((float)topLeft.x, (float)bottomRight.x);
-    currentBounds.minY = juce::jmin((float)topLeft.y, (float)bottomRight.y);
-    currentBounds.maxY = juce::jmax((float)topLeft.y, (float)bottomRight.y);
+    CalibrationBounds bounds;
+    bounds.minX = juce::jmin((float)topLeft.x, (float)bottomRight.x);
+    bounds.maxX = juce::jmax((float)topLeft.x, (float)bottomRight.x);
+    bounds.minY = juce::jmin((float)topLeft.y, (float)bottomRight.y);
+    bounds.maxY = juce::jmax((float)topLeft.y, (float)bottomRight.y);
 
     // Validate separation
-    float deltaX = currentBounds.maxX - currentBounds.minX;
-    float deltaY = currentBounds.maxY - currentBounds.minY;
+    float deltaX = bounds.maxX - bounds.minX;
+    float deltaY = bounds.maxY - bounds.minY;
 
     if (deltaX < 20000.0f || deltaY < 20000.0f)
     {
@@ -177,44 +756,477 @@ void TouchCalibrationManager::setCalibrationPoints(const TouchData& topLeft, con
         return;
     }
 
-    currentBounds.isCalibrated = true;
+    bounds.isCalibrated = true;
+
+    {
+        juce::ScopedLock sl(writeLock);
+        currentBounds = bounds;
+        currentModel = TransformModel::bounds;
+        currentCorrection = nullptr;
+        publishSnapshot();
+    }
 
     DBG("TouchCalibrationManager: Calibration set successfully");
 
-    // Save to file (lock will auto-release when sl goes out of scope)
-    saveToFile();
+    // Readers already see the new calibration; the file follows in the background
+    saveInBackground();
+}
+
+bool TouchCalibrationManager::setCalibrationPoints(const std::vector<CalibrationPoint>& points, TransformModel model)
+{
+    std::array<float, 9> matrix;
+
+    if (!solveTransform(points, model, matrix))
+    {
+        DBG("TouchCalibrationManager: Could not solve " << getModelName(model) << " calibration from "
+            << (int) points.size() << " points");
+        return false;
+    }
+
+    // Raw-space bounding box of the screen, for code that still reads getBounds()
+    std::array<double, 9> forward, inverse;
+    std::copy(matrix.begin(), matrix.end(), forward.begin());
+
+    if (!invert(forward, inverse))
+        return false;
+
+    CalibrationBounds bounds;
+    bounds.minX = bounds.minY = std::numeric_limits<float>::max();
+    bounds.maxX = bounds.maxY = std::numeric_limits<float>::lowest();
+
+    for (auto corner : { juce::Point<double>(0, 0), juce::Point<double>(1, 0),
+                         juce::Point<double>(1, 1), juce::Point<double>(0, 1) })
+    {
+        auto raw = mapThrough(inverse, corner.x, corner.y).toFloat();
+        bounds.minX = juce::jmin(bounds.minX, raw.x);
+        bounds.maxX = juce::jmax(bounds.maxX, raw.x);
+        bounds.minY = juce::jmin(bounds.minY, raw.y);
+        bounds.maxY = juce::jmax(bounds.maxY, raw.y);
+    }
+
+    bounds.isCalibrated = true;
+
+    {
+        juce::ScopedLock sl(writeLock);
+        currentBounds = bounds;
+        currentModel = model;
+        currentMatrix = matrix;
+        currentCorrection = nullptr;
+        publishSnapshot();
+    }
+
+    DBG("TouchCalibrationManager: " << getModelName(model) << " calibration set from "
+        << (int) points.size() << " points");
+
+    saveInBackground();
+    return true;
+}
+
+bool TouchCalibrationManager::solveTransform(const std::vector<CalibrationPoint>& points, TransformModel model,
+                                             std::array<float, 9>& matrix)
+{
+    const int numPoints = (int) points.size();
+
+    if (model == TransformModel::bounds || numPoints < minCalibrationPoints || numPoints > maxCalibrationPoints)
+        return false;
+
+    // Condition the system: centre the raw points and scale them to an average distance of sqrt(2)
+    double meanX = 0.0, meanY = 0.0;
+
+    for (auto& p : points)
+    {
+        meanX += p.raw.x;
+        meanY += p.raw.y;
+    }
+
+    meanX /= numPoints;
+    meanY /= numPoints;
+
+    double meanDistance = 0.0;
+
+    for (auto& p : points)
+        meanDistance += std::hypot(p.raw.x - meanX, p.raw.y - meanY);
+
+    meanDistance /= numPoints;
+
+    if (meanDistance < 1.0)
+        return false;
+
+    const double s = std::sqrt(2.0) / meanDistance;
+
+    // Solve in conditioned space: h maps (s (x - meanX), s (y - meanY)) to the target
+    std::array<double, 9> h { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 1.0 };
+
+    if (model == TransformModel::affine)
+    {
+        // The two output rows are independent 3-parameter fits sharing one design matrix
+        std::array<std::array<double, 3>, 3> ata {};
+        std::array<double, 3> atbX {}, atbY {};
+
+        for (auto& p : points)
+        {
+            std::array<double, 3> row { s * (p.raw.x - meanX), s * (p.raw.y - meanY), 1.0 };
+            accumulateNormalEquations(ata, atbX, row, p.target.x);
+
+            for (size_t i = 0; i < 3; ++i)
+                atbY[i] += row[i] * p.target.y;
+        }
+
+        auto ataCopy = ata;
+        std::array<double, 3> rowX, rowY;
+
+        if (!solveLinearSystem(ata, atbX, rowX) || !solveLinearSystem(ataCopy, atbY, rowY))
+            return false;
+
+        h = { rowX[0], rowX[1], rowX[2], rowY[0], rowY[1], rowY[2], 0.0, 0.0, 1.0 };
+    }
+    else
+    {
+        // Direct linear transform with h8 = 1, two equations per point
+        std::array<std::array<double, 8>, 8> ata {};
+        std::array<double, 8> atb {};
+
+        for (auto& p : points)
+        {
+            double x = s * (p.raw.x - meanX), y = s * (p.raw.y - meanY);
+            double u = p.target.x, v = p.target.y;
+
+            accumulateNormalEquations(ata, atb, { x, y, 1.0, 0.0, 0.0, 0.0, -x * u, -y * u }, u);
+            accumulateNormalEquations(ata, atb, { 0.0, 0.0, 0.0, x, y, 1.0, -x * v, -y * v }, v);
+        }
+
+        std::array<double, 8> solution;
+
+        if (!solveLinearSystem(ata, atb, solution))
+            return false;
+
+        std::copy(solution.begin(), solution.end(), h.begin());
+    }
+
+    // Fold the conditioning back in: H = h * [s 0 -s meanX; 0 s -s meanY; 0 0 1]
+    std::array<double, 9> result;
+
+    for (size_t r = 0; r < 3; ++r)
+    {
+        result[r * 3 + 0] = h[r * 3 + 0] * s;
+        result[r * 3 + 1] = h[r * 3 + 1] * s;
+        result[r * 3 + 2] = h[r * 3 + 2] - s * (h[r * 3 + 0] * meanX + h[r * 3 + 1] * meanY);
+    }
+
+    if (std::abs(result[8]) < 1.0e-12)
+        return false;
+
+    const auto norm = result[8];
+
+    for (auto& v : result)
+        v /= norm;
+
+    // Every tapped target must lie in front of the projection, or the fit is folded
+    for (auto& p : points)
+        if (result[6] * p.raw.x + result[7] * p.raw.y + result[8] <= 0.0)
+            return false;
+
+    for (size_t i = 0; i < 9; ++i)
+        matrix[i] = (float) result[i];
+
+    return true;
+}
+
+bool TouchCalibrationManager::setCorrectionGrid(const std::vector<CalibrationPoint>& points, int columns, int rows)
+{
+    if (columns < 2 || rows < 2 || (int) points.size() != columns * rows)
+    {
+        DBG("TouchCalibrationManager: Correction grid needs columns x rows points");
+        return false;
+    }
+
+    // The targets' extent defines the grid; points are row-major inside it
+    auto topLeft = points.front().target, bottomRight = points.front().target;
+
+    for (auto& p : points)
+    {
+        topLeft = { juce::jmin(topLeft.x, p.target.x), juce::jmin(topLeft.y, p.target.y) };
+        bottomRight = { juce::jmax(bottomRight.x, p.target.x), juce::jmax(bottomRight.y, p.target.y) };
+    }
+
+    juce::Rectangle<float> gridArea (topLeft, bottomRight);
+
+    if (gridArea.isEmpty())
+        return false;
+
+    {
+        juce::ScopedLock sl(writeLock);
+
+        if (!currentBounds.isCalibrated)
+        {
+            DBG("TouchCalibrationManager: Calibrate before capturing a correction grid");
+            return false;
+        }
+
+        // Residual of the linear calibration at each target
+        auto linear = createLinearSnapshot();
+        std::vector<juce::Point<float>> errors;
+        errors.reserve(points.size());
+
+        for (auto& p : points)
+        {
+            TouchData touch;
+            touch.x = (uint16_t) juce::jlimit(0.0f, 65535.0f, p.raw.x);
+            touch.y = (uint16_t) juce::jlimit(0.0f, 65535.0f, p.raw.y);
+            errors.push_back(p.target - linear.apply(touch));
+        }
+
+        currentCorrection = createCorrection(columns, rows, gridArea, std::move(errors), linear);
+        publishSnapshot();
+    }
+
+    DBG("TouchCalibrationManager: " << columns << "x" << rows << " correction grid set");
+
+    saveInBackground();
+    return true;
 }
 
-TouchCalibrationManager::CalibrationBounds TouchCalibrationManager::getBounds() const
+void TouchCalibrationManager::clearCorrection()
 {
-    juce::ScopedLock sl(lock);
-    return currentBounds;
+    {
+        juce::ScopedLock sl(writeLock);
+        currentCorrection = nullptr;
+        publishSnapshot();
+    }
+
+    saveInBackground();
+}
+
+// Zero-initialised static storage: no constructor runs and untouched pages cost nothing
+const TouchCalibrationManager::CorrectionTable::Node
+    TouchCalibrationManager::CorrectionTable::noResidual[nodesPerAxis * nodesPerAxis] {};
+
+const TouchCalibrationManager::CorrectionTable* TouchCalibrationManager::createCorrection(int columns, int rows,
+                                                                                           juce::Rectangle<float> gridArea,
+                                                                                           std::vector<juce::Point<float>> errors,
+                                                                                           const CalibrationSnapshot& linear)
+{
+    auto table = std::make_unique<CorrectionTable>();
+    table->columns = columns;
+    table->rows = rows;
+    table->gridArea = gridArea;
+    table->errors = std::move(errors);
+    table->nodes.resize((size_t) (CorrectionTable::nodesPerAxis * CorrectionTable::nodesPerAxis));
+
+    const auto& m = linear.matrix;
+    const auto& e = table->errors;
+
+    // Bilinear sample of the coarse grid at a screen position; outside the grid the edge error holds
+    auto sampleError = [&](juce::Point<float> position)
+    {
+        const float gx = juce::jlimit(0.0f, (float) (columns - 1), (position.x - gridArea.getX()) / gridArea.getWidth() * (float) (columns - 1));
+        const float gy = juce::jlimit(0.0f, (float) (rows - 1), (position.y - gridArea.getY()) / gridArea.getHeight() * (float) (rows - 1));
+        const int cx = juce::jmin((int) gx, columns - 2);
+        const int cy = juce::jmin((int) gy, rows - 2);
+        const float fx = gx - (float) cx;
+        const float fy = gy - (float) cy;
+
+        auto at = [&](int c, int r) { return e[(size_t) (r * columns + c)]; };
+
+        auto top = at(cx, cy) + (at(cx + 1, cy) - at(cx, cy)) * fx;
+        auto bottom = at(cx, cy + 1) + (at(cx + 1, cy + 1) - at(cx, cy + 1)) * fx;
+        return top + (bottom - top) * fy;
+    };
+
+    for (int j = 0; j < CorrectionTable::nodesPerAxis; ++j)
+    {
+        for (int i = 0; i < CorrectionTable::nodesPerAxis; ++i)
+        {
+            const float x = (float) (i * CorrectionTable::cellSize);
+            const float y = (float) (j * CorrectionTable::cellSize);
+            const float w = m[6] * x + m[7] * y + m[8];
+            const juce::Point<float> position { (m[0] * x + m[1] * y + m[2]) / w,
+                                                (m[3] * x + m[4] * y + m[5]) / w };
+
+            // The grid's errors were measured at the true screen positions, so refine the
+            // node's position with one correction step before taking its error
+            auto error = sampleError(position);
+            error = sampleError(position + error);
+
+            table->nodes[(size_t) (j * CorrectionTable::nodesPerAxis + i)] = { error.x, error.y };
+        }
+    }
+
+    correctionTables.push_back(std::move(table));
+    return correctionTables.back().get();
+}
+
+void TouchCalibrationManager::setFilterOptions(const TouchFilter::Options& options)
+{
+    {
+        juce::ScopedLock sl(writeLock);
+        currentFilter = validateFilterOptions(options);
+        publishSnapshot();
+    }
+
+    saveInBackground();
 }
 
 void TouchCalibrationManager::resetToDefaults()
 {
-    juce::ScopedLock sl(lock);
+    juce::ScopedLock sl(writeLock);
+    currentModel = TransformModel::bounds;
+    currentCorrection = nullptr;
     currentBounds.minX = 101.0f;
     currentBounds.maxX = 29947.0f;
     currentBounds.minY = 133.0f;
     currentBounds.maxY = 29986.0f;
     currentBounds.isCalibrated = false;
+    publishSnapshot();
 }
 
-juce::Point<float> TouchCalibrationManager::convertTouchToNormalized(const TouchData &touch) const
+TouchCalibrationManager::ProfileState TouchCalibrationManager::getCurrentState() const
+{
+    return { currentBounds, currentModel, currentMatrix, currentCorrection, currentFilter };
+}
+
+void TouchCalibrationManager::setCurrentState(const ProfileState& state)
 {
-    juce::ScopedLock sl(lock);
+    currentBounds = state.bounds;
+    currentModel = state.model;
+    currentMatrix = state.matrix;
+    currentCorrection = state.correction;
+    currentFilter = state.filter;
+}
 
-    if (currentBounds.isCalibrated)
+TouchCalibrationManager::CalibrationSnapshot TouchCalibrationManager::createLinearSnapshot(const ProfileState& state)
+{
+    auto calibration = CalibrationSnapshot::fromBounds(state.bounds);
+
+    if (state.model != TransformModel::bounds)
     {
-        return juce::Point<float>((touch.x - currentBounds.minX) / (currentBounds.maxX - currentBounds.minX),
-                                  (touch.y - currentBounds.minY) / (currentBounds.maxY - currentBounds.minY));
+        calibration.model = state.model;
+        calibration.matrix = state.matrix;
     }
-    else
+
+    return calibration;
+}
+
+TouchCalibrationManager::CalibrationSnapshot TouchCalibrationManager::createSnapshot(const ProfileState& state)
+{
+    auto calibration = createLinearSnapshot(state);
+    calibration.correction = state.correction;
+    calibration.residuals = state.correction != nullptr ? state.correction->nodes.data() : CorrectionTable::noResidual;
+    calibration.filter = state.filter;
+    return calibration;
+}
+
+void TouchCalibrationManager::publishSnapshot()
+{
+    const auto calibration = createSnapshot(getCurrentState());
+    snapshot.store(calibration);
+    publishedProfiles[activeProfileKey].store(calibration);
+}
+
+TouchCalibrationManager::CalibrationSnapshot TouchCalibrationManager::CalibrationSnapshot::fromBounds(const CalibrationBounds& bounds) noexcept
+{
+    CalibrationSnapshot result;
+    result.bounds = bounds;
+
+    if (bounds.isCalibrated)
     {
-        jassert(false);
-        return juce::Point<float>(touch.x / 32768.0f, touch.y / 32768.0f);
+        const float scaleX = 1.0f / (bounds.maxX - bounds.minX);
+        const float scaleY = 1.0f / (bounds.maxY - bounds.minY);
+
+        result.matrix = { scaleX, 0.0f, -bounds.minX * scaleX,
+                          0.0f, scaleY, -bounds.minY * scaleY,
+                          0.0f, 0.0f, 1.0f };
     }
+
+    return result;
+}
+
+void TouchCalibrationManager::CalibrationSnapshot::applyToContacts(TouchData* contacts, int numContacts) const noexcept
+{
+    static_assert(TouchFrame::maxContacts % 4 == 0, "The SIMD loop processes whole groups of four contacts");
+    jassert(numContacts <= TouchFrame::maxContacts);
+
+    // Structure-of-arrays copy padded to a group of four. Padding lanes are (0, 0),
+    // which maps to w = m8 = 1, so the division below never sees zero
+    alignas(16) float xs[TouchFrame::maxContacts];
+    alignas(16) float ys[TouchFrame::maxContacts];
+    const int numPadded = (numContacts + 3) & ~3;
+
+    for (int i = 0; i < numContacts; ++i)
+    {
+        xs[i] = (float) contacts[i].x;
+        ys[i] = (float) contacts[i].y;
+    }
+
+    for (int i = numContacts; i < numPadded; ++i)
+        xs[i] = ys[i] = 0.0f;
+
+    const auto& m = matrix;
+
+   #if BS_HID_USE_SSE
+    const __m128 m0 = _mm_set1_ps(m[0]), m1 = _mm_set1_ps(m[1]), m2 = _mm_set1_ps(m[2]);
+    const __m128 m3 = _mm_set1_ps(m[3]), m4 = _mm_set1_ps(m[4]), m5 = _mm_set1_ps(m[5]);
+    const __m128 m6 = _mm_set1_ps(m[6]), m7 = _mm_set1_ps(m[7]), m8 = _mm_set1_ps(m[8]);
+
+    for (int i = 0; i < numPadded; i += 4)
+    {
+        const __m128 x = _mm_load_ps(xs + i);
+        const __m128 y = _mm_load_ps(ys + i);
+
+        const __m128 u = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, x), _mm_mul_ps(m1, y)), m2);
+        const __m128 v = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m3, x), _mm_mul_ps(m4, y)), m5);
+        const __m128 w = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m6, x), _mm_mul_ps(m7, y)), m8);
+
+        _mm_store_ps(xs + i, _mm_div_ps(u, w));
+        _mm_store_ps(ys + i, _mm_div_ps(v, w));
+    }
+   #elif BS_HID_USE_NEON
+    for (int i = 0; i < numPadded; i += 4)
+    {
+        const float32x4_t x = vld1q_f32(xs + i);
+        const float32x4_t y = vld1q_f32(ys + i);
+
+        const float32x4_t u = vmlaq_n_f32(vmlaq_n_f32(vdupq_n_f32(m[2]), x, m[0]), y, m[1]);
+        const float32x4_t v = vmlaq_n_f32(vmlaq_n_f32(vdupq_n_f32(m[5]), x, m[3]), y, m[4]);
+        const float32x4_t w = vmlaq_n_f32(vmlaq_n_f32(vdupq_n_f32(m[8]), x, m[6]), y, m[7]);
+
+        vst1q_f32(xs + i, vdivq_f32(u, w));
+        vst1q_f32(ys + i, vdivq_f32(v, w));
+    }
+   #else
+    for (int i = 0; i < numPadded; ++i)
+    {
+        const float x = xs[i], y = ys[i];
+        const float w = m[6] * x + m[7] * y + m[8];
+
+        xs[i] = (m[0] * x + m[1] * y + m[2]) / w;
+        ys[i] = (m[3] * x + m[4] * y + m[5]) / w;
+    }
+   #endif
+
+    // Non-linear residual: one bilinear lookup per contact, zero when there is no correction
+    for (int i = 0; i < numContacts; ++i)
+    {
+        auto residual = CorrectionTable::lookup(residuals, contacts[i].x, contacts[i].y);
+        xs[i] += residual.x;
+        ys[i] += residual.y;
+    }
+
+    for (int i = 0; i < numContacts; ++i)
+    {
+        contacts[i].normX = xs[i];
+        contacts[i].normY = ys[i];
+    }
+}
+
+juce::Point<float> TouchCalibrationManager::convertTouchToNormalized(const TouchData &touch) const
+{
+    auto current = snapshot.load();
+
+    // Uncalibrated screens fall back to a 0..32768 raw range
+    jassert(current.bounds.isCalibrated);
+
+    return current.apply(touch);
 }
 
 
@@ -12,8 +12,35 @@
 namespace bs_hid
 {
 
-/** Manages touch screen calibration data with persistent XML storage */
-class TouchCalibrationManager
+/** Manages touch screen calibration data with persistent XML storage.
+
+    A calibration is either the original two-corner bounds, or an affine or
+    projective transform solved from 4 to 9 tapped targets, which corrects
+    rotation, skew and keystone of a mounted panel. An optional correction
+    grid on top of that removes the non-linearity of cheap panels near the
+    edges.
+
+    The active calibration is published as an immutable CalibrationSnapshot
+    holding a precomputed 3x3 matrix. Readers (convertTouchToNormalized(),
+    getSnapshot(), getBounds()) never lock, so they are safe on the HID and
+    audio threads, including while a new calibration is being saved.
+
+    Changes are written to disk by a background thread, so setting a
+    calibration never blocks on file I/O. Rapid updates are coalesced into one
+    write, and files are replaced atomically, so a crash mid-save leaves the
+    previous calibration intact. A compact binary cache next to the XML lets
+    loadFromFile() skip XML parsing.
+
+    Each panel can keep its own calibration profile, keyed by vendor ID,
+    product ID and serial number (or its path if it has no serial), so
+    swapping panels between rigs picks up the right calibration. Devices
+    without a profile start from the shared touchScreen.xml until they are
+    calibrated. A profile also holds the panel's jitter filter settings.
+    Every profile is published on its own, so several panels connected at
+    once each map through their own calibration. Profiles are read from disk
+    by the background thread, so connecting a panel never waits for a file.
+*/
+class TouchCalibrationManager : private juce::Thread
 {
 public:
     /** Structure to hold calibration boundary values */
@@ -26,42 +53,292 @@ public:
         bool isCalibrated = false;
     };
 
+    /** How raw coordinates are mapped to the screen */
+    enum class TransformModel
+    {
+        bounds,         // Scale and offset from two corners
+        affine,         // Also corrects rotation and skew (3+ points)
+        projective      // Also corrects keystone (4+ points)
+    };
+
+    /** One calibration target: where it was drawn and where the panel reported the tap */
+    struct CalibrationPoint
+    {
+        juce::Point<float> raw;         // Reported raw coordinates
+        juce::Point<float> target;      // Target position, 0..1 across the screen
+    };
+
+    /** Dense non-linear correction baked from a coarse error grid.
+
+        Holds a residual (dx, dy) in normalised units at every node of a regular
+        grid over the raw 16-bit coordinates, 256 raw units apart (257 x 257
+        nodes, about 0.5 MB). lookup() interpolates bilinearly between the four
+        surrounding nodes; every raw value lands in a valid cell, so it has no
+        branches.
+    */
+    struct CorrectionTable
+    {
+        static constexpr int cellShift = 8;
+        static constexpr int cellSize = 1 << cellShift;
+        static constexpr int nodesPerAxis = (65536 >> cellShift) + 1;
+
+        struct Node { float dx, dy; };
+
+        /** All-zero nodes, looked up when there is no correction so the hot path never branches */
+        static const Node noResidual[nodesPerAxis * nodesPerAxis];
+
+        /** Residual to add to the calibrated position of a raw touch, from a table's nodes */
+        static juce::Point<float> lookup(const Node* nodes, uint16_t x, uint16_t y) noexcept
+        {
+            const float fx = (float) (x & (cellSize - 1)) * (1.0f / cellSize);
+            const float fy = (float) (y & (cellSize - 1)) * (1.0f / cellSize);
+
+            const Node* n0 = nodes + (size_t) (y >> cellShift) * nodesPerAxis + (x >> cellShift);
+            const Node* n1 = n0 + nodesPerAxis;
+
+            const float topX    = n0[0].dx + (n0[1].dx - n0[0].dx) * fx;
+            const float bottomX = n1[0].dx + (n1[1].dx - n1[0].dx) * fx;
+            const float topY    = n0[0].dy + (n0[1].dy - n0[0].dy) * fx;
+            const float bottomY = n1[0].dy + (n1[1].dy - n1[0].dy) * fx;
+
+            return { topX + (bottomX - topX) * fy, topY + (bottomY - topY) * fy };
+        }
+
+        // Coarse grid the table was baked from, kept so it can be saved
+        int columns = 0, rows = 0;
+        juce::Rectangle<float> gridArea;                // Targets' extent in normalised screen space
+        std::vector<juce::Point<float>> errors;         // Row-major, columns * rows
+
+        std::vector<Node> nodes;                        // Row-major by raw y, nodesPerAxis squared
+    };
+
+    /** Calibration ready for the hot path.
+
+        Maps raw (x, y) through a row-major 3x3 matrix m:
+            normX = (m0 x + m1 y + m2) / (m6 x + m7 y + m8)
+            normY = (m3 x + m4 y + m5) / (m6 x + m7 y + m8)
+        For the bounds and affine models the last row is (0, 0, 1). The
+        residual from the correction nodes is always added afterwards; without
+        a correction they are CorrectionTable::noResidual.
+    */
+    struct CalibrationSnapshot
+    {
+        CalibrationBounds bounds;
+        TransformModel model = TransformModel::bounds;
+        std::array<float, 9> matrix { 1.0f / 32768.0f, 0.0f, 0.0f,
+                                      0.0f, 1.0f / 32768.0f, 0.0f,
+                                      0.0f, 0.0f, 1.0f };
+        const CorrectionTable* correction = nullptr;    // Owned by the manager, nullptr if none
+        const CorrectionTable::Node* residuals = CorrectionTable::noResidual;
+        TouchFilter::Options filter;                    // Applied after calibration by HIDDeviceManager
+
+        /** Builds a scale/offset matrix from bounds (uncalibrated maps 0..32768 to 0..1) */
+        static CalibrationSnapshot fromBounds(const CalibrationBounds& bounds) noexcept;
+
+        /** Converts a raw touch to normalised coordinates */
+        juce::Point<float> apply(const TouchData& touch) const noexcept
+        {
+            const float x = (float) touch.x, y = (float) touch.y;
+            const float w = matrix[6] * x + matrix[7] * y + matrix[8];
+
+            juce::Point<float> result { (matrix[0] * x + matrix[1] * y + matrix[2]) / w,
+                                        (matrix[3] * x + matrix[4] * y + matrix[5]) / w };
+
+            return result + CorrectionTable::lookup(residuals, touch.x, touch.y);
+        }
+
+        /** Fills normX/normY of every contact, four contacts per SIMD instruction */
+        void applyToFrame(TouchFrame& frame) const noexcept { applyToContacts(frame.contacts.data(), frame.numContacts); }
+
+        /** Same as applyToFrame() for up to TouchFrame::maxContacts contacts in an array */
+        void applyToContacts(TouchData* contacts, int numContacts) const noexcept;
+    };
+
+    /** Number of targets supported by setCalibrationPoints(const std::vector<CalibrationPoint>&) */
+    static constexpr int minCalibrationPoints = 4;
+    static constexpr int maxCalibrationPoints = 9;
+
     TouchCalibrationManager();
-    ~TouchCalibrationManager() = default;
 
-    /** Load calibration from XML file. Returns false if file doesn't exist (uses defaults) */
+    /** Writes any pending change before returning */
+    ~TouchCalibrationManager() override;
+
+    /** Load calibration from file, preferring the binary cache if it is up to date.
+        Returns false if no calibration has been saved (uses defaults) */
     bool loadFromFile();
 
-    /** Save current calibration bounds to XML file */
+    /** Writes the current calibration to the XML file and binary cache now, on the calling thread */
     bool saveToFile();
 
+    /** Queues a save of the active profile on the background writer and returns immediately.
+        Saves requested within saveCoalesceMs of each other are written once */
+    void saveInBackground();
+
+    /** Blocks until every queued save has been written */
+    void flushPendingSave();
+
+    static constexpr int saveCoalesceMs = 250;
+
     /** Set calibration from two touch points (top-left and bottom-right)
         Automatically validates points and saves to file if valid */
     void setCalibrationPoints(const TouchData& topLeft, const TouchData& bottomRight);
 
-    /** Get current calibration bounds (thread-safe) */
-    CalibrationBounds getBounds() const;
+    /** Solves an affine or projective calibration from 4 to 9 tapped targets by least
+        squares and saves it to file. Returns false if the points are degenerate. */
+    bool setCalibrationPoints(const std::vector<CalibrationPoint>& points,
+                              TransformModel model = TransformModel::projective);
+
+    /** Solves the transform without applying it. Returns false if the points are degenerate */
+    static bool solveTransform(const std::vector<CalibrationPoint>& points, TransformModel model,
+                               std::array<float, 9>& matrix);
+
+    /** Bakes a non-linear correction from taps on a regular grid of targets, captured
+        after the linear calibration. points are row-major, columns x rows (at least 2 x 2).
+        The correction is dropped whenever the linear calibration changes. */
+    bool setCorrectionGrid(const std::vector<CalibrationPoint>& points, int columns, int rows);
+
+    /** Removes the non-linear correction and saves */
+    void clearCorrection();
+
+    /** Returns true if a non-linear correction is active */
+    bool hasCorrection() const noexcept { return getSnapshot().correction != nullptr; }
+
+    /** Sets the jitter filter of the active profile and saves it */
+    void setFilterOptions(const TouchFilter::Options& options);
+
+    /** Returns the jitter filter settings of the active profile (lock-free) */
+    TouchFilter::Options getFilterOptions() const noexcept { return getSnapshot().filter; }
+
+    /** Get current calibration bounds (lock-free) */
+    CalibrationBounds getBounds() const { return snapshot.load().bounds; }
+
+    /** Get the current calibration snapshot (lock-free, safe on realtime threads) */
+    CalibrationSnapshot getSnapshot() const noexcept { return snapshot.load(); }
 
-    /** Reset calibration to factory defaults */
+    /** Reset calibration to factory defaults. The filter settings are kept */
     void resetToDefaults();
 
-    /** Get the calibration file path for diagnostics */
+    /** Get the calibration file path of the active profile, for diagnostics */
     juce::File getCalibrationFile() const;
 
+    //==============================================================================
+    /** Makes a device's profile the active one, which later calibrations change and save.
+        HIDDeviceManager::connectToDevice() calls this automatically. Never waits for the
+        disk: a profile not seen this session is read by the background thread. */
+    void selectProfile(const HIDDeviceInfo& device);
+
+    /** The calibration a device's reports are mapped through, lock-free for the HID thread.
+        It follows the device's profile, including later calibrations of it. Until its file
+        has been read (in the background) or if it has none, the profile holds a copy of the
+        shared calibration. The reference stays valid for the manager's lifetime;
+        HIDDeviceManager resolves it once per device when the device is added. */
+    const SeqLockValue<CalibrationSnapshot>& getDeviceCalibration(const HIDDeviceInfo& device);
+
+    /** Switches back to the shared calibration in touchScreen.xml */
+    void selectDefaultProfile();
+
+    /** Returns the profile key for a device: VID-PID-serial, or VID-PID and a path hash */
+    static juce::String getProfileKey(const HIDDeviceInfo& device);
+
+    /** Returns the key of the active profile, or an empty string for the shared one */
+    juce::String getActiveProfileKey() const;
+
+    /** Converts a raw touch to normalised 0..1 coordinates (lock-free) */
     juce::Point<float> convertTouchToNormalized(const TouchData& touch) const;
 
 private:
     /** Get configuration directory, creating it if needed */
     juce::File getConfigDirectory() const;
 
+    /** Directory holding per-device profiles, creating it if needed */
+    juce::File getProfilesDirectory() const;
+
+    /** Calibration file of a profile; the empty key is the shared touchScreen.xml */
+    juce::File getProfileFile(const juce::String& key) const;
+
+    /** A profile's calibration, as held in memory */
+    struct ProfileState
+    {
+        CalibrationBounds bounds;
+        TransformModel model = TransformModel::bounds;
+        std::array<float, 9> matrix {};
+        const CorrectionTable* correction = nullptr;
+        TouchFilter::Options filter;
+    };
+
+    /** Stores the active calibration in memory and activates another profile */
+    void switchToProfile(const juce::String& key);
+
+    /** Creates a profile not seen this session from the shared calibration, publishes it and
+        queues its file for the background thread. Call with writeLock held */
+    void addProfile(const juce::String& key);
+
+    /** Reads the queued profiles' files and publishes them */
+    void loadQueuedProfiles();
+
+    /** Writes a profile's published calibration to its XML file and binary cache */
+    bool saveProfile(const juce::String& key);
+
+    /** Background loader and writer */
+    void run() override;
+
+    /** The active profile's working state. Call with writeLock held */
+    ProfileState getCurrentState() const;
+    void setCurrentState(const ProfileState& state);
+
+    /** Reads a calibration file, preferring its binary cache if it is up to date. Call with writeLock held */
+    bool readProfile(const juce::File& file, ProfileState& state);
+
+    /** Reads a binary cache into state. Call with writeLock held */
+    bool loadFromCache(const juce::File& cacheFile, ProfileState& state);
+
+    /** Writes the binary cache atomically */
+    bool writeCache(const CalibrationSnapshot& calibration, const juce::File& cacheFile) const;
+
     /** Create default XML structure */
-    std::unique_ptr<juce::XmlElement> createDefaultXml() const;
+    std::unique_ptr<juce::XmlElement> createDefaultXml(const CalibrationSnapshot& calibration) const;
+
+    /** Parse bounds (and the transform, correction and filter, if present) from XML element into state */
+    void parseBoundsFromXml(const juce::XmlElement* xml, ProfileState& state);
+
+    /** The linear part of a calibration: its bounds, or its matrix if a multi-point model is active */
+    static CalibrationSnapshot createLinearSnapshot(const ProfileState& state);
+    CalibrationSnapshot createLinearSnapshot() const { return createLinearSnapshot(getCurrentState()); }
+
+    /** The full calibration of a profile: linear part, correction and filter */
+    static CalibrationSnapshot createSnapshot(const ProfileState& state);
+
+    /** Publishes the active calibration, as the active profile's too. Call with writeLock held */
+    void publishSnapshot();
 
-    /** Parse bounds from XML element */
-    void parseBoundsFromXml(const juce::XmlElement* xml);
+    /** Builds a correction table from a coarse error grid, baked against the given linear calibration */
+    const CorrectionTable* createCorrection(int columns, int rows, juce::Rectangle<float> gridArea,
+                                            std::vector<juce::Point<float>> errors,
+                                            const CalibrationSnapshot& linear);
 
-    mutable juce::CriticalSection lock;
+    // Serialises writers only; readers go through the snapshot
+    juce::CriticalSection writeLock;
     CalibrationBounds currentBounds;
+    TransformModel currentModel = TransformModel::bounds;
+    std::array<float, 9> currentMatrix {};
+    const CorrectionTable* currentCorrection = nullptr;
+    TouchFilter::Options currentFilter;
+    SeqLockValue<CalibrationSnapshot> snapshot;
+
+    // Published tables live until destruction, so a snapshot held by a reader never dangles.
+    // Recalibration is rare, so this stays small
+    std::vector<std::unique_ptr<CorrectionTable>> correctionTables;
+
+    // Profiles seen this session other than the active one, so reconnects never touch the disk
+    juce::String activeProfileKey;
+    std::unordered_map<juce::String, ProfileState> loadedProfiles;
+
+    // Every profile's calibration as devices read it. Entries are never erased, and map nodes
+    // don't move, so references from getDeviceCalibration() stay valid
+    std::unordered_map<juce::String, SeqLockValue<CalibrationSnapshot>> publishedProfiles;
+
+    juce::StringArray profilesToLoad, profilesToSave;  // For the background thread, guarded by writeLock
+    juce::CriticalSection saveLock;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TouchCalibrationManager)
 };
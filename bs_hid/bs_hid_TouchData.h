@@ -11,6 +11,15 @@
 namespace bs_hid
 {
 
+/** Where a contact is in its lifecycle (set by HIDDeviceManager, see TouchOnsetDetector) */
+enum class TouchPhase : uint8_t
+{
+    landing,    // Just went down; its onset velocity is still being measured
+    began,      // Onset velocity is final. Exactly one report per contact
+    moved       // Held after began
+};
+
+//==============================================================================
 /** Structure to hold touch state data */
 struct TouchData
 {
@@ -18,7 +27,18 @@ struct TouchData
     uint16_t y = 0;
     bool isActive = false;
     uint8_t contactId = 0;  // Touch index/finger ID
-    juce::int64 timestamp = 0;
+    uint8_t deviceIndex = 0;  // Device that reported the contact (see HIDDeviceManager::addDevice)
+    juce::int64 timestamp = 0;  // When the panel scanned the contact (or the report was read, if the device
+                                // has no scan time): Time::getMillisecondCounterHiRes() in microseconds
+    float normX = 0.0f;     // Calibrated position, 0..1 across the screen
+    float normY = 0.0f;     // (filled in by HIDDeviceManager before publishing)
+    float velocityX = 0.0f; // Estimated velocity in normalised units per millisecond
+    float velocityY = 0.0f; // (filled in when prediction is enabled, see TouchPredictor)
+    uint16_t width = 0;     // Contact size in raw units, 0 if the device doesn't report it
+    uint16_t height = 0;
+    TouchPhase phase = TouchPhase::moved;
+    float onsetVelocity = 0.0f;     // Strike intensity 0..1, valid from TouchPhase::began on
+    int16_t zone = -1;              // Zone under the contact (see ZoneMap), or -1
 
     TouchData() = default;
 
@@ -35,4 +55,30 @@ struct TouchData
     }
 };
 
+//==============================================================================
+/** All contacts decoded from a single HID report.
+
+    Fixed size and trivially copyable, so frames can be copied through
+    lock-free snapshots and FIFOs without allocating.
+*/
+struct TouchFrame
+{
+    static constexpr int maxContacts = 20;     // Contacts from every connected device
+
+    std::array<TouchData, maxContacts> contacts {};
+    int numContacts = 0;
+    juce::int64 timestamp = 0;   // TouchData::timestamp of the newest report in the frame
+    uint32_t sequence = 0;       // Increments for every published frame
+    double receiveTimeMs = 0.0;  // Time::getMillisecondCounterHiRes() of the newest report in the frame
+    double scanTimeMs = 0.0;     // When the panel scanned that report, same clock (see ScanTimeClock);
+                                 // receiveTimeMs if the device reports no scan time
+    float predictionHorizonMs = 0.0f;   // How far ahead normX/normY are extrapolated (0 = as measured)
+
+    /** True if at least one contact is down */
+    bool hasActiveContacts() const noexcept { return numContacts > 0; }
+
+    /** Returns the first contact, or an inactive TouchData if there is none */
+    TouchData getPrimaryTouch() const noexcept { return numContacts > 0 ? contacts[0] : TouchData(); }
+};
+
 } // namespace bs_hid
@@ -0,0 +1,159 @@
+/*
+  ==============================================================================
+
+   Touch Filter Implementation
+
+  ==============================================================================
+*/
+
+// This file should only be included via bs_hid.cpp
+// But if compiled standalone, include the necessary headers
+#ifndef BS_HID_H_INCLUDED
+    #include "bs_hid.h"
+#endif
+
+namespace bs_hid
+{
+
+//==============================================================================
+void TouchFilter::process(TouchData* contacts, int numContacts, double reportTimeMs, const Options& options) noexcept
+{
+    if (!options.enabled)
+    {
+        // Re-enabling starts from the next measurement rather than stale state
+        lanes.clear();
+        return;
+    }
+
+    const float dt = (float) ((reportTimeMs - lastReportTimeMs) * 0.001);
+    lastReportTimeMs = reportTimeMs;
+
+    int laneOfContact[TouchFrame::maxContacts];
+
+    std::fill(std::begin(updateMask), std::end(updateMask), 0.0f);
+    lanes.beginReport();
+
+    for (int i = 0; i < numContacts; ++i)
+    {
+        auto& contact = contacts[i];
+        bool isNew = false;
+        const int lane = lanes.findIndex(contact.contactId, isNew);
+        laneOfContact[i] = lane;
+
+        if (lane < 0)
+            continue;
+
+        inputX[lane] = contact.normX;
+        inputY[lane] = contact.normY;
+
+        // A new contact starts at its first measurement
+        if (isNew)
+        {
+            filteredX[lane] = contact.normX;
+            filteredY[lane] = contact.normY;
+            speedX[lane] = speedY[lane] = 0.0f;
+        }
+        else
+        {
+            updateMask[lane] = 1.0f;
+        }
+    }
+
+    lanes.endReport();
+
+    // A duplicate report carries no new timing information: republish the current state
+    if (dt > 1.0e-4f)
+    {
+        // Smoothing factor of a first-order low-pass at cutoff fc: a = 2 pi fc dt / (2 pi fc dt + 1)
+        const float twoPiDt = juce::MathConstants<float>::twoPi * dt;
+        const float derivativeGain = twoPiDt * options.derivativeCutoffHz;
+        const float derivativeAlpha = derivativeGain / (derivativeGain + 1.0f);
+        const float inverseDt = 1.0f / dt;
+
+        const float minCutoff = options.minCutoffHz;
+        const float beta = options.beta;
+
+        // Every lane runs the same arithmetic; lanes without an update are masked back to their old state
+       #if BS_HID_USE_SSE
+        const __m128 vTwoPiDt = _mm_set1_ps(twoPiDt), vMinCutoff = _mm_set1_ps(minCutoff), vBeta = _mm_set1_ps(beta);
+        const __m128 vDerivativeAlpha = _mm_set1_ps(derivativeAlpha), vInverseDt = _mm_set1_ps(inverseDt);
+        const __m128 one = _mm_set1_ps(1.0f), signBit = _mm_set1_ps(-0.0f);
+
+        // Four lanes of one axis
+        auto filterLanes = [&](const float* inputs, float* filtered, float* speeds, __m128 mask)
+        {
+            const __m128 input = _mm_load_ps(inputs);
+            const __m128 previous = _mm_load_ps(filtered);
+            const __m128 speed = _mm_load_ps(speeds);
+
+            const __m128 delta = _mm_sub_ps(input, previous);
+            const __m128 newSpeed = _mm_add_ps(speed, _mm_mul_ps(vDerivativeAlpha, _mm_sub_ps(_mm_mul_ps(delta, vInverseDt), speed)));
+            const __m128 gain = _mm_mul_ps(vTwoPiDt, _mm_add_ps(vMinCutoff, _mm_mul_ps(vBeta, _mm_andnot_ps(signBit, newSpeed))));
+            const __m128 alpha = _mm_div_ps(gain, _mm_add_ps(gain, one));
+
+            _mm_store_ps(filtered, _mm_add_ps(previous, _mm_mul_ps(mask, _mm_mul_ps(alpha, delta))));
+            _mm_store_ps(speeds, _mm_add_ps(speed, _mm_mul_ps(mask, _mm_sub_ps(newSpeed, speed))));
+        };
+
+        for (int i = 0; i < numLanes; i += 4)
+        {
+            const __m128 mask = _mm_load_ps(updateMask + i);
+            filterLanes(inputX + i, filteredX + i, speedX + i, mask);
+            filterLanes(inputY + i, filteredY + i, speedY + i, mask);
+        }
+       #elif BS_HID_USE_NEON
+        auto filterLanes = [&](const float* inputs, float* filtered, float* speeds, float32x4_t mask)
+        {
+            const float32x4_t input = vld1q_f32(inputs);
+            const float32x4_t previous = vld1q_f32(filtered);
+            const float32x4_t speed = vld1q_f32(speeds);
+
+            const float32x4_t delta = vsubq_f32(input, previous);
+            const float32x4_t newSpeed = vmlaq_n_f32(speed, vsubq_f32(vmulq_n_f32(delta, inverseDt), speed), derivativeAlpha);
+            const float32x4_t gain = vmulq_n_f32(vmlaq_n_f32(vdupq_n_f32(minCutoff), vabsq_f32(newSpeed), beta), twoPiDt);
+            const float32x4_t alpha = vdivq_f32(gain, vaddq_f32(gain, vdupq_n_f32(1.0f)));
+
+            vst1q_f32(filtered, vmlaq_f32(previous, mask, vmulq_f32(alpha, delta)));
+            vst1q_f32(speeds, vmlaq_f32(speed, mask, vsubq_f32(newSpeed, speed)));
+        };
+
+        for (int i = 0; i < numLanes; i += 4)
+        {
+            const float32x4_t mask = vld1q_f32(updateMask + i);
+            filterLanes(inputX + i, filteredX + i, speedX + i, mask);
+            filterLanes(inputY + i, filteredY + i, speedY + i, mask);
+        }
+       #else
+        for (int i = 0; i < numLanes; ++i)
+        {
+            const float mask = updateMask[i];
+
+            const float deltaX = inputX[i] - filteredX[i];
+            const float deltaY = inputY[i] - filteredY[i];
+            const float newSpeedX = speedX[i] + derivativeAlpha * (deltaX * inverseDt - speedX[i]);
+            const float newSpeedY = speedY[i] + derivativeAlpha * (deltaY * inverseDt - speedY[i]);
+
+            const float gainX = twoPiDt * (minCutoff + beta * std::abs(newSpeedX));
+            const float gainY = twoPiDt * (minCutoff + beta * std::abs(newSpeedY));
+
+            filteredX[i] += mask * gainX / (gainX + 1.0f) * deltaX;
+            filteredY[i] += mask * gainY / (gainY + 1.0f) * deltaY;
+            speedX[i] += mask * (newSpeedX - speedX[i]);
+            speedY[i] += mask * (newSpeedY - speedY[i]);
+        }
+       #endif
+    }
+
+    for (int i = 0; i < numContacts; ++i)
+    {
+        const int lane = laneOfContact[i];
+
+        if (lane >= 0)
+        {
+            contacts[i].normX = filteredX[lane];
+            contacts[i].normY = filteredY[lane];
+        }
+    }
+}
+
+} // namespace bs_hid
@@ -0,0 +1,74 @@
+/*
+  ==============================================================================
+
+   Touch Filter - Adaptive jitter filter for calibrated contacts
+
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace bs_hid
+{
+
+/**
+    Removes jitter from each contact of one device with a One-Euro filter.
+
+    A resting finger wanders by a few raw units from report to report, which
+    makes anything mapped to its position zipper. A fixed low-pass would hide
+    that only by lagging behind every movement. The One-Euro filter adapts
+    instead: its cutoff rises with the contact's speed, so a still finger is
+    smoothed heavily while a moving one is followed with little lag.
+
+    Each contact gets a lane in fixed structure-of-arrays state, keyed by its
+    contact ID, and one pass of branch-free arithmetic updates every lane at
+    once, so the compiler vectorises it across contacts. The filter works on
+    the calibrated normX/normY; the raw x/y stay as measured.
+
+    The settings belong to the device's calibration profile, see
+    TouchCalibrationManager::setFilterOptions(). process() runs on the HID
+    thread and never allocates or locks.
+*/
+class TouchFilter
+{
+public:
+    //==============================================================================
+    struct Options
+    {
+        bool enabled = false;
+        float minCutoffHz = 1.0f;           // Cutoff at rest: lower is steadier but lags more when a finger starts moving
+        float beta = 50.0f;                 // Cutoff increase per unit of speed (normalised units per second)
+        float derivativeCutoffHz = 1.0f;    // Smoothing of the speed estimate that drives the cutoff
+    };
+
+    //==============================================================================
+    TouchFilter() = default;
+
+    /** Filters normX/normY of one report's calibrated contacts in place */
+    void process(TouchData* contacts, int numContacts, double reportTimeMs, const Options& options) noexcept;
+
+    /** Forgets every contact */
+    void reset() noexcept { lanes.clear(); }
+
+private:
+    //==============================================================================
+    static constexpr int numLanes = ContactStateMap<>::capacity;
+
+    static_assert(numLanes % 4 == 0, "Lanes are processed in whole SIMD groups");
+
+    ContactStateMap<> lanes;
+    double lastReportTimeMs = 0.0;
+
+    // One lane per contact, indexed by ContactStateMap::findIndex()
+    alignas(16) float inputX[numLanes] {};
+    alignas(16) float inputY[numLanes] {};
+    alignas(16) float filteredX[numLanes] {};
+    alignas(16) float filteredY[numLanes] {};
+    alignas(16) float speedX[numLanes] {};      // Normalised units per second
+    alignas(16) float speedY[numLanes] {};
+    alignas(16) float updateMask[numLanes] {};  // 1 for lanes that continue a contact this report, else 0
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TouchFilter)
+};
+
+} // namespace bs_hid
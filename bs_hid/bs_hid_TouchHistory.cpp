@@ -0,0 +1,207 @@
+/*
+  ==============================================================================
+
+   Touch History Implementation
+
+  ==============================================================================
+*/
+
+// This file should only be included via bs_hid.cpp
+// But if compiled standalone, include the necessary headers
+#ifndef BS_HID_H_INCLUDED
+    #include "bs_hid.h"
+#endif
+
+namespace bs_hid
+{
+
+//==============================================================================
+void TouchHistory::Slot::add(const Point& point) noexcept
+{
+    const int size = (int) points.size();
+    newest = (newest + 1) % size;
+    points[(size_t) newest] = point;
+    numPoints = juce::jmin(numPoints + 1, size);
+}
+
+const TouchHistory::Point& TouchHistory::Slot::get(int index) const noexcept
+{
+    const int size = (int) points.size();
+    return points[(size_t) ((newest - numPoints + 1 + index + size) % size)];
+}
+
+//==============================================================================
+TouchHistory::TouchHistory()
+{
+    prepare(0.0, 0.0);
+}
+
+void TouchHistory::prepare(double windowMs, double reportRateHz)
+{
+    // A landing records two points, so leave some room beyond one per report
+    const int reportsInWindow = (int) std::ceil(windowMs * reportRateHz * 0.001);
+    historySize = juce::jmax(defaultHistorySize, reportsInWindow + 8);
+
+    for (auto& slot : slots)
+        slot.points.resize((size_t) historySize);
+
+    reset();
+}
+
+void TouchHistory::reset() noexcept
+{
+    // Keeps each slot's storage, so this is safe on the audio thread
+    for (auto& slot : slots)
+    {
+        slot.contactKey = -1;
+        slot.releaseOrder = 0;
+        slot.seen = false;
+        slot.newest = -1;
+        slot.numPoints = 0;
+    }
+
+    releaseCounter = 0;
+}
+
+//==============================================================================
+void TouchHistory::addFrame(const TouchFrame& frame) noexcept
+{
+    const double timeMs = frame.scanTimeMs;
+
+    for (auto& slot : slots)
+        slot.seen = false;
+
+    for (int i = 0; i < frame.numContacts; ++i)
+    {
+        const auto& contact = frame.contacts[(size_t) i];
+        const Point point { timeMs, { contact.normX, contact.normY, contact.onsetVelocity } };
+        int index = findSlot(contact);
+
+        if (index < 0)
+        {
+            index = allocateSlot();
+
+            if (index < 0)
+                continue;
+
+            auto& slot = slots[(size_t) index];
+
+            // The previous contact's last values hold right up to the landing, then step.
+            // A slot never used before starts at the new position, unpressed
+            auto held = point;
+            held.values[(int) Signal::pressure] = 0.0f;
+
+            if (slot.numPoints > 0)
+            {
+                held = slot.get(slot.numPoints - 1);
+                held.timeMs = timeMs;
+            }
+
+            slot.add(held);
+            slot.contactKey = getContactKey(contact);
+        }
+
+        auto& slot = slots[(size_t) index];
+        slot.add(point);
+        slot.seen = true;
+    }
+
+    // Lifted contacts keep their position; pressure ramps to zero by this frame
+    for (auto& slot : slots)
+    {
+        if (slot.contactKey >= 0 && !slot.seen)
+        {
+            auto lifted = slot.get(slot.numPoints - 1);
+            lifted.timeMs = timeMs;
+            lifted.values[(int) Signal::pressure] = 0.0f;
+            slot.add(lifted);
+
+            slot.contactKey = -1;
+            slot.releaseOrder = ++releaseCounter;
+        }
+    }
+}
+
+int TouchHistory::findSlot(const TouchData& contact) const noexcept
+{
+    const int contactKey = getContactKey(contact);
+
+    for (int i = 0; i < maxSlots; ++i)
+        if (slots[(size_t) i].contactKey == contactKey)
+            return i;
+
+    return -1;
+}
+
+int TouchHistory::allocateSlot() noexcept
+{
+    int index = -1;
+
+    // The slot released longest ago, so a recent release finishes its ramp
+    for (int i = 0; i < maxSlots; ++i)
+    {
+        const auto& slot = slots[(size_t) i];
+
+        if (slot.contactKey < 0 && (index < 0 || slot.releaseOrder < slots[(size_t) index].releaseOrder))
+            index = i;
+    }
+
+    return index;
+}
+
+//==============================================================================
+void TouchHistory::render(int slotIndex, Signal signal, double startTimeMs, double sampleRate,
+                          float* destination, int numSamples) const noexcept
+{
+    const auto& slot = slots[(size_t) slotIndex];
+    const int value = (int) signal;
+
+    if (slot.numPoints == 0)
+    {
+        std::fill(destination, destination + numSamples, 0.0f);
+        return;
+    }
+
+    const double sampleMs = 1000.0 / sampleRate;
+    const int last = slot.numPoints - 1;
+
+    // The latest report at or before the first sample; -1 if the first sample is older than all kept
+    int segment = last;
+
+    while (segment >= 0 && slot.get(segment).timeMs > startTimeMs)
+        --segment;
+
+    for (int i = 0; i < numSamples;)
+    {
+        const double timeMs = startTimeMs + i * sampleMs;
+
+        // Reports that share a time step straight to the newest of them
+        while (segment < last && slot.get(segment + 1).timeMs <= timeMs)
+            ++segment;
+
+        if (segment < 0 || segment == last)
+        {
+            // Before the oldest report, hold it; after the newest, hold that until the next arrives
+            const auto& held = slot.get(juce::jmax(0, segment));
+            const int end = segment < 0 ? juce::jmin(numSamples, i + juce::jmax(1, (int) std::ceil((slot.get(0).timeMs - timeMs) / sampleMs)))
+                                        : numSamples;
+            std::fill(destination + i, destination + end, held.values[value]);
+            i = end;
+            continue;
+        }
+
+        // A straight line to the next report, written in one run up to where it arrives
+        const auto& from = slot.get(segment);
+        const auto& to = slot.get(segment + 1);
+        const double slopePerSample = (double) (to.values[value] - from.values[value]) * sampleMs / (to.timeMs - from.timeMs);
+        const double start = from.values[value] + (timeMs - from.timeMs) * slopePerSample / sampleMs;
+        const int end = juce::jmin(numSamples, i + juce::jmax(1, (int) std::ceil((to.timeMs - timeMs) / sampleMs)));
+
+        for (int j = i; j < end; ++j)
+            destination[j] = (float) (start + (j - i) * slopePerSample);
+
+        i = end;
+    }
+}
+
+} // namespace bs_hid
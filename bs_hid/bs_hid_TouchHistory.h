@@ -0,0 +1,120 @@
+/*
+  ==============================================================================
+
+   Touch History - Recent reports per contact, rendered as audio-rate signals
+
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace bs_hid
+{
+
+/**
+    Keeps the recent reports of every contact and renders their position and
+    pressure as control signals at the audio sample rate.
+
+    Reading getLatestTouchData() once per block changes a control in steps at
+    the block rate: zipper noise with large buffers, late with small ones.
+    Instead, feed every frame from the subscriber to addFrame() and call
+    render() for the block: each sample is interpolated between the reports
+    either side of it, by the time they arrived, so the signal follows the
+    finger at report resolution whatever the buffer size.
+
+    A signal can only ramp towards a report that has already arrived. Render
+    a little in the past, by about one report interval, and the output ramps
+    smoothly from report to report; render at the present and it holds each
+    report until the next, changing exactly when the report arrived.
+
+    Contacts keep a slot from landing until another contact needs it, so a
+    slot can feed one output or voice. After a lift, the slot holds its last
+    position and its pressure falls to zero. The panels report no force, so
+    pressure is the contact's strike velocity while it is down.
+
+    Each slot keeps a fixed number of reports, defaultHistorySize until
+    prepare() sizes it for the longest stretch that will be rendered. A sample
+    older than every kept report holds the oldest one, so a history too short
+    for a block at a high report rate flattens the start of the block.
+
+    Everything is allocated up front; addFrame() and render() never allocate
+    or lock. Use one TouchHistory per consuming thread.
+*/
+class TouchHistory
+{
+public:
+    //==============================================================================
+    static constexpr int maxSlots = TouchFrame::maxContacts;
+    static constexpr int defaultHistorySize = 32;   // Reports kept per slot until prepare()
+
+    enum class Signal
+    {
+        x,          // Calibrated normX, 0..1
+        y,          // Calibrated normY, 0..1
+        pressure    // Strike velocity while down, 0 once lifted
+    };
+
+    //==============================================================================
+    TouchHistory();
+
+    /** Keeps enough reports per slot to render windowMs into the past at up to
+        reportRateHz: for audio, the longest block plus how far behind the present
+        it is rendered. Allocates and forgets every report; call from prepareToPlay() */
+    void prepare(double windowMs, double reportRateHz);
+
+    /** Reports kept per slot */
+    int getHistorySize() const noexcept { return historySize; }
+
+    /** Records every contact of a frame at its TouchFrame::scanTimeMs */
+    void addFrame(const TouchFrame& frame) noexcept;
+
+    /** Writes one signal of one slot for numSamples samples, the first at startTimeMs
+        (on the Time::getMillisecondCounterHiRes() clock, like scanTimeMs) */
+    void render(int slot, Signal signal, double startTimeMs, double sampleRate,
+                float* destination, int numSamples) const noexcept;
+
+    /** Returns the slot a contact is recorded in, or -1 */
+    int findSlot(const TouchData& contact) const noexcept;
+
+    /** True while the slot's contact is down */
+    bool isSlotDown(int slot) const noexcept { return slots[(size_t) slot].contactKey >= 0; }
+
+    /** Forgets every contact and report */
+    void reset() noexcept;
+
+private:
+    //==============================================================================
+    struct Point
+    {
+        double timeMs;
+        float values[3];        // Indexed by Signal
+    };
+
+    struct Slot
+    {
+        int contactKey = -1;            // deviceIndex << 8 | contactId, or -1 once lifted
+        uint32_t releaseOrder = 0;
+        bool seen = false;
+        std::vector<Point> points;      // Circular, sized by prepare()
+        int newest = -1, numPoints = 0;
+
+        void add(const Point& point) noexcept;
+        const Point& get(int index) const noexcept;     // 0 is the oldest kept
+    };
+
+    static int getContactKey(const TouchData& contact) noexcept
+    {
+        return (int) contact.deviceIndex << 8 | (int) contact.contactId;
+    }
+
+    int allocateSlot() noexcept;
+
+    //==============================================================================
+    std::array<Slot, maxSlots> slots;
+    uint32_t releaseCounter = 0;
+    int historySize = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TouchHistory)
+};
+
+} // namespace bs_hid
@@ -0,0 +1,145 @@
+/*
+  ==============================================================================
+
+   Touch Onset Detector Implementation
+
+  ==============================================================================
+*/
+
+// This file should only be included via bs_hid.cpp
+// But if compiled standalone, include the necessary headers
+#ifndef BS_HID_H_INCLUDED
+    #include "bs_hid.h"
+#endif
+
+namespace bs_hid
+{
+
+//==============================================================================
+void TouchOnsetDetector::setOptions(const Options& newOptions)
+{
+    options = newOptions;
+    options.onsetReports = juce::jlimit(1, maxOnsetReports, options.onsetReports);
+    options.minVelocity = juce::jlimit(0.0f, 1.0f, options.minVelocity);
+    options.defaultVelocity = juce::jlimit(options.minVelocity, 1.0f, options.defaultVelocity);
+    onsets.clear();
+    numHeld = 0;
+}
+
+int TouchOnsetDetector::process(TouchData* contacts, int numContacts, double reportTimeMs) noexcept
+{
+    onsets.beginReport();
+    numHeld = 0;
+
+    for (int i = 0; i < numContacts; ++i)
+    {
+        auto& contact = contacts[i];
+        bool isNew = false;
+        auto* onset = onsets.find(contact.contactId, isNew);
+
+        if (onset == nullptr)
+        {
+            contact.phase = TouchPhase::moved;
+            contact.onsetVelocity = options.defaultVelocity;
+            continue;
+        }
+
+        if (isNew)
+        {
+            onset->first = contact;
+            onset->firstTimeMs = reportTimeMs;
+        }
+
+        if (onset->hasBegun)
+        {
+            contact.phase = TouchPhase::moved;
+        }
+        else
+        {
+            onset->last = contact;
+            onset->lastTimeMs = reportTimeMs;
+
+            if (++onset->numReports >= options.onsetReports)
+            {
+                onset->last.onsetVelocity = estimateVelocity(*onset);
+                onset->hasBegun = true;
+                contact.phase = TouchPhase::began;
+            }
+            else
+            {
+                contact.phase = TouchPhase::landing;
+            }
+        }
+
+        contact.onsetVelocity = onset->last.onsetVelocity;
+    }
+
+    // A tap shorter than the window still gets its Began, in the report it lifts in, at its last position
+    onsets.endReport([&](uint8_t, Onset& onset)
+    {
+        if (onset.hasBegun || numContacts >= TouchFrame::maxContacts)
+            return;
+
+        auto& held = contacts[numContacts++];
+        held = onset.last;
+        held.phase = TouchPhase::began;
+        held.onsetVelocity = estimateVelocity(onset);
+        ++numHeld;
+    });
+
+    return numContacts;
+}
+
+int TouchOnsetDetector::releaseHeld(TouchData* contacts, int numContacts) noexcept
+{
+    numContacts = juce::jmax(0, numContacts - numHeld);
+    numHeld = 0;
+
+    for (int i = 0; i < numContacts; ++i)
+        if (contacts[i].phase == TouchPhase::began)
+            contacts[i].phase = TouchPhase::moved;
+
+    return numContacts;
+}
+
+float TouchOnsetDetector::estimateVelocity(const Onset& onset) const noexcept
+{
+    float intensity = 0.0f;
+    int numCues = 0;
+
+    // Centroid slide across the window
+    const float elapsedMs = (float) (onset.lastTimeMs - onset.firstTimeMs);
+
+    if (onset.numReports > 1 && elapsedMs > 0.0f)
+    {
+        const float distance = std::hypot(onset.last.normX - onset.first.normX, onset.last.normY - onset.first.normY);
+        intensity += juce::jmin(1.0f, distance / (elapsedMs * options.fullScaleSpeed));
+        ++numCues;
+    }
+
+    // Contact size, when the descriptor reports it: a harder hit flattens more of the fingertip, faster
+    const float lastArea = (float) onset.last.width * (float) onset.last.height;
+
+    if (lastArea > 0.0f)
+    {
+        float areaIntensity = juce::jmin(1.0f, lastArea / options.fullScaleArea);
+        const float firstArea = (float) onset.first.width * (float) onset.first.height;
+
+        if (onset.numReports > 1 && elapsedMs > 0.0f && firstArea > 0.0f)
+        {
+            const float growth = (lastArea - firstArea) / (firstArea * elapsedMs);
+            areaIntensity = 0.5f * (areaIntensity + juce::jlimit(0.0f, 1.0f, growth / options.fullScaleAreaGrowth));
+        }
+
+        intensity += areaIntensity;
+        ++numCues;
+    }
+
+    if (numCues == 0)
+        return options.defaultVelocity;
+
+    const float shaped = std::pow(intensity / (float) numCues, options.curve);
+    return options.minVelocity + (1.0f - options.minVelocity) * shaped;
+}
+
+} // namespace bs_hid
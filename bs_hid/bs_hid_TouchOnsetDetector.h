@@ -0,0 +1,98 @@
+/*
+  ==============================================================================
+
+   Touch Onset Detector - Strike velocity from the first reports of a contact
+
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace bs_hid
+{
+
+/**
+    Estimates how hard each contact struck the panel and marks its Began report.
+
+    A touchscreen reports nothing before the finger lands, so the strike is
+    judged from the first onsetReports reports of a contact: how fast its
+    centroid slides as the fingertip flattens, and, if the device reports
+    contact size, how large the contact is and how fast it grows. Both grow
+    with the force of the hit.
+
+    A new contact is TouchPhase::landing until its window closes, then it is
+    published once as TouchPhase::began with TouchData::onsetVelocity set, and
+    TouchPhase::moved from then on. The delay is bounded: a contact is never
+    later than its onsetReports-th report. A contact that lifts before its
+    window closes gets its Began in the report it lifts in, at its last
+    position, and releaseHeld() takes it away again for a release frame
+    published straight after. So every touch, however short, gets exactly
+    one Began and is released even if the panel then goes quiet.
+
+    process() runs on the HID thread and never allocates or locks.
+*/
+class TouchOnsetDetector
+{
+public:
+    //==============================================================================
+    static constexpr int maxOnsetReports = 4;
+
+    struct Options
+    {
+        int onsetReports = 2;               // Reports measured before Began (1 to maxOnsetReports)
+        float fullScaleSpeed = 0.002f;      // Centroid speed for full velocity (normalised units per ms)
+        float fullScaleArea = 2.0e6f;       // Contact area for full velocity (raw units squared)
+        float fullScaleAreaGrowth = 0.2f;   // Relative area growth per ms for full velocity
+        float curve = 0.6f;                 // Exponent applied to the measured intensity (< 1 favours soft hits)
+        float minVelocity = 0.1f;           // Lightest velocity a contact can get
+        float defaultVelocity = 0.5f;       // Used when nothing could be measured
+    };
+
+    //==============================================================================
+    TouchOnsetDetector() = default;
+
+    /** Changes the options. Call only while process() can't be running */
+    void setOptions(const Options& newOptions);
+
+    const Options& getOptions() const noexcept { return options; }
+
+    /** Sets the phase and onset velocity of one report's calibrated contacts. Contacts that
+        lifted before their Began are appended with it, so the array must have room for
+        TouchFrame::maxContacts.
+        @returns the new number of contacts
+    */
+    int process(TouchData* contacts, int numContacts, double reportTimeMs) noexcept;
+
+    /** True if the last process() appended lifted contacts, which need a release frame */
+    bool hasHeldContacts() const noexcept { return numHeld > 0; }
+
+    /** Turns the contacts of the last process() into its release frame: the appended ones are
+        removed and the Began of the rest becomes TouchPhase::moved, so it isn't repeated.
+        @returns the new number of contacts
+    */
+    int releaseHeld(TouchData* contacts, int numContacts) noexcept;
+
+    /** Forgets every contact */
+    void reset() noexcept { onsets.clear(); numHeld = 0; }
+
+private:
+    //==============================================================================
+    struct Onset
+    {
+        TouchData first, last;          // First and latest report of the contact
+        double firstTimeMs = 0.0, lastTimeMs = 0.0;
+        int numReports = 0;
+        bool hasBegun = false;
+    };
+
+    float estimateVelocity(const Onset& onset) const noexcept;
+
+    //==============================================================================
+    Options options;
+    ContactStateMap<Onset> onsets;
+    int numHeld = 0;                    // Lifted contacts appended by the last process()
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TouchOnsetDetector)
+};
+
+} // namespace bs_hid
@@ -15,7 +15,8 @@
 namespace bs_hid
 {
 
-TouchData TouchParser::parseELOTouch(const unsigned char* data, int length, unsigned char reportId)
+TouchData TouchParser::parseELOTouch(const unsigned char* data, int length, unsigned char reportId,
+                                     juce::int64 timestamp)
 {
     if (reportId != 1 || length < 59)
         return TouchData();
@@ -28,11 +29,11 @@ TouchData TouchParser::parseELOTouch(const unsigned char* data, int length, unsi
     bool isValid = isValidCoordinate(touch_x, touch_y);
 
     // ELO doesn't have explicit contact ID in this position, use 0 for primary touch
-    return TouchData(touch_x, touch_y, isValid, 0, juce::Time::currentTimeMillis());
+    return TouchData(touch_x, touch_y, isValid, 0, timestamp);
 }
 
 TouchData TouchParser::parseStandardTouch(const unsigned char* data, int length,
-                                         unsigned char reportId, int maxTouchPoints)
+                                         unsigned char reportId, int maxTouchPoints, juce::int64 timestamp)
 {
     if (reportId != 1 || length < 44)
         return TouchData();
@@ -65,30 +66,39 @@ TouchData TouchParser::parseStandardTouch(const unsigned char* data, int length,
         // Y coordinate (2 bytes, little endian)
         uint16_t y = data[offset + 3] | (data[offset + 4] << 8);
 
-        return TouchData(x, y, true, contactId, juce::Time::currentTimeMillis());
+        return TouchData(x, y, true, contactId, timestamp);
 
     }
 
     // No active touches found
-    return TouchData(0, 0, false, 0, juce::Time::currentTimeMillis());
+    return TouchData(0, 0, false, 0, timestamp);
 }
 
 std::vector<TouchData> TouchParser::parseStandardTouchMulti(const unsigned char* data, int length,
-                                                             unsigned char reportId, int maxTouchPoints)
+                                                             unsigned char reportId, int maxTouchPoints,
+                                                             juce::int64 timestamp)
 {
-    std::vector<TouchData> touches;
+    std::vector<TouchData> touches((size_t) juce::jmax(0, maxTouchPoints));
+    touches.resize((size_t) parseStandardTouchMulti(data, length, reportId, maxTouchPoints, timestamp,
+                                                    touches.data(), (int) touches.size()));
+    return touches;
+}
 
-    if (reportId != 1 || length < 44)
-        return touches;
+int TouchParser::parseStandardTouchMulti(const unsigned char* data, int length,
+                                         unsigned char reportId, int maxTouchPoints,
+                                         juce::int64 timestamp, TouchData* touches, int maxTouches)
+{
+    int numTouches = 0;
 
-    juce::int64 timestamp = juce::Time::currentTimeMillis();
+    if (reportId != 1 || length < 44)
+        return numTouches;
 
     // Extract contact count for debugging
     unsigned char contactCount = data[length - 1];
 //    printf("parseStandardTouchMulti - Contact Count: %d, length: %d, maxTouchPoints: %d\n", contactCount, length, maxTouchPoints);
 
     // Parse each touch point (limited by maxTouchPoints for better latency)
-    for (int i = 0; i < maxTouchPoints && (1 + i * 5 + 4) < length - 1; ++i)
+    for (int i = 0; i < maxTouchPoints && numTouches < maxTouches && (1 + i * 5 + 4) < length - 1; ++i)
     {
         int offset = 1 + i * 5; // Start after report ID (5 bytes per touch)
 
@@ -112,11 +122,20 @@ std::vector<TouchData> TouchParser::parseStandardTouchMulti(const unsigned char*
 
         // Add touch
 //        printf("  Found valid touch %d: ID=%d, x=%d, y=%d\n", i, contactId, x, y);
-        touches.push_back(TouchData(x, y, true, contactId, timestamp));
+        touches[numTouches++] = TouchData(x, y, true, contactId, timestamp);
     }
 
-//    printf("  Total touches collected: %d\n", (int)touches.size());
-    return touches;
+//    printf("  Total touches collected: %d\n", numTouches);
+    return numTouches;
+}
+
+int TouchParser::parseStandardScanTime(const unsigned char* data, int length, unsigned char reportId)
+{
+    if (reportId != 1 || length < 44)
+        return -1;
+
+    // The report ends with Scan Time (16 bits, little endian) then the contact count
+    return data[length - 3] | (data[length - 2] << 8);
 }
 
 bool TouchParser::isValidCoordinate(uint16_t x, uint16_t y)
@@ -14,20 +14,36 @@ namespace bs_hid
 /**
     Static utility class for parsing touch data from HID reports.
     Contains device-specific parsing logic for different touchscreen models.
+
+    Every contact is stamped with the timestamp passed in, which the caller
+    takes once when the report is read (see TouchData::timestamp), so parsing
+    time never shows up as latency and every contact of a report agrees.
 */
 class TouchParser
 {
 public:
     /** Parse ELO Touch (Atmel maXTouch) data */
-    static TouchData parseELOTouch(const unsigned char* data, int length, unsigned char reportId);
+    static TouchData parseELOTouch(const unsigned char* data, int length, unsigned char reportId,
+                                   juce::int64 timestamp);
 
     /** Parse standard HID multi-touch digitizer data (returns first touch only) */
     static TouchData parseStandardTouch(const unsigned char* data, int length,
-                                       unsigned char reportId, int maxTouchPoints);
+                                       unsigned char reportId, int maxTouchPoints, juce::int64 timestamp);
+
+    /** Parse all touches from standard HID multi-touch digitizer data into touches,
+        writing at most maxTouches. Returns the number written. Never allocates */
+    static int parseStandardTouchMulti(const unsigned char* data, int length,
+                                       unsigned char reportId, int maxTouchPoints,
+                                       juce::int64 timestamp, TouchData* touches, int maxTouches);
 
     /** Parse all touches from standard HID multi-touch digitizer data */
     static std::vector<TouchData> parseStandardTouchMulti(const unsigned char* data, int length,
-                                                          unsigned char reportId, int maxTouchPoints);
+                                                          unsigned char reportId, int maxTouchPoints,
+                                                          juce::int64 timestamp);
+
+    /** Returns the Scan Time of a standard HID multi-touch digitizer report (100 microsecond
+        units, see ScanTimeClock), or -1 if the report has none */
+    static int parseStandardScanTime(const unsigned char* data, int length, unsigned char reportId);
 
     /** Validate coordinate ranges */
     static bool isValidCoordinate(uint16_t x, uint16_t y);
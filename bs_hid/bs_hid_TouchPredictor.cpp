@@ -0,0 +1,179 @@
+/*
+  ==============================================================================
+
+   Touch Predictor Implementation
+
+  ==============================================================================
+*/
+
+// This file should only be included via bs_hid.cpp
+// But if compiled standalone, include the necessary headers
+#ifndef BS_HID_H_INCLUDED
+    #include "bs_hid.h"
+#endif
+
+namespace bs_hid
+{
+
+//==============================================================================
+void TouchPredictor::setOptions(const Options& newOptions)
+{
+    options = newOptions;
+    options.maxHorizonMs = juce::jmax(0.0, options.maxHorizonMs);
+    options.horizonMs = juce::jlimit(0.0, options.maxHorizonMs, options.horizonMs);
+    tracks.clear();
+}
+
+void TouchPredictor::process(TouchData* contacts, int numContacts, double reportTimeMs) noexcept
+{
+    if (!options.enabled)
+        return;
+
+    if (errorResetRequested.exchange(false, std::memory_order_acq_rel))
+    {
+        numErrorSamples = 0;
+        errorSum = errorSquaredSum = errorMax = 0.0;
+        errorStats.store({});
+    }
+
+    const bool useAcceleration = options.model == Model::constantAcceleration;
+    const float horizon = (float) options.horizonMs;
+
+    tracks.beginReport();
+
+    for (int i = 0; i < numContacts; ++i)
+    {
+        auto& contact = contacts[i];
+        bool isNew = false;
+        auto* track = tracks.find(contact.contactId, isNew);
+
+        if (track == nullptr)
+            continue;
+
+        const float measuredX = contact.normX;
+        const float measuredY = contact.normY;
+        const double elapsedMs = reportTimeMs - track->lastTimeMs;
+
+        if (isNew)
+        {
+            track->x = measuredX;
+            track->y = measuredY;
+            track->lastTimeMs = reportTimeMs;
+            track->lastMeasuredX = measuredX;
+            track->lastMeasuredY = measuredY;
+        }
+        else if (elapsedMs > 0.1)   // Otherwise a duplicate report: republish the current state
+        {
+            scorePendingPredictions(*track, measuredX, measuredY, reportTimeMs);
+
+            // Predict the state to now, then correct it with the measurement
+            const float dt = (float) elapsedMs;
+            const float predictedX = track->x + (track->vx + 0.5f * track->ax * dt) * dt;
+            const float predictedY = track->y + (track->vy + 0.5f * track->ay * dt) * dt;
+            const float residualX = measuredX - predictedX;
+            const float residualY = measuredY - predictedY;
+
+            // Without a horizon nothing is pending, so score the one-step prediction instead
+            if (horizon <= 0.0f)
+                addError(std::hypot(residualX, residualY));
+
+            track->x = predictedX + options.alpha * residualX;
+            track->y = predictedY + options.alpha * residualY;
+            track->vx += track->ax * dt + options.beta * residualX / dt;
+            track->vy += track->ay * dt + options.beta * residualY / dt;
+
+            if (useAcceleration)
+            {
+                track->ax += 2.0f * options.gamma * residualX / (dt * dt);
+                track->ay += 2.0f * options.gamma * residualY / (dt * dt);
+            }
+
+            track->lastTimeMs = reportTimeMs;
+            track->lastMeasuredX = measuredX;
+            track->lastMeasuredY = measuredY;
+        }
+
+        contact.velocityX = track->vx;
+        contact.velocityY = track->vy;
+
+        if (horizon > 0.0f)
+        {
+            contact.normX = track->x + (track->vx + 0.5f * track->ax * horizon) * horizon;
+            contact.normY = track->y + (track->vy + 0.5f * track->ay * horizon) * horizon;
+
+            // Remember the prediction so it can be checked once that time has been measured
+            if (track->numPending == maxPendingPredictions)
+            {
+                std::move(track->pending.begin() + 1, track->pending.end(), track->pending.begin());
+                --track->numPending;
+            }
+
+            track->pending[(size_t) track->numPending++] = { reportTimeMs + horizon, contact.normX, contact.normY };
+        }
+    }
+
+    tracks.endReport();
+
+    if (numErrorSamples > 0)
+        errorStats.store({ numErrorSamples,
+                           errorSum / numErrorSamples,
+                           std::sqrt(errorSquaredSum / numErrorSamples),
+                           errorMax });
+}
+
+void TouchPredictor::scorePendingPredictions(Track& track, float measuredX, float measuredY, double timeMs) noexcept
+{
+    int numScored = 0;
+
+    for (; numScored < track.numPending; ++numScored)
+    {
+        const auto& prediction = track.pending[(size_t) numScored];
+
+        if (prediction.targetTimeMs > timeMs)
+            break;
+
+        // Where the finger was at the predicted time, interpolated between the two measurements around it
+        const double span = timeMs - track.lastTimeMs;
+        const float t = span > 0.0 ? (float) juce::jlimit(0.0, 1.0, (prediction.targetTimeMs - track.lastTimeMs) / span) : 1.0f;
+        const float actualX = track.lastMeasuredX + (measuredX - track.lastMeasuredX) * t;
+        const float actualY = track.lastMeasuredY + (measuredY - track.lastMeasuredY) * t;
+
+        addError(std::hypot(prediction.x - actualX, prediction.y - actualY));
+    }
+
+    if (numScored > 0)
+    {
+        std::move(track.pending.begin() + numScored, track.pending.begin() + track.numPending, track.pending.begin());
+        track.numPending -= numScored;
+    }
+}
+
+void TouchPredictor::addError(double error) noexcept
+{
+    ++numErrorSamples;
+    errorSum += error;
+    errorSquaredSum += error * error;
+    errorMax = juce::jmax(errorMax, error);
+}
+
+//==============================================================================
+TouchFrame TouchPredictor::extrapolate(const TouchFrame& frame, double targetTimeMs, double maxHorizonMs) noexcept
+{
+    TouchFrame result = frame;
+
+    // normX/normY are already predictionHorizonMs ahead of the measurement
+    const double totalMs = juce::jlimit(0.0, juce::jmax(0.0, maxHorizonMs), targetTimeMs - frame.scanTimeMs);
+    const float dt = (float) (totalMs - frame.predictionHorizonMs);
+
+    for (int i = 0; i < result.numContacts; ++i)
+    {
+        auto& contact = result.contacts[(size_t) i];
+        contact.normX += contact.velocityX * dt;
+        contact.normY += contact.velocityY * dt;
+    }
+
+    result.predictionHorizonMs = (float) totalMs;
+    return result;
+}
+
+} // namespace bs_hid
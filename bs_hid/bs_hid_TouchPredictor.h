@@ -0,0 +1,129 @@
+/*
+  ==============================================================================
+
+   Touch Predictor - Extrapolates contacts ahead to hide digitizer latency
+
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace bs_hid
+{
+
+/**
+    Tracks each contact of one device and extrapolates it ahead in time.
+
+    The digitizer's scan delay means a reported position always trails the
+    finger. Each contact is followed by an alpha-beta(-gamma) tracker, the
+    steady-state form of a constant-velocity or constant-acceleration Kalman
+    filter. It writes the estimated velocity into TouchData::velocityX/Y and,
+    if a horizon is set, moves normX/normY that far ahead. The raw x/y stay as
+    measured.
+
+    Consumers that need a specific time, such as the start of the next audio
+    block or display frame, call extrapolate() on a published frame.
+
+    Every prediction made at the horizon is later compared with the measured
+    position at that time, and the error is reported by getErrorStats() so the
+    gains and horizon can be tuned.
+
+    process() runs on the HID thread and never allocates or locks.
+*/
+class TouchPredictor
+{
+public:
+    //==============================================================================
+    enum class Model
+    {
+        constantVelocity,
+        constantAcceleration
+    };
+
+    struct Options
+    {
+        bool enabled = false;
+        Model model = Model::constantAcceleration;
+        double horizonMs = 0.0;         // Published positions are extrapolated this far ahead
+        double maxHorizonMs = 30.0;     // Extrapolation is never longer than this
+        float alpha = 0.6f;             // Position gain
+        float beta = 0.3f;              // Velocity gain
+        float gamma = 0.05f;            // Acceleration gain (constantAcceleration only)
+    };
+
+    /** Prediction error in normalised units (1.0 = screen width or height) */
+    struct ErrorStats
+    {
+        int numSamples = 0;
+        double meanError = 0.0;
+        double rmsError = 0.0;
+        double maxError = 0.0;
+    };
+
+    //==============================================================================
+    TouchPredictor() = default;
+
+    /** Changes the options. Call only while process() can't be running */
+    void setOptions(const Options& newOptions);
+
+    const Options& getOptions() const noexcept { return options; }
+
+    /** Updates the trackers with one report's calibrated contacts and writes the
+        velocity (and the prediction, if a horizon is set) back into them */
+    void process(TouchData* contacts, int numContacts, double reportTimeMs) noexcept;
+
+    /** Forgets every tracked contact */
+    void reset() noexcept { tracks.clear(); }
+
+    //==============================================================================
+    /** Returns the error of predictions checked against later measurements (any thread) */
+    ErrorStats getErrorStats() const noexcept { return errorStats.load(); }
+
+    /** Starts a new error measurement (any thread; takes effect on the next report) */
+    void resetErrorStats() noexcept { errorResetRequested.store(true, std::memory_order_release); }
+
+    //==============================================================================
+    /** Moves every contact of a published frame to targetTimeMs (Time::getMillisecondCounterHiRes()
+        clock), using the velocity estimated on the HID thread. The total extrapolation is
+        clamped to 0..maxHorizonMs past the frame's measurement. */
+    static TouchFrame extrapolate(const TouchFrame& frame, double targetTimeMs, double maxHorizonMs = 30.0) noexcept;
+
+private:
+    //==============================================================================
+    static constexpr int maxPendingPredictions = 8;
+
+    struct PendingPrediction
+    {
+        double targetTimeMs;
+        float x, y;
+    };
+
+    struct Track
+    {
+        float x = 0.0f, y = 0.0f;               // Filtered position
+        float vx = 0.0f, vy = 0.0f;             // Per millisecond
+        float ax = 0.0f, ay = 0.0f;             // Per millisecond squared
+        double lastTimeMs = 0.0;
+        float lastMeasuredX = 0.0f, lastMeasuredY = 0.0f;
+
+        std::array<PendingPrediction, maxPendingPredictions> pending {};
+        int numPending = 0;
+    };
+
+    void scorePendingPredictions(Track& track, float measuredX, float measuredY, double timeMs) noexcept;
+    void addError(double error) noexcept;
+
+    //==============================================================================
+    Options options;
+    ContactStateMap<Track> tracks;
+
+    // Accumulated on the HID thread, published through errorStats
+    int numErrorSamples = 0;
+    double errorSum = 0.0, errorSquaredSum = 0.0, errorMax = 0.0;
+    SeqLockValue<ErrorStats> errorStats;
+    std::atomic<bool> errorResetRequested{false};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TouchPredictor)
+};
+
+} // namespace bs_hid
@@ -19,20 +19,94 @@ class TouchVisualizerComponent : public juce::Component,
                                  public juce::Timer
 {
 public:
+    /** Polls the manager's latest frame at 60 Hz; reading it never blocks the HID thread */
     TouchVisualizerComponent(HIDDeviceManager& hidManager, TouchCalibrationManager& calibManager)
         : hidDeviceManager(hidManager), calibrationManager(calibManager)
     {
         startTimerHz(60); // 60 FPS refresh
     }
 
-    void startCalibration()
+    /** Receives coalesced frames from the hub at display rate, so painting never
+        touches the HID thread's state. Only repaints when touches change. */
+    TouchVisualizerComponent(HIDHub& hub, TouchCalibrationManager& calibManager)
+        : hidDeviceManager(hub.getDeviceManager()), calibrationManager(calibManager)
     {
-        calibrationState = WaitingForTopLeft;
+        HIDHub::Subscriber::Options options;
+        options.delivery = HIDHub::Delivery::coalesced;
+        options.rateHz = 60;
+        options.callback = [this](const TouchFrame& frame)
+        {
+            displayedFrame = frame;
+            repaint();
+        };
+
+        frameSubscriber = std::make_unique<HIDHub::Subscriber>(hub, std::move(options));
+        startTimerHz(idleRefreshHz); // Connection status only
+    }
+
+    /** Starts the calibration overlay.
+
+        With 2 points this is the classic top-left/bottom-right bounds calibration.
+        With 4 to 9 points the targets are the corners, then the centre, then the
+        edge midpoints, and a projective transform is solved from them, which also
+        corrects rotation, skew and keystone. Each target waits for the finger to
+        lift before the next one is armed.
+    */
+    void startCalibration(int numPoints = 2)
+    {
+        if (numPoints == 2)
+        {
+            calibrationState = WaitingForTopLeft;
+        }
+        else
+        {
+            static constexpr float layout[TouchCalibrationManager::maxCalibrationPoints][2] =
+            {
+                { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f },     // Corners
+                { 0.5f, 0.5f },                                                     // Centre
+                { 0.5f, 0.0f }, { 1.0f, 0.5f }, { 0.5f, 1.0f }, { 0.0f, 0.5f }      // Edge midpoints
+            };
+
+            targetLayout.clear();
+            numPoints = juce::jlimit(TouchCalibrationManager::minCalibrationPoints,
+                                     TouchCalibrationManager::maxCalibrationPoints, numPoints);
+
+            for (int i = 0; i < numPoints; ++i)
+                targetLayout.push_back({ layout[i][0], layout[i][1] });
+
+            startTargetSequence(0, 0);
+        }
+
+        // The crosshair animates, so refresh at full rate while calibrating
+        if (frameSubscriber != nullptr)
+            startTimerHz(60);
+
         topLeftCalibration = TouchData();
         bottomRightCalibration = TouchData();
         repaint();
     }
 
+    /** Captures a columns x rows grid of targets to correct the panel's non-linearity.
+        Run this after a calibration; the grid is measured against it.
+    */
+    void startCorrectionCapture(int columns = 5, int rows = 5)
+    {
+        columns = juce::jmax(2, columns);
+        rows = juce::jmax(2, rows);
+        targetLayout.clear();
+
+        for (int r = 0; r < rows; ++r)
+            for (int c = 0; c < columns; ++c)
+                targetLayout.push_back({ (float) c / (float) (columns - 1), (float) r / (float) (rows - 1) });
+
+        startTargetSequence(columns, rows);
+
+        if (frameSubscriber != nullptr)
+            startTimerHz(60);
+
+        repaint();
+    }
+
     void paint(juce::Graphics& g) override
     {
         // Draw background
@@ -50,7 +124,7 @@ public:
         g.drawText(isConnected ? "Connected" : "Disconnected", 30, 10, 150, 15, juce::Justification::left);
 
         // Get all current touches
-        auto allTouches = hidDeviceManager.getAllTouches();
+        auto allTouches = getDisplayedTouches();
 
         // Handle calibration mode
         if (calibrationState != NotCalibrating)
@@ -100,9 +174,12 @@ public:
                       10, 55, 400, 20, juce::Justification::left);
             yOffset = 80;
 
+            // One lock-free snapshot for the whole frame
+            auto calibration = calibrationManager.getSnapshot();
+
             for (const auto& touch : allTouches)
             {
-                juce::Point<float> normalizedTouch = calibrationManager.convertTouchToNormalized(touch);
+                juce::Point<float> normalizedTouch = calibration.apply(touch);
 
                 float screenX = normalizedTouch.x * static_cast<float>(getWidth());
                 float screenY = normalizedTouch.y * static_cast<float>(getHeight());
@@ -152,9 +229,20 @@ public:
     void timerCallback() override
     {
         repaint(); // Refresh display at 60 FPS
+
+        // Back to the idle rate once calibration is dismissed
+        if (frameSubscriber != nullptr && calibrationState == NotCalibrating && getTimerInterval() < 1000 / idleRefreshHz)
+            startTimerHz(idleRefreshHz);
     }
 
 private:
+    std::vector<TouchData> getDisplayedTouches() const
+    {
+        const auto frame = frameSubscriber == nullptr ? hidDeviceManager.getLatestFrame() : displayedFrame;
+
+        return std::vector<TouchData>(frame.contacts.begin(), frame.contacts.begin() + frame.numContacts);
+    }
+
     void drawCalibrationOverlay(juce::Graphics& g, const std::vector<TouchData>& touches)
     {
         // Semi-transparent overlay
@@ -180,6 +268,21 @@ private:
             targetPos = {getWidth() - 50.0f, getHeight() - 50.0f};
             instructionText = "Touch the BOTTOM-RIGHT crosshair";
         }
+        else if (calibrationState == WaitingForTarget)
+        {
+            targetPos = getCalibrationTarget(calibrationTargetIndex);
+            instructionText = awaitingRelease ? juce::String("Lift your finger")
+                                              : "Touch crosshair " + juce::String(calibrationTargetIndex + 1)
+                                                    + " of " + juce::String(numCalibrationTargets);
+
+            // Targets already captured
+            g.setColour(juce::Colours::grey);
+            for (int i = 0; i < calibrationTargetIndex; ++i)
+            {
+                auto done = getCalibrationTarget(i);
+                g.fillEllipse(done.x - 5, done.y - 5, 10, 10);
+            }
+        }
         else if (calibrationState == CalibrationComplete)
         {
             // Show success message
@@ -224,8 +327,91 @@ private:
         g.fillEllipse(pos.x - 5, pos.y - 5, 10, 10);
     }
 
+    /** Arms the first target of targetLayout. A grid size of 0 x 0 means a transform calibration */
+    void startTargetSequence(int gridColumns, int gridRows)
+    {
+        calibrationState = WaitingForTarget;
+        numCalibrationTargets = (int) targetLayout.size();
+        correctionColumns = gridColumns;
+        correctionRows = gridRows;
+        calibrationTargetIndex = 0;
+        capturedPoints.clear();
+        awaitingRelease = false;
+    }
+
+    /** Pixel position of a multi-point target, inset 50 px like the corner crosshairs */
+    juce::Point<float> getCalibrationTarget(int index) const
+    {
+        const float inset = 50.0f;
+        const auto& target = targetLayout[(size_t) index];
+
+        return { inset + target.x * (getWidth() - 2.0f * inset),
+                 inset + target.y * (getHeight() - 2.0f * inset) };
+    }
+
+    void processMultiPointTouch(const std::vector<TouchData>& touches)
+    {
+        const bool isTouching = !touches.empty() && touches[0].isActive;
+
+        // Arm the next target only once the previous tap has lifted
+        if (!isTouching)
+        {
+            if (awaitingRelease)
+            {
+                awaitingRelease = false;
+                repaint();
+            }
+            return;
+        }
+
+        if (awaitingRelease)
+            return;
+
+        const auto& touch = touches[0];
+        auto target = getCalibrationTarget(calibrationTargetIndex);
+
+        TouchCalibrationManager::CalibrationPoint point;
+        point.raw = { (float) touch.x, (float) touch.y };
+        point.target = { target.x / (float) getWidth(), target.y / (float) getHeight() };
+        capturedPoints.push_back(point);
+
+        DBG("Target " << calibrationTargetIndex + 1 << " captured: x=" << touch.x << " y=" << touch.y);
+
+        awaitingRelease = true;
+
+        if (++calibrationTargetIndex < numCalibrationTargets)
+        {
+            repaint();
+            return;
+        }
+
+        const bool solved = correctionColumns > 0
+                              ? calibrationManager.setCorrectionGrid(capturedPoints, correctionColumns, correctionRows)
+                              : calibrationManager.setCalibrationPoints(capturedPoints);
+
+        if (solved)
+        {
+            calibrationState = CalibrationComplete;
+            calibrationCompleteTime = juce::Time::getCurrentTime().toMilliseconds();
+        }
+        else
+        {
+            DBG("Invalid calibration points, restarting...");
+            startTargetSequence(correctionColumns, correctionRows);
+            awaitingRelease = true;
+        }
+
+        repaint();
+    }
+
     void processCalibratorTouch(const std::vector<TouchData>& touches)
     {
+        if (calibrationState == WaitingForTarget)
+        {
+            processMultiPointTouch(touches);
+            return;
+        }
+
         // Only process first active touch
         if (touches.empty() || !touches[0].isActive)
             return;
@@ -329,15 +515,28 @@ private:
     HIDDeviceManager& hidDeviceManager;
     TouchCalibrationManager& calibrationManager;
 
+    // Coalesced frame delivery (hub constructor only)
+    static constexpr int idleRefreshHz = 4;
+    TouchFrame displayedFrame;
+    std::unique_ptr<HIDHub::Subscriber> frameSubscriber;
+
     // Track actual coordinate ranges for calibration
     uint16_t minX = 65535, maxX = 0;
     uint16_t minY = 65535, maxY = 0;
 
     // Calibration state
-    enum CalibrationState { NotCalibrating, WaitingForTopLeft, WaitingForBottomRight, CalibrationComplete };
+    enum CalibrationState { NotCalibrating, WaitingForTopLeft, WaitingForBottomRight, WaitingForTarget, CalibrationComplete };
     CalibrationState calibrationState = NotCalibrating;
     TouchData topLeftCalibration;
     TouchData bottomRightCalibration;
+
+    // Multi-point calibration
+    std::vector<juce::Point<float>> targetLayout;      // 0..1 across the inset area
+    int numCalibrationTargets = 0;
+    int correctionColumns = 0, correctionRows = 0;
+    int calibrationTargetIndex = 0;
+    bool awaitingRelease = false;
+    std::vector<TouchCalibrationManager::CalibrationPoint> capturedPoints;
     juce::int64 calibrationCompleteTime = 0;
     float crosshairPulsePhase = 0.0f;
 };
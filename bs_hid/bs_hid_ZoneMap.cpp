@@ -0,0 +1,160 @@
+/*
+  ==============================================================================
+
+   Zone Map Implementation
+
+  ==============================================================================
+*/
+
+// This file should only be included via bs_hid.cpp
+// But if compiled standalone, include the necessary headers
+#ifndef BS_HID_H_INCLUDED
+    #include "bs_hid.h"
+#endif
+
+namespace bs_hid
+{
+
+//==============================================================================
+int ZoneMap::addRectangle(juce::Rectangle<float> area)
+{
+    jassert(zones.size() < (size_t) std::numeric_limits<int16_t>::max());
+
+    zones.push_back({ area, {} });
+    compiled = false;
+    return (int) zones.size() - 1;
+}
+
+int ZoneMap::addPolygon(const std::vector<juce::Point<float>>& vertices)
+{
+    if (vertices.size() < 3)
+        return noZone;
+
+    auto topLeft = vertices.front(), bottomRight = vertices.front();
+
+    for (auto& v : vertices)
+    {
+        topLeft = { juce::jmin(topLeft.x, v.x), juce::jmin(topLeft.y, v.y) };
+        bottomRight = { juce::jmax(bottomRight.x, v.x), juce::jmax(bottomRight.y, v.y) };
+    }
+
+    zones.push_back({ juce::Rectangle<float>(topLeft, bottomRight), vertices });
+    compiled = false;
+    return (int) zones.size() - 1;
+}
+
+void ZoneMap::clear()
+{
+    zones.clear();
+    cells.clear();
+    compiled = false;
+}
+
+//==============================================================================
+void ZoneMap::compile()
+{
+    cells.assign((size_t) (gridSize * gridSize), Cell());
+
+    constexpr float cellSize = 1.0f / (float) gridSize;
+
+    // Cells a zone's bounds overlap; an edge lying on a cell boundary doesn't reach into the next cell
+    auto firstCell = [](float v) { return juce::jlimit(0, gridSize - 1, (int) std::floor(v * (float) gridSize)); };
+    auto lastCell = [](float v) { return juce::jlimit(0, gridSize - 1, (int) std::ceil(v * (float) gridSize) - 1); };
+
+    // Topmost first, so each cell lists its candidates in the order they are tested
+    for (int zoneIndex = (int) zones.size(); --zoneIndex >= 0;)
+    {
+        const auto& zone = zones[(size_t) zoneIndex];
+
+        if (zone.bounds.isEmpty() || zone.bounds.getRight() < 0.0f || zone.bounds.getBottom() < 0.0f
+             || zone.bounds.getX() > 1.0f || zone.bounds.getY() > 1.0f)
+            continue;
+
+        for (int row = firstCell(zone.bounds.getY()); row <= lastCell(zone.bounds.getBottom()); ++row)
+        {
+            for (int column = firstCell(zone.bounds.getX()); column <= lastCell(zone.bounds.getRight()); ++column)
+            {
+                auto& cell = cells[(size_t) (row * gridSize + column)];
+
+                // A zone on top already covers the whole cell, or the cell tests every zone anyway
+                if (cell.isClosed || cell.isOverflowed)
+                    continue;
+
+                if (cell.numCandidates == maxCandidatesPerCell)
+                {
+                    cell.isOverflowed = true;
+                    continue;
+                }
+
+                const juce::Rectangle<float> cellArea ((float) column * cellSize, (float) row * cellSize, cellSize, cellSize);
+
+                if (zone.vertices.empty() && zone.bounds.contains(cellArea))
+                {
+                    cell.isClosed = true;
+                    cell.isCovered = cell.numCandidates == 0;
+                }
+
+                cell.candidates[cell.numCandidates++] = (int16_t) zoneIndex;
+            }
+        }
+    }
+
+    compiled = true;
+}
+
+int ZoneMap::findZone(float x, float y) const noexcept
+{
+    jassert(compiled);
+
+    if (!compiled || !(x >= 0.0f && x <= 1.0f && y >= 0.0f && y <= 1.0f))
+        return noZone;
+
+    const int column = juce::jmin(gridSize - 1, (int) (x * (float) gridSize));
+    const int row = juce::jmin(gridSize - 1, (int) (y * (float) gridSize));
+    const auto& cell = cells[(size_t) (row * gridSize + column)];
+
+    if (cell.isCovered)
+        return cell.candidates[0];
+
+    // More zones overlap here than a cell lists, so every zone is tested, topmost first
+    if (cell.isOverflowed)
+    {
+        for (int zoneIndex = (int) zones.size(); --zoneIndex >= 0;)
+            if (contains(zoneIndex, x, y))
+                return zoneIndex;
+
+        return noZone;
+    }
+
+    for (int i = 0; i < cell.numCandidates; ++i)
+        if (contains(cell.candidates[(size_t) i], x, y))
+            return cell.candidates[(size_t) i];
+
+    return noZone;
+}
+
+bool ZoneMap::contains(int zoneIndex, float x, float y) const noexcept
+{
+    const auto& zone = zones[(size_t) zoneIndex];
+
+    if (!zone.bounds.contains(juce::Point<float>(x, y)))
+        return false;
+
+    if (zone.vertices.empty())
+        return true;
+
+    // Even-odd crossing test
+    bool inside = false;
+    const auto& v = zone.vertices;
+
+    for (size_t i = 0, j = v.size() - 1; i < v.size(); j = i++)
+    {
+        if ((v[i].y > y) != (v[j].y > y)
+             && x < (v[j].x - v[i].x) * (y - v[i].y) / (v[j].y - v[i].y) + v[i].x)
+            inside = !inside;
+    }
+
+    return inside;
+}
+
+} // namespace bs_hid
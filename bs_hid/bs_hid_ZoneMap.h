@@ -0,0 +1,205 @@
+/*
+  ==============================================================================
+
+   Zone Map - Constant-time hit testing of pads and faders
+
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace bs_hid
+{
+
+/**
+    A layout of pads, faders and other zones in normalised screen space,
+    with a grid index so any point is resolved to its zone in constant time.
+
+    Zones are rectangles or polygons; zones added later lie on top. compile()
+    divides the screen into gridSize x gridSize cells and records, for each
+    cell, the few zones that overlap it, topmost first. A cell completely
+    covered by a rectangle holds only that rectangle, so most lookups return
+    without testing any shape. Others test at most maxCandidatesPerCell
+    zones exactly, so the result is exact at zone edges. A cell where more
+    zones overlap than that falls back to testing every zone, slower but
+    still exact.
+
+    Build the map on any thread, then hand it to HIDDeviceManager::setZoneMap(),
+    which resolves every contact on the HID thread. findZone() is const and
+    never allocates, so a compiled map can be shared between threads.
+
+    @code
+    auto zones = std::make_shared<bs_hid::ZoneMap>();
+
+    for (int row = 0; row < 4; ++row)
+        for (int column = 0; column < 4; ++column)
+            zones->addRectangle ({ column * 0.25f, row * 0.25f, 0.25f, 0.25f });
+
+    zones->compile();
+    hidManager.setZoneMap (zones);
+    @endcode
+*/
+class ZoneMap
+{
+public:
+    //==============================================================================
+    static constexpr int gridSize = 64;
+    static constexpr int maxCandidatesPerCell = 4;
+    static constexpr int noZone = -1;
+
+    //==============================================================================
+    ZoneMap() = default;
+
+    /** Adds a rectangular zone and returns its index */
+    int addRectangle(juce::Rectangle<float> area);
+
+    /** Adds a polygonal zone (at least three vertices, in order) and returns its index, or noZone */
+    int addPolygon(const std::vector<juce::Point<float>>& vertices);
+
+    /** Removes every zone */
+    void clear();
+
+    int getNumZones() const noexcept { return (int) zones.size(); }
+
+    /** Returns a zone's bounding box */
+    juce::Rectangle<float> getZoneBounds(int zoneIndex) const { return zones[(size_t) zoneIndex].bounds; }
+
+    //==============================================================================
+    /** Builds the grid index. Call after the last zone is added, before findZone() */
+    void compile();
+
+    bool isCompiled() const noexcept { return compiled; }
+
+    /** Returns the topmost zone containing a normalised point, or noZone */
+    int findZone(float x, float y) const noexcept;
+
+    /** Returns true if the point lies inside the zone's shape */
+    bool contains(int zoneIndex, float x, float y) const noexcept;
+
+private:
+    //==============================================================================
+    struct Zone
+    {
+        juce::Rectangle<float> bounds;
+        std::vector<juce::Point<float>> vertices;   // Empty for rectangles
+    };
+
+    struct Cell
+    {
+        std::array<int16_t, maxCandidatesPerCell> candidates;
+        uint8_t numCandidates = 0;
+        bool isCovered = false;                     // The first candidate covers the whole cell
+        bool isClosed = false;                      // Some candidate covers it, hiding any zone below
+        bool isOverflowed = false;                  // Too many zones overlap it to list: test them all
+    };
+
+    std::vector<Zone> zones;
+    std::vector<Cell> cells;
+    bool compiled = false;
+
+    JUCE_LEAK_DETECTOR(ZoneMap)
+};
+
+//==============================================================================
+/** A contact pressing, entering, leaving or releasing a zone */
+struct ZoneEvent
+{
+    enum class Type
+    {
+        press,      // Contact began inside the zone (on its TouchPhase::began report)
+        enter,      // Held contact slid into the zone
+        leave,      // Held contact slid out of the zone
+        release     // Contact lifted inside the zone
+    };
+
+    Type type = Type::press;
+    int zone = ZoneMap::noZone;
+    TouchData contact;          // On release, the contact's last report
+};
+
+//==============================================================================
+/**
+    Follows one device's contacts across a ZoneMap and reports their zone events.
+
+    process() tags each contact with TouchData::zone and calls the callback for
+    each transition, on the HID thread, without allocating.
+*/
+class ZoneTracker
+{
+public:
+    template <typename Callback>
+    void process(const ZoneMap* map, TouchData* contacts, int numContacts, Callback&& onEvent)
+    {
+        tracked.beginReport();
+
+        for (int i = 0; i < numContacts; ++i)
+        {
+            auto& contact = contacts[i];
+            contact.zone = (int16_t) (map != nullptr ? map->findZone(contact.normX, contact.normY) : ZoneMap::noZone);
+
+            bool isNew = false;
+            auto* state = tracked.find(contact.contactId, isNew);
+
+            if (state == nullptr)
+                continue;
+
+            state->last = contact;
+
+            // A contact joins zones on its Began, once its onset velocity is known
+            if (contact.phase == TouchPhase::landing)
+                continue;
+
+            if (!state->hasPressed)
+            {
+                state->hasPressed = true;
+                state->zone = contact.zone;
+
+                if (contact.zone != ZoneMap::noZone)
+                    onEvent(ZoneEvent { ZoneEvent::Type::press, contact.zone, contact });
+            }
+            else if (contact.zone != state->zone)
+            {
+                if (state->zone != ZoneMap::noZone)
+                    onEvent(ZoneEvent { ZoneEvent::Type::leave, state->zone, contact });
+
+                if (contact.zone != ZoneMap::noZone)
+                    onEvent(ZoneEvent { ZoneEvent::Type::enter, contact.zone, contact });
+
+                state->zone = contact.zone;
+            }
+        }
+
+        tracked.endReport([&](uint8_t, Tracked& state)
+        {
+            if (state.hasPressed && state.zone != ZoneMap::noZone)
+                onEvent(ZoneEvent { ZoneEvent::Type::release, state.zone, state.last });
+        });
+    }
+
+    /** Reports a release for every contact held in a zone, for when the map changes. The
+        contacts are still followed, outside any zone, so a held finger enters the new map's
+        zones as it moves rather than pressing them again */
+    template <typename Callback>
+    void releaseZones(Callback&& onEvent)
+    {
+        tracked.forEach([&](uint8_t, Tracked& state)
+        {
+            if (state.hasPressed && state.zone != ZoneMap::noZone)
+                onEvent(ZoneEvent { ZoneEvent::Type::release, state.zone, state.last });
+
+            state.zone = ZoneMap::noZone;
+        });
+    }
+
+private:
+    struct Tracked
+    {
+        TouchData last;
+        int zone = ZoneMap::noZone;
+        bool hasPressed = false;
+    };
+
+    ContactStateMap<Tracked> tracked;
+};
+
+} // namespace bs_hid
@@ -57,26 +57,92 @@ AudioPluginAudioProcessorEditor::AudioPluginAudioProcessorEditor (AudioPluginAud
     audioLatencyLabel.setColour(juce::Label::textColourId, juce::Colours::yellow);
     addAndMakeVisible(audioLatencyLabel);
 
+    // Setup latency measurement
+    measurementHeader.setText("Touch-to-Audio Latency:", juce::dontSendNotification);
+    measurementHeader.setFont(juce::Font(14.0f, juce::Font::bold));
+    measurementHeader.setColour(juce::Label::textColourId, juce::Colours::lightblue);
+    addAndMakeVisible(measurementHeader);
+
+    measureToggle.setButtonText("Measure (clicks timed on their way back in)");
+    measureToggle.addListener(this);
+    measureToggle.setToggleState(processorRef.isMeasuring(), juce::dontSendNotification);
+    addAndMakeVisible(measureToggle);
+
+    loopbackToggle.setButtonText("Simulated Loopback (no cable)");
+    loopbackToggle.addListener(this);
+    loopbackToggle.setToggleState(processorRef.isSimulatedLoopback(), juce::dontSendNotification);
+    addAndMakeVisible(loopbackToggle);
+
+    resetMeasurementButton.setButtonText("Reset");
+    resetMeasurementButton.addListener(this);
+    addAndMakeVisible(resetMeasurementButton);
+
+    measurementLabel.setText("Latency: --", juce::dontSendNotification);
+    measurementLabel.setFont(juce::Font(12.0f, juce::Font::plain));
+    addAndMakeVisible(measurementLabel);
+
+    measurementDetailLabel.setFont(juce::Font(12.0f, juce::Font::plain));
+    measurementDetailLabel.setColour(juce::Label::textColourId, juce::Colours::grey);
+    addAndMakeVisible(measurementDetailLabel);
+
+    // Device list comes from the shared registry cache; repopulate on hotplug
     populateDeviceComboBox();
+    processorRef.getDeviceRegistry().addChangeListener(this);
 
     // Start timer to update diagnostic display (100ms refresh rate)
     startTimer(100);
 
-    setSize (450, 340);
+    setSize (450, 540);
 }
 
 AudioPluginAudioProcessorEditor::~AudioPluginAudioProcessorEditor()
 {
+    processorRef.getDeviceRegistry().removeChangeListener(this);
     deviceComboBox.removeListener(this);
     optimizeButton.removeListener(this);
     restoreButton.removeListener(this);
     twoFingerToggle.removeListener(this);
+    measureToggle.removeListener(this);
+    loopbackToggle.removeListener(this);
+    resetMeasurementButton.removeListener(this);
 }
 
 //==============================================================================
 void AudioPluginAudioProcessorEditor::paint (juce::Graphics& g)
 {
     g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
+    paintDistribution (g);
+}
+
+void AudioPluginAudioProcessorEditor::paintDistribution (juce::Graphics& g)
+{
+    if (distributionArea.isEmpty())
+        return;
+
+    g.setColour(juce::Colours::black.withAlpha(0.3f));
+    g.fillRect(distributionArea);
+
+    const auto peak = *std::max_element(distribution.begin(), distribution.end());
+    const auto area = distributionArea.toFloat().reduced(2.0f);
+
+    // One bar per bin, 0 ms on the left; the last bin holds everything above
+    if (peak > 0)
+    {
+        const float barWidth = area.getWidth() / (float) bs_hid::LatencyMeter::numBins;
+        g.setColour(juce::Colours::lightgreen);
+
+        for (int i = 0; i < bs_hid::LatencyMeter::numBins; ++i)
+        {
+            const float height = area.getHeight() * (float) distribution[(size_t) i] / (float) peak;
+            g.fillRect(area.getX() + (float) i * barWidth, area.getBottom() - height, juce::jmax(1.0f, barWidth), height);
+        }
+    }
+
+    const double rangeMs = bs_hid::LatencyMeter::numBins * bs_hid::LatencyMeter::binWidthMs;
+    g.setColour(juce::Colours::grey);
+    g.setFont(10.0f);
+    g.drawText("0 ms", area, juce::Justification::topLeft);
+    g.drawText(juce::String(rangeMs, 0) + " ms", area, juce::Justification::topRight);
 }
 
 void AudioPluginAudioProcessorEditor::resized()
@@ -108,6 +174,19 @@ void AudioPluginAudioProcessorEditor::resized()
     avgIntervalLabel.setBounds(area.removeFromTop(18));
     minMaxIntervalLabel.setBounds(area.removeFromTop(18));
     audioLatencyLabel.setBounds(area.removeFromTop(18));
+
+    area.removeFromTop(10); // Separator
+
+    // Measurement section
+    measurementHeader.setBounds(area.removeFromTop(20));
+    auto measureRow = area.removeFromTop(25);
+    resetMeasurementButton.setBounds(measureRow.removeFromRight(60));
+    measureToggle.setBounds(measureRow);
+    loopbackToggle.setBounds(area.removeFromTop(25));
+    measurementLabel.setBounds(area.removeFromTop(18));
+    measurementDetailLabel.setBounds(area.removeFromTop(18));
+    area.removeFromTop(5);
+    distributionArea = area;
 }
 
 void AudioPluginAudioProcessorEditor::comboBoxChanged(juce::ComboBox* comboBoxThatHasChanged)
@@ -126,14 +205,24 @@ void AudioPluginAudioProcessorEditor::comboBoxChanged(juce::ComboBox* comboBoxTh
             optimizationStatus.setText("Connect a device to optimize", juce::dontSendNotification);
             optimizationStatus.setColour(juce::Label::textColourId, juce::Colours::grey);
         }
+        else if (selectedId == syntheticDeviceItemId)
+        {
+            processorRef.connectToSyntheticDevice();
+            statusLabel.setText("Connected to: " + processorRef.getConnectedDeviceInfo().product + " (test)", juce::dontSendNotification);
+
+            // It has no settings to optimize
+            optimizeButton.setEnabled(false);
+            restoreButton.setEnabled(false);
+            optimizationStatus.setText("Synthetic device: nothing to optimize", juce::dontSendNotification);
+            optimizationStatus.setColour(juce::Label::textColourId, juce::Colours::grey);
+        }
         else if (selectedId > 1)
         {
-            auto devices = processorRef.getAvailableHIDDevices();
             int deviceIndex = selectedId - 2;
-            if (deviceIndex >= 0 && deviceIndex < devices.size())
+            if (deviceIndex >= 0 && deviceIndex < (int) listedDevices.size())
             {
-                processorRef.connectToDevice(devices[deviceIndex]);
-                statusLabel.setText("Connected to: " + devices[deviceIndex].product, juce::dontSendNotification);
+                processorRef.connectToDevice(listedDevices[(size_t) deviceIndex]);
+                statusLabel.setText("Connected to: " + listedDevices[(size_t) deviceIndex].product, juce::dontSendNotification);
 
                 // Enable optimization controls when connected
                 optimizeButton.setEnabled(true);
@@ -188,26 +277,62 @@ void AudioPluginAudioProcessorEditor::buttonClicked(juce::Button* button)
         optimizationStatus.setColour(juce::Label::textColourId,
                                     twoFingerMode ? juce::Colours::green : juce::Colours::grey);
     }
+    else if (button == &measureToggle)
+    {
+        processorRef.setMeasuring(measureToggle.getToggleState());
+    }
+    else if (button == &loopbackToggle)
+    {
+        processorRef.setSimulatedLoopback(loopbackToggle.getToggleState());
+    }
+    else if (button == &resetMeasurementButton)
+    {
+        processorRef.getLatencyMeter().resetMeasurements();
+    }
 }
 
 void AudioPluginAudioProcessorEditor::populateDeviceComboBox()
 {
-    deviceComboBox.clear();
+    // Keep the current selection across hotplug refreshes
+    const bool syntheticSelected = deviceComboBox.getSelectedId() == syntheticDeviceItemId;
+    int selectedIndex = deviceComboBox.getSelectedId() - 2;
+    juce::String selectedPath = (selectedIndex >= 0 && selectedIndex < (int) listedDevices.size())
+                                    ? listedDevices[(size_t) selectedIndex].path
+                                    : juce::String();
+
+    deviceComboBox.clear (juce::dontSendNotification);
     deviceComboBox.addItem("Disconnect", 1);
 
-    auto devices = processorRef.getAvailableHIDDevices();
-    for (size_t i = 0; i < devices.size(); ++i)
+    // Cached in the registry, so this never enumerates on the message thread
+    listedDevices = processorRef.getAvailableHIDDevices();
+    int idToSelect = syntheticSelected ? syntheticDeviceItemId : 1;
+
+    for (size_t i = 0; i < listedDevices.size(); ++i)
     {
-        juce::String itemText = devices[i].manufacturer + " - " + devices[i].product;
+        juce::String itemText = listedDevices[i].manufacturer + " - " + listedDevices[i].product;
         deviceComboBox.addItem(itemText, static_cast<int>(i + 2));
+
+        if (selectedPath.isNotEmpty() && listedDevices[i].path == selectedPath)
+            idToSelect = static_cast<int>(i + 2);
     }
 
-    deviceComboBox.setSelectedId(1);
+    // Always offered, so the measurement can be tried without hardware
+    deviceComboBox.addSeparator();
+    deviceComboBox.addItem(bs_hid::SyntheticTouchDevice::getDeviceInfo().product + " (test, no hardware)", syntheticDeviceItemId);
+
+    deviceComboBox.setSelectedId(idToSelect, juce::dontSendNotification);
+}
+
+void AudioPluginAudioProcessorEditor::changeListenerCallback(juce::ChangeBroadcaster* source)
+{
+    if (source == &processorRef.getDeviceRegistry())
+        populateDeviceComboBox();
 }
 
 void AudioPluginAudioProcessorEditor::timerCallback()
 {
     updateDiagnosticDisplay();
+    updateMeasurementDisplay();
 }
 
 void AudioPluginAudioProcessorEditor::updateDiagnosticDisplay()
@@ -228,12 +353,13 @@ void AudioPluginAudioProcessorEditor::updateDiagnosticDisplay()
                                    audioInfo.sampleRate),
             juce::dontSendNotification);
 
-        // Calculate expected minimum end-to-end latency
+        // Compare the expected minimum end-to-end latency with the measured one, once there is one
         auto touchStats = processorRef.getLatencyStats();
-        if (touchStats.sampleCount > 0)
+        auto measured = processorRef.getLatencyMeter().getStats();
+        if (touchStats.sampleCount > 0 && measured.numMeasurements > 0)
         {
             double expectedMinLatency = touchStats.avgIntervalMs + bufferMs + 2.0; // +2ms for USB/processing overhead
-            double unexplainedLatency = 37.0 - expectedMinLatency; // Your measured 37ms
+            double unexplainedLatency = measured.medianMs - expectedMinLatency;
 
             if (unexplainedLatency > 5.0)
             {
@@ -304,3 +430,46 @@ void AudioPluginAudioProcessorEditor::updateDiagnosticDisplay()
         minMaxIntervalLabel.setText("Min/Max: --", juce::dontSendNotification);
     }
 }
+
+void AudioPluginAudioProcessorEditor::updateMeasurementDisplay()
+{
+    auto& meter = processorRef.getLatencyMeter();
+    auto stats = meter.getStats();
+
+    if (stats.numMeasurements == 0)
+    {
+        measurementLabel.setText(processorRef.isMeasuring() ? "Latency: Waiting for touches..." : "Latency: --",
+                                 juce::dontSendNotification);
+        measurementDetailLabel.setText(stats.numMissed > 0 ? juce::String::formatted("%u clicks missed", stats.numMissed)
+                                                           : juce::String(),
+                                       juce::dontSendNotification);
+    }
+    else
+    {
+        measurementLabel.setText(
+            juce::String::formatted("Latency: median %.2f ms, p95 %.2f ms, min/max %.2f / %.2f ms",
+                                   stats.medianMs,
+                                   stats.p95Ms,
+                                   stats.minMs,
+                                   stats.maxMs),
+            juce::dontSendNotification);
+
+        measurementDetailLabel.setText(
+            juce::String::formatted("%u touches, %u missed, %u unmatched; sd %.2f ms, round trip %.2f ms",
+                                   stats.numMeasurements,
+                                   stats.numMissed,
+                                   stats.numUnmatched,
+                                   stats.stdDevMs,
+                                   stats.roundTripMs),
+            juce::dontSendNotification);
+    }
+
+    // Redraw the distribution only when it has changed
+    auto newDistribution = meter.getDistribution();
+
+    if (newDistribution != distribution)
+    {
+        distribution = newDistribution;
+        repaint(distributionArea);
+    }
+}
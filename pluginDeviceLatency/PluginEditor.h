@@ -6,6 +6,7 @@
 class AudioPluginAudioProcessorEditor final : public juce::AudioProcessorEditor,
                                              public juce::ComboBox::Listener,
                                              public juce::Button::Listener,
+                                             public juce::ChangeListener,
                                              public juce::Timer
 {
 public:
@@ -18,10 +19,13 @@ public:
     void comboBoxChanged (juce::ComboBox* comboBoxThatHasChanged) override;
     void buttonClicked (juce::Button* button) override;
     void timerCallback() override;
+    void changeListenerCallback (juce::ChangeBroadcaster* source) override;
 
 private:
     void populateDeviceComboBox();
     void updateDiagnosticDisplay();
+    void updateMeasurementDisplay();
+    void paintDistribution (juce::Graphics& g);
 
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
@@ -29,6 +33,8 @@ private:
 
     juce::Label deviceLabel;
     juce::ComboBox deviceComboBox;
+    std::vector<HIDDeviceInfo> listedDevices; // Devices currently shown in deviceComboBox
+    static constexpr int syntheticDeviceItemId = 1000; // Clear of the listed devices' IDs
     juce::Label statusLabel;
 
     // Latency optimization controls
@@ -44,5 +50,15 @@ private:
     juce::Label minMaxIntervalLabel;
     juce::Label audioLatencyLabel;
 
+    // Latency measurement
+    juce::Label measurementHeader;
+    juce::ToggleButton measureToggle;
+    juce::ToggleButton loopbackToggle;
+    juce::TextButton resetMeasurementButton;
+    juce::Label measurementLabel;
+    juce::Label measurementDetailLabel;
+    juce::Rectangle<int> distributionArea;
+    bs_hid::LatencyMeter::Distribution distribution {};
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioPluginAudioProcessorEditor)
 };
@@ -12,8 +12,6 @@ AudioPluginAudioProcessor::AudioPluginAudioProcessor()
                      #endif
                        ), juce::Thread("HIDPollingThread")
 {
-    // Initialize HID devices list
-    enumerateHIDDevices();
 }
 
 AudioPluginAudioProcessor::~AudioPluginAudioProcessor()
@@ -98,6 +96,13 @@ void AudioPluginAudioProcessor::prepareToPlay (double sampleRate, int samplesPer
     // Calculate total latency (buffer + any reported latency from the system)
     int totalLatency = samplesPerBlock + getLatencySamples();
     currentTotalLatencySamples.store(totalLatency, std::memory_order_relaxed);
+
+    audioClock.prepare(sampleRate);
+    jitterBuffer.reset();
+    latencyMeter.prepare(sampleRate);
+
+    loopbackLine.assign((size_t) (maxSimulatedRoundTripMs * 0.001 * sampleRate) + 1, 0.0f);
+    loopbackWritePos = 0;
 }
 
 void AudioPluginAudioProcessor::releaseResources()
@@ -155,21 +160,96 @@ void AudioPluginAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
 
     if (currentTouchState && (currentTime - lastTouchTime > touchTimeoutMs)) {
         setTouchState(0, 0, false);
-        currentTouchState = false;
     }
 
-    // Generate click impulse on touch start using optimized atomic
-    bool touchStarted = currentTouchState && !previousTouchState;
-    previousTouchState = currentTouchState;
+    // Report times go onto the sample timeline through the audio clock, and every report through the
+    // jitter buffer, so the delay is already measured when constant latency is chosen
+    audioClock.update(juce::Time::getMillisecondCounterHiRes(), buffer.getNumSamples());
+    jitterBuffer.beginBlock(audioClock, buffer.getNumSamples());
+
+    const bool measure = measuring.load();
+    const bool simulate = measure && simulatedLoopback.load() && buffer.getNumChannels() > 0;
+
+    if (measure) {
+        // Through a cable the click comes back on the first input. Passed through it would go round
+        // again, so only the clicks are output while measuring
+        if (!simulate && totalNumInputChannels > 0)
+            latencyMeter.processInput(buffer.getReadPointer(0), 0, buffer.getNumSamples(), audioClock);
+
+        buffer.clear();
+    }
 
-    if (touchStarted) {
+    // Clicks are measured from when their touch went down, carried as the contact's timestamp
+    auto writeClick = [&](int sampleOffset, double touchTimeMs) {
         for (int channel = 0; channel < totalNumInputChannels; ++channel)
         {
             auto* channelData = buffer.getWritePointer(channel);
-            if (buffer.getNumSamples() > 0) {
-                channelData[0] = 0.5f; // Single impulse at first sample
+            if (sampleOffset < buffer.getNumSamples()) {
+                channelData[sampleOffset] = 0.5f; // Single impulse
             }
         }
+
+        if (measure)
+            latencyMeter.addClick(touchTimeMs, audioClock.getBlockStartSample() + sampleOffset);
+    };
+
+    int start1, size1, start2, size2;
+    touchReportFifo.prepareToRead(touchReportFifo.getNumReady(), start1, size1, start2, size2);
+
+    bs_hid::TouchFrame frame;
+
+    for (int i = 0; i < size1 + size2; ++i) {
+        const auto& report = touchReports[(size_t) (i < size1 ? start1 + i : start2 + i - size1)];
+        frame.receiveTimeMs = report.readTimeMs;
+        frame.scanTimeMs = report.scanTimeMs;
+        frame.numContacts = report.touchStarted ? 1 : 0;
+        frame.contacts[0].phase = bs_hid::TouchPhase::began;
+        frame.contacts[0].timestamp = (juce::int64) (report.touchDownMs * 1000.0);
+        jitterBuffer.push(frame);
+    }
+
+    touchReportFifo.finishedRead(size1 + size2);
+
+    if (timing.load() == Timing::constantLatency) {
+        // Click at the touch's report time plus the delay, wherever in the callback period it arrived
+        int sampleOffset = 0;
+
+        while (jitterBuffer.popDueFrame(frame, sampleOffset)) {
+            if (frame.numContacts > 0)
+                writeClick(sampleOffset, (double) frame.contacts[0].timestamp * 0.001);
+        }
+    } else {
+        // Click at the first sample for every touch that started since the last block
+        while (jitterBuffer.flushFrame(frame)) {
+            if (frame.numContacts > 0)
+                writeClick(0, (double) frame.contacts[0].timestamp * 0.001);
+        }
+    }
+
+    if (simulate)
+        applySimulatedLoopback(buffer.getReadPointer(0), buffer.getNumSamples());
+}
+
+void AudioPluginAudioProcessor::applySimulatedLoopback(const float* output, int numSamples)
+{
+    // Each output sample goes into the line and the one written a round trip earlier comes back.
+    // Done in chunks, so what comes back is analysed without a block-sized buffer
+    const int lineSize = (int) loopbackLine.size();
+    const double sampleRate = currentSampleRate.load(std::memory_order_relaxed);
+    const int delaySamples = juce::jlimit(0, lineSize - 1, juce::roundToInt(simulatedRoundTripMs.load() * 0.001 * sampleRate));
+
+    std::array<float, loopbackChunkSize> returned;
+
+    for (int start = 0; start < numSamples; start += loopbackChunkSize) {
+        const int chunkSize = juce::jmin(loopbackChunkSize, numSamples - start);
+
+        for (int i = 0; i < chunkSize; ++i) {
+            loopbackLine[(size_t) loopbackWritePos] = output[start + i];
+            returned[(size_t) i] = loopbackLine[(size_t) ((loopbackWritePos - delaySamples + lineSize) % lineSize)];
+            loopbackWritePos = (loopbackWritePos + 1) % lineSize;
+        }
+
+        latencyMeter.processInput(returned.data(), start, chunkSize, audioClock);
     }
 }
 
@@ -205,99 +285,77 @@ void AudioPluginAudioProcessor::setStateInformation (const void* data, int sizeI
 
 std::vector<HIDDeviceInfo> AudioPluginAudioProcessor::getAvailableHIDDevices()
 {
-    return hidDevices;
+    return deviceRegistry->getDevices();
 }
 
-void AudioPluginAudioProcessor::enumerateHIDDevices()
+void AudioPluginAudioProcessor::connectToDevice(const HIDDeviceInfo& device)
 {
-    hidDevices.clear();
+    disconnectFromDevice();
 
-    if (hid_init() != 0) {
+    connectedDevice = hidContext->openDevice(device);
+    if (!connectedDevice) {
         return;
     }
 
-    struct hid_device_info* devices = hid_enumerate(0x0, 0x0);
-    struct hid_device_info* current_device = devices;
-
-    while (current_device) {
-        HIDDeviceInfo deviceInfo;
-        deviceInfo.path = juce::String(current_device->path);
-        deviceInfo.vendorId = current_device->vendor_id;
-        deviceInfo.productId = current_device->product_id;
-
-        if (current_device->manufacturer_string)
-            deviceInfo.manufacturer = juce::String(current_device->manufacturer_string);
-        else
-            deviceInfo.manufacturer = "Unknown";
-
-        if (current_device->product_string)
-            deviceInfo.product = juce::String(current_device->product_string);
-        else
-            deviceInfo.product = "Unknown Product";
-
-        if (current_device->serial_number)
-            deviceInfo.serialNumber = juce::String(current_device->serial_number);
-        else
-            deviceInfo.serialNumber = "No Serial";
+    hid_set_nonblocking(connectedDevice, 1);
+    connectedDeviceInfo = device;
+    resetReportStats();
 
-        hidDevices.push_back(deviceInfo);
-        current_device = current_device->next;
-    }
+    // Query available feature reports to analyze device capabilities
+    queryAvailableFeatureReports();
 
-    hid_free_enumeration(devices);
-    hid_exit();
+    // Start real-time thread for minimal latency HID polling
+    juce::Thread::RealtimeOptions realtimeOptions;
+    realtimeOptions.withPriority(8); // High priority (0-10 scale)
+    startRealtimeThread(realtimeOptions);
 }
 
-void AudioPluginAudioProcessor::connectToDevice(const HIDDeviceInfo& device)
+void AudioPluginAudioProcessor::connectToSyntheticDevice()
 {
     disconnectFromDevice();
 
-    if (hid_init() != 0) {
-        return;
-    }
+    syntheticDevice = std::make_unique<bs_hid::SyntheticTouchDevice>();
+    connectedDeviceInfo = bs_hid::SyntheticTouchDevice::getDeviceInfo();
+    resetReportStats();
 
-    connectedDevice = hid_open_path(device.path.toUTF8());
-    if (!connectedDevice) {
-        hid_exit();
-        return;
-    }
-
-    hid_set_nonblocking(connectedDevice, 1);
-    connectedDeviceInfo = device;
+    // Read on the same real-time thread, so its reports take the same path as a device's
+    juce::Thread::RealtimeOptions realtimeOptions;
+    realtimeOptions.withPriority(8);
+    startRealtimeThread(realtimeOptions);
+}
 
-    // Reset diagnostic statistics
-    lastReportTimeUs = 0;
+void AudioPluginAudioProcessor::resetReportStats()
+{
+    // The reader is stopped, and each device has its own scan clock
+    scanClock = std::make_unique<bs_hid::ScanTimeClock>();
+    lastReportTimeMs = 0.0;
     reportIntervalMs.store(0.0, std::memory_order_relaxed);
     minReportIntervalMs.store(999999.0, std::memory_order_relaxed);
     maxReportIntervalMs.store(0.0, std::memory_order_relaxed);
     avgReportIntervalMs.store(0.0, std::memory_order_relaxed);
     reportCount.store(0, std::memory_order_relaxed);
     runningIntervalSum = 0.0;
-
-    // Query available feature reports to analyze device capabilities
-    queryAvailableFeatureReports();
-
-    // Start real-time thread for minimal latency HID polling
-    juce::Thread::RealtimeOptions realtimeOptions;
-    realtimeOptions.withPriority(8); // High priority (0-10 scale)
-    startRealtimeThread(realtimeOptions);
 }
 
 void AudioPluginAudioProcessor::disconnectFromDevice()
 {
-    if (connectedDevice) {
+    if (connectedDevice || syntheticDevice) {
         signalThreadShouldExit();
         waitForThreadToExit(1000); // Wait up to 1 second for clean exit
-        hid_close(connectedDevice);
-        hid_exit();
+    }
+
+    if (connectedDevice) {
+        hidContext->closeDevice(connectedDevice);
         connectedDevice = nullptr;
     }
+
+    syntheticDevice.reset();
 }
 
 void AudioPluginAudioProcessor::run()
 {
     while (!threadShouldExit()) {
-        if (connectedDevice) {
+        if (connectedDevice || syntheticDevice) {
             readHIDEvents();
         }
         wait(1); // Sleep for 1ms between polls
@@ -306,19 +364,23 @@ void AudioPluginAudioProcessor::run()
 
 void AudioPluginAudioProcessor::readHIDEvents()
 {
-    if (!connectedDevice) return;
+    if (!connectedDevice && !syntheticDevice) return;
 
     unsigned char buffer[256];
-    int bytesRead = hid_read(connectedDevice, buffer, sizeof(buffer));
+    int bytesRead = syntheticDevice ? syntheticDevice->read(buffer, sizeof(buffer), juce::Time::getMillisecondCounterHiRes())
+                                    : hid_read(connectedDevice, buffer, sizeof(buffer));
+
+    // Stamped once, as soon as the report is in hand, on the same monotonic clock as the audio side
+    const double readTimeMs = juce::Time::getMillisecondCounterHiRes();
 
     if (bytesRead > 0) {
-        parseInputReport(buffer, bytesRead);
+        parseInputReport(buffer, bytesRead, readTimeMs);
     } else if (bytesRead < 0) {
         disconnectFromDevice();
     }
 }
 
-void AudioPluginAudioProcessor::parseInputReport(unsigned char* data, int length)
+void AudioPluginAudioProcessor::parseInputReport(unsigned char* data, int length, double readTimeMs)
 {
     if (length > 0) {
         unsigned char reportId = data[0];
@@ -327,12 +389,25 @@ void AudioPluginAudioProcessor::parseInputReport(unsigned char* data, int length
         uint16_t dummy_x, dummy_y;
         bool wasTouchActive = getTouchState(dummy_x, dummy_y);
 
+        const bool isStandardDigitizer = syntheticDevice
+            || (connectedDeviceInfo.vendorId == 0x2575 && connectedDeviceInfo.productId == 0x7317);
+
+        // When the panel scanned the report, if it says, so latency includes the scan-to-read delay
+        double scanTimeMs = readTimeMs;
+
+        if (isStandardDigitizer && reportId == 1 && scanClock != nullptr) {
+            const int scanTime = bs_hid::TouchParser::parseStandardScanTime(data, length, reportId);
+
+            if (scanTime >= 0)
+                scanTimeMs = scanClock->addReport((uint16_t) scanTime, readTimeMs, wasTouchActive);
+        }
+
         // ELO Touch parsing for Atmel maXTouch
         if (connectedDeviceInfo.vendorId == 0x03EB && connectedDeviceInfo.productId == 0x8A6E) {
             parseELOTouchData(data, length, reportId);
         }
-        // Standard HID multi-touch digitizer parsing for new touchscreen
-        else if (connectedDeviceInfo.vendorId == 0x2575 && connectedDeviceInfo.productId == 0x7317 && reportId == 1) {
+        // Standard HID multi-touch digitizer parsing for new touchscreen, which the synthetic device imitates
+        else if (isStandardDigitizer && reportId == 1) {
             parseStandardTouchData(data, length, reportId);
         }
 
@@ -340,14 +415,23 @@ void AudioPluginAudioProcessor::parseInputReport(unsigned char* data, int length
         bool isTouchActive = getTouchState(dummy_x, dummy_y);
 
         if (isTouchActive) {
-            juce::int64 currentTimeTicks = juce::Time::getHighResolutionTicks();
+            // Queue the report for the audio thread; dropped if it has stopped reading
+            int start1, size1, start2, size2;
+            touchReportFifo.prepareToWrite(1, start1, size1, start2, size2);
+
+            if (size1 > 0) {
+                // The synthetic device knows exactly when its finger went down; the scan clock can only
+                // place a scan as early as the fastest report arrived
+                const double touchDownMs = syntheticDevice && !wasTouchActive ? syntheticDevice->getLastTapDownMs()
+                                                                              : scanTimeMs;
+
+                touchReports[(size_t) start1] = { readTimeMs, scanTimeMs, touchDownMs, !wasTouchActive };
+                touchReportFifo.finishedWrite(1);
+            }
 
             // Only measure interval if previous report also had active touch
-            if (wasTouchActive && lastReportTimeUs > 0) {
-                // Calculate interval between reports (convert ticks to milliseconds)
-                juce::int64 ticksPerSecond = juce::Time::getHighResolutionTicksPerSecond();
-                double intervalSeconds = (double)(currentTimeTicks - lastReportTimeUs) / (double)ticksPerSecond;
-                double intervalMs = intervalSeconds * 1000.0;
+            if (wasTouchActive && lastReportTimeMs > 0.0) {
+                double intervalMs = readTimeMs - lastReportTimeMs;
 
                 // Update statistics
                 reportIntervalMs.store(intervalMs, std::memory_order_relaxed);
@@ -369,7 +453,7 @@ void AudioPluginAudioProcessor::parseInputReport(unsigned char* data, int length
                 avgReportIntervalMs.store(runningIntervalSum / count, std::memory_order_relaxed);
             }
 
-            lastReportTimeUs = currentTimeTicks;
+            lastReportTimeMs = readTimeMs;
         }
     }
 }
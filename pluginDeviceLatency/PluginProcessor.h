@@ -1,18 +1,10 @@
 #pragma once
 
 #include <juce_audio_processors/juce_audio_processors.h>
-
-#include "../hidapi/hidapi/hidapi.h"
+#include <bs_hid/bs_hid.h>
 
 //==============================================================================
-struct HIDDeviceInfo {
-    juce::String path;
-    unsigned short vendorId;
-    unsigned short productId;
-    juce::String manufacturer;
-    juce::String product;
-    juce::String serialNumber;
-};
+using HIDDeviceInfo = bs_hid::HIDDeviceInfo;
 
 //==============================================================================
 class AudioPluginAudioProcessor final : public juce::AudioProcessor, public juce::Thread
@@ -59,9 +51,16 @@ public:
     std::vector<HIDDeviceInfo> getAvailableHIDDevices();
     void connectToDevice(const HIDDeviceInfo& device);
     void disconnectFromDevice();
-    bool isDeviceConnected() const { return connectedDevice != nullptr; }
+    bool isDeviceConnected() const { return connectedDevice != nullptr || syntheticDevice != nullptr; }
+
+    // A tapping finger generated in-process, read like a device, for testing without hardware
+    void connectToSyntheticDevice();
+    bool isSyntheticDeviceConnected() const { return syntheticDevice != nullptr; }
     const HIDDeviceInfo& getConnectedDeviceInfo() const { return connectedDeviceInfo; }
 
+    // Process-wide device registry (cached list, broadcasts on hotplug)
+    bs_hid::HIDDeviceRegistry& getDeviceRegistry() { return *deviceRegistry; }
+
     // Thread run method for reading HID events
     void run() override;
 
@@ -91,12 +90,37 @@ public:
     };
     AudioSetupInfo getAudioSetupInfo() const;
 
+    // When the click plays: at the start of the first block after the touch, or a constant delay after it
+    enum class Timing { lowestLatency, constantLatency };
+    void setTiming(Timing newTiming) { timing.store(newTiming); }
+    Timing getTiming() const { return timing.load(); }
+
+    // The constant delay, late-click counters and measured jitter. Its options and stats are thread-safe
+    bs_hid::JitterBuffer& getJitterBuffer() { return jitterBuffer; }
+
+    // Report clock to sample position, drift included. getMapping() is thread-safe
+    const bs_hid::AudioClock& getAudioClock() const { return audioClock; }
+
+    // Latency measurement: the input is silenced from the output and every touch's click is timed
+    // on its way back. Simulated loopback feeds the output back after a set delay instead of a cable;
+    // with no delay it measures the software path, from the report to the output buffer
+    void setMeasuring(bool shouldMeasure) { measuring.store(shouldMeasure); }
+    bool isMeasuring() const { return measuring.load(); }
+    void setSimulatedLoopback(bool shouldSimulate) { simulatedLoopback.store(shouldSimulate); }
+    bool isSimulatedLoopback() const { return simulatedLoopback.load(); }
+    void setSimulatedRoundTripMs(double ms) { simulatedRoundTripMs.store(juce::jlimit(0.0, maxSimulatedRoundTripMs, ms)); }
+    double getSimulatedRoundTripMs() const { return simulatedRoundTripMs.load(); }
+
+    // Measured distribution and percentiles. Its options and stats are thread-safe
+    bs_hid::LatencyMeter& getLatencyMeter() { return latencyMeter; }
+
 private:
     //==============================================================================
     // HID functionality
-    void enumerateHIDDevices();
     void readHIDEvents();
-    void parseInputReport(unsigned char* data, int length);
+    void resetReportStats();
+    void applySimulatedLoopback(const float* output, int numSamples);
+    void parseInputReport(unsigned char* data, int length, double readTimeMs);
     void parseELOTouchData(unsigned char* data, int length, unsigned char reportId);
     void parseStandardTouchData(unsigned char* data, int length, unsigned char reportId);
 
@@ -128,15 +152,45 @@ private:
         return (packed & (1ULL << 32)) != 0;
     }
 
-    std::vector<HIDDeviceInfo> hidDevices;
+    juce::SharedResourcePointer<bs_hid::HIDContext> hidContext;
+    juce::SharedResourcePointer<bs_hid::HIDDeviceRegistry> deviceRegistry;
+
     hid_device* connectedDevice = nullptr;
+    std::unique_ptr<bs_hid::SyntheticTouchDevice> syntheticDevice;  // Only changed while the thread is stopped
     HIDDeviceInfo connectedDeviceInfo;
 
     // Optimized touch data communication using single atomic
     std::atomic<uint64_t> touchState{0}; // Packed: x(16) + y(16) + active(1) + timestamp(31)
 
-    // Touch state tracking for click generation
-    bool previousTouchState = false;
+    // Every touch report, stamped on the HID thread, for the jitter buffer on the audio thread.
+    // All times are on the Time::getMillisecondCounterHiRes() clock
+    struct TouchReport {
+        double readTimeMs = 0.0;
+        double scanTimeMs = 0.0;    // When the panel scanned it, or readTimeMs if it doesn't say
+        double touchDownMs = 0.0;   // When the touch went down, which latency is measured from
+        bool touchStarted = false;
+    };
+
+    static constexpr int touchReportQueueSize = 256;
+    juce::AbstractFifo touchReportFifo { touchReportQueueSize };
+    std::array<TouchReport, touchReportQueueSize> touchReports;
+    std::unique_ptr<bs_hid::ScanTimeClock> scanClock;   // HID thread; replaced on connect
+
+    bs_hid::AudioClock audioClock;
+    bs_hid::JitterBuffer jitterBuffer;
+    std::atomic<Timing> timing { Timing::lowestLatency };
+
+    // Latency measurement
+    bs_hid::LatencyMeter latencyMeter;
+    std::atomic<bool> measuring { false };
+    std::atomic<bool> simulatedLoopback { true };
+    std::atomic<double> simulatedRoundTripMs { 0.0 };
+    static constexpr double maxSimulatedRoundTripMs = 500.0;
+    static constexpr int loopbackChunkSize = 256;
+    std::vector<float> loopbackLine;    // Output samples on their way back, sized in prepareToPlay()
+    int loopbackWritePos = 0;
+
+    // Touch state tracking
     juce::int64 lastTouchTime = 0;
     const juce::int64 touchTimeoutMs = 50; // Reset touch state if no events for 50ms
 
@@ -157,7 +211,7 @@ private:
     int maxTouchPoints = 2; // Default to 2 fingers for optimal latency
 
     // Diagnostic timing measurements
-    juce::int64 lastReportTimeUs = 0;  // Microsecond timestamp of last HID report
+    double lastReportTimeMs = 0.0;  // Time::getMillisecondCounterHiRes() when the last HID report was read
     std::atomic<double> reportIntervalMs{0.0};  // Most recent interval in ms
     std::atomic<double> minReportIntervalMs{999999.0};
     std::atomic<double> maxReportIntervalMs{0.0};
@@ -3,7 +3,7 @@
 
 //==============================================================================
 AudioPluginAudioProcessorEditor::AudioPluginAudioProcessorEditor (AudioPluginAudioProcessor& p)
-    : AudioProcessorEditor (&p), processorRef (p), touchVisualizer(p.getHIDDeviceManager(), p.getCalibrationManager())
+    : AudioProcessorEditor (&p), processorRef (p), touchVisualizer(p.getHIDHub(), p.getCalibrationManager())
 {
     // Add and make the touch visualizer visible
     addAndMakeVisible(touchVisualizer);
@@ -58,10 +58,22 @@ bool AudioPluginAudioProcessorEditor::keyPressed(const juce::KeyPress& key, juce
         toggleFullscreen();
         return true;
     }
-    // Press 'C' to enter calibration mode
+    // Press 'C' to enter 9-point calibration mode
     else if (key == juce::KeyPress('c', juce::ModifierKeys::noModifiers, 0))
     {
-        touchVisualizer.startCalibration();
+        touchVisualizer.startCalibration(9);
+        return true;
+    }
+    // Press Shift+C for the quick two-corner calibration
+    else if (key == juce::KeyPress('c', juce::ModifierKeys::shiftModifier, 0))
+    {
+        touchVisualizer.startCalibration(2);
+        return true;
+    }
+    // Press 'G' to capture the edge-linearity correction grid (after calibrating)
+    else if (key == juce::KeyPress('g', juce::ModifierKeys::noModifiers, 0))
+    {
+        touchVisualizer.startCorrectionCapture(5, 5);
         return true;
     }
 
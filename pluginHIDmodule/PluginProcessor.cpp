@@ -9,30 +9,19 @@ AudioPluginAudioProcessor::AudioPluginAudioProcessor()
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
+                       .withOutput ("Modulation", juce::AudioChannelSet::discreteChannels (3), false)
                      #endif
                        )
 {
-    // Register as listener for touch events
-    hidDeviceManager.addListener(this);
+    // The shared hub loads the touch calibration and applies it to every frame
+    DBG("Touch calibration: " << (getCalibrationManager().getBounds().isCalibrated ? "Loaded from file" : "Using defaults"));
 
-    // Load touch calibration
-    bool calibLoaded = calibrationManager.loadFromFile();
-    DBG("Touch calibration: " << (calibLoaded ? "Loaded from file" : "Using defaults"));
-
-    // Attempt initial connection
-    attemptTouchDeviceConnection();
-
-    // Enable auto-reconnect for known touch devices
-    hidDeviceManager.enableAutoReconnect({
-        {0x03EB, 0x8A6E},  // ELO Touch (Atmel maXTouch)
-        {0x2575, 0x7317}   // Standard touch digitizer
-    }, 2000); // Check every 2 seconds
+    // The shared hub connects to known touch devices and keeps auto-reconnect enabled
+    DBG("HID hub subscribers: " << hidHub->getNumSubscribers());
 }
 
 AudioPluginAudioProcessor::~AudioPluginAudioProcessor()
 {
-    hidDeviceManager.disableAutoReconnect();
-    hidDeviceManager.removeListener(this);
 }
 
 //==============================================================================
@@ -103,9 +92,25 @@ void AudioPluginAudioProcessor::changeProgramName (int index, const juce::String
 //==============================================================================
 void AudioPluginAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    // Use this method as the place to do any pre-playback
-    // initialisation that you need..
-    juce::ignoreUnused (sampleRate, samplesPerBlock);
+    currentSampleRate = sampleRate;
+
+    // Everything processBlock() needs is allocated here
+    mpeOutput.prepare();
+    midiOutput.clear();
+    midiOutput.ensureSize (midiBufferBytes);
+
+    // Samples are held at the playback rate; whichever bank is loaded is remade if it changes
+    sampler.setSampleRate (sampleRate);
+
+    synth.prepare (sampleRate);
+    audioClock.prepare (sampleRate);
+    jitterBuffer.reset();
+
+    // The modulation history spans a block rendered up to the constant-latency delay in the
+    // past, plus the callback period of reports queued before it
+    const double blockMs = 1000.0 * samplesPerBlock / sampleRate;
+    const double maxLagMs = juce::jmax (modulationDelayMs, bs_hid::JitterBuffer::maxDelayMs);
+    touchHistory.prepare (2.0 * blockMs + maxLagMs, maxTouchReportRateHz);
 }
 
 void AudioPluginAudioProcessor::releaseResources()
@@ -134,6 +139,11 @@ bool AudioPluginAudioProcessor::isBusesLayoutSupported (const BusesLayout& layou
         return false;
    #endif
 
+    // The modulation bus carries X, Y and pressure for as many touch slots as it has room for
+    if (layouts.outputBuses.size() > 1
+         && layouts.getNumChannels (false, 1) > 3 * bs_hid::TouchHistory::maxSlots)
+        return false;
+
     return true;
   #endif
 }
@@ -141,32 +151,98 @@ bool AudioPluginAudioProcessor::isBusesLayoutSupported (const BusesLayout& layou
 void AudioPluginAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
                                               juce::MidiBuffer& midiMessages)
 {
-    juce::ignoreUnused (midiMessages);
-
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
+    const int numSamples = buffer.getNumSamples();
 
     // Clear unused output channels
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
-        buffer.clear (i, 0, buffer.getNumSamples());
+        buffer.clear (i, 0, numSamples);
+
+    // Report times are placed on the sample timeline through the audio clock, which averages out
+    // the callbacks' jitter and follows the sound card's drift
+    audioClock.update (juce::Time::getMillisecondCounterHiRes(), numSamples);
+
+    // Reports that arrived during the last block period are played one block later, each at
+    // the offset matching its arrival, so MIDI keeps the timing of the touches
+    const double blockStartMs = audioClock.sampleToTime ((double) (audioClock.getBlockStartSample() - numSamples));
+
+    auto getSampleOffset = [&] (const bs_hid::TouchFrame& frame)
+    {
+        const auto offset = audioClock.getSampleOffset (frame.receiveTimeMs) + numSamples;
+        return juce::jlimit (0, juce::jmax (0, numSamples - 1), offset);
+    };
+
+    midiOutput.clear();
+    mpeOutput.addZoneConfiguration (midiOutput, 0);
+
+    // Synth voices are released when switching away; samples just ring out
+    const auto newInstrument = instrument.load();
+
+    if (newInstrument != playingInstrument && playingInstrument == Instrument::synth)
+        synth.releaseAll (0);
+
+    playingInstrument = newInstrument;
+
+    auto playFrame = [&] (const bs_hid::TouchFrame& frame, int sampleOffset)
+    {
+        mpeOutput.addFrame (frame, sampleOffset, midiOutput, expressionLimitBytes);
+
+        if (playingInstrument == Instrument::synth)
+            synth.addFrame (frame, sampleOffset);
+        else
+            sampler.addFrame (frame, sampleOffset);
+    };
+
+    // Drain every frame since the last block, so short taps between blocks are not missed.
+    // Every contact's Began carries how hard it landed
+    bs_hid::TouchFrame frame;
+    jitterBuffer.beginBlock (audioClock, numSamples);
+
+    while (hidSubscriber.popFrame(frame))
+    {
+        jitterBuffer.push (frame);
+        touchHistory.addFrame (frame);
+    }
+
+    const bool constantLatency = timing.load() == Timing::constantLatency;
+
+    if (constantLatency)
+    {
+        // Each frame at its report time plus the delay, wherever in the callback period it arrived
+        int sampleOffset = 0;
+
+        while (jitterBuffer.popDueFrame (frame, sampleOffset))
+            playFrame (frame, sampleOffset);
+    }
+    else
+    {
+        // Frames still held for constant latency come first, so nothing plays out of order
+        while (jitterBuffer.flushFrame (frame))
+            playFrame (frame, getSampleOffset (frame));
+    }
+
+    // Touch events are built only into our preallocated buffer, then merged after any MIDI the
+    // host passed in. The host reuses its buffer, so it grows only until it has held the busiest block
+    midiMessages.addEvents (midiOutput, 0, -1, 0);
 
-    // Get current touch state
-    auto touchData = hidDeviceManager.getLatestTouchData();
-    bool touchStarted = touchData.isActive && !previousTouchState;
-    previousTouchState = touchData.isActive;
+    // Both are mixed over the input, each touch starting at its own offset
+    auto mainOutput = getBusBuffer (buffer, false, 0);
+    sampler.render (mainOutput, numSamples);
+    synth.render (mainOutput, numSamples);
 
-    // Generate click impulse on touch start
-    if (touchStarted)
+    // Touch slots as audio-rate control signals, if the host has enabled the modulation bus
+    if (getBusCount (false) > 1)
     {
-        for (int channel = 0; channel < totalNumOutputChannels; ++channel)
-        {
-            auto* channelData = buffer.getWritePointer(channel);
-            if (buffer.getNumSamples() > 0)
-            {
-                channelData[0] = 0.5f; // Single impulse at first sample
-            }
-        }
+        auto modulation = getBusBuffer (buffer, false, 1);
+        // With constant latency the signals line up with the sound, and the delay already lets them ramp
+        const double modulationStartMs = constantLatency ? jitterBuffer.getBlockStartMs() - jitterBuffer.getDelayMs()
+                                                         : blockStartMs - modulationDelayMs;
+
+        for (int channel = 0; channel < modulation.getNumChannels() && channel / 3 < bs_hid::TouchHistory::maxSlots; ++channel)
+            touchHistory.render (channel / 3, (bs_hid::TouchHistory::Signal) (channel % 3), modulationStartMs,
+                                 currentSampleRate, modulation.getWritePointer (channel), numSamples);
     }
 }
 
@@ -202,88 +278,27 @@ void AudioPluginAudioProcessor::setStateInformation (const void* data, int sizeI
 
 std::vector<bs_hid::HIDDeviceInfo> AudioPluginAudioProcessor::getAvailableHIDDevices()
 {
-    return hidDeviceManager.getAvailableDevices();
+    return getHIDDeviceManager().getAvailableDevices();
 }
 
 void AudioPluginAudioProcessor::connectToDevice(const bs_hid::HIDDeviceInfo& device)
 {
-    hidDeviceManager.connectToDevice(device);
+    getHIDDeviceManager().connectToDevice(device);
 }
 
 void AudioPluginAudioProcessor::disconnectFromDevice()
 {
-    hidDeviceManager.disconnectFromDevice();
+    getHIDDeviceManager().disconnectFromDevice();
 }
 
 bool AudioPluginAudioProcessor::isDeviceConnected() const
 {
-    return hidDeviceManager.isDeviceConnected();
+    return hidHub->getDeviceManager().isDeviceConnected();
 }
 
 const bs_hid::HIDDeviceInfo& AudioPluginAudioProcessor::getConnectedDeviceInfo() const
 {
-    return hidDeviceManager.getConnectedDeviceInfo();
-}
-
-void AudioPluginAudioProcessor::touchDetected(const bs_hid::TouchData& touchData)
-{
-    // This callback is called from the HID polling thread
-    // You can log, update UI, or trigger other events here
-    //DBG("Touch detected: x=" << touchData.x << " y=" << touchData.y << " active=" << (touchData.isActive ? "true" : "false"));
-}
-
-void AudioPluginAudioProcessor::attemptTouchDeviceConnection()
-{
-    // Don't try to connect if already connected
-    if (hidDeviceManager.isDeviceConnected())
-        return;
-
-    // Get available devices
-    auto devices = hidDeviceManager.getAvailableDevices();
-
-    DBG("Found " << devices.size() << " HID devices:");
-    for (const auto& device : devices)
-    {
-        DBG("  - VID:0x" << juce::String::toHexString((int)device.vendorId)
-            << " PID:0x" << juce::String::toHexString((int)device.productId)
-            << " : " << device.manufacturer << " - " << device.product);
-    }
-
-    // Look for known touch devices (ELO or the standard one)
-    bs_hid::HIDDeviceInfo* touchDevice = nullptr;
-    for (auto& device : devices)
-    {
-        // ELO Touch (Atmel maXTouch)
-        if (device.vendorId == 0x03EB && device.productId == 0x8A6E)
-        {
-            touchDevice = &device;
-            DBG("Found ELO Touch device!");
-            break;
-        }
-        // Standard touch digitizer
-        else if (device.vendorId == 0x2575 && device.productId == 0x7317)
-        {
-            touchDevice = &device;
-            DBG("Found standard touch digitizer!");
-            break;
-        }
-    }
-
-    if (touchDevice != nullptr)
-    {
-        if (hidDeviceManager.connectToDevice(*touchDevice))
-        {
-            DBG("Successfully connected to: " << touchDevice->manufacturer << " - " << touchDevice->product);
-        }
-        else
-        {
-            DBG("Failed to connect to touch device");
-        }
-    }
-    else
-    {
-        DBG("No known touch device found. Please check vendor/product IDs.");
-    }
+    return hidHub->getDeviceManager().getConnectedDeviceInfo();
 }
 
 //==============================================================================
@@ -2,10 +2,12 @@
 
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <bs_hid/bs_hid.h>
+#include "TouchMPEOutput.h"
+#include "TouchSampler.h"
+#include "TouchSynth.h"
 
 //==============================================================================
-class AudioPluginAudioProcessor final : public juce::AudioProcessor,
-                                       public bs_hid::HIDDeviceManager::Listener
+class AudioPluginAudioProcessor final : public juce::AudioProcessor
 {
 public:
     //==============================================================================
@@ -52,25 +54,62 @@ public:
     bool isDeviceConnected() const;
     const bs_hid::HIDDeviceInfo& getConnectedDeviceInfo() const;
 
-    // HID Device Manager access
-    bs_hid::HIDDeviceManager& getHIDDeviceManager() { return hidDeviceManager; }
+    // HID Device Manager access (shared by every instance in this process)
+    bs_hid::HIDDeviceManager& getHIDDeviceManager() { return hidHub->getDeviceManager(); }
+    bs_hid::HIDHub& getHIDHub() { return *hidHub; }
 
-    // Touch Calibration Manager access
-    bs_hid::TouchCalibrationManager& getCalibrationManager() { return calibrationManager; }
+    // Touch Calibration Manager access (owned by the hub, applied to every frame)
+    bs_hid::TouchCalibrationManager& getCalibrationManager() { return hidHub->getCalibrationManager(); }
 
-    // Listener callback from HIDDeviceManager
-    void touchDetected(const bs_hid::TouchData& touchData) override;
+    // Samples played by touches, made at getSampleRate(). Safe to call while playing
+    void setSampleBank (std::unique_ptr<const TouchSampler::SampleBank> newBank) { sampler.setBank (std::move (newBank)); }
 
-private:
-    // Attempt to connect to known touch devices
-    void attemptTouchDeviceConnection();
+    // What touches play: a sample each, or a synth voice per finger that follows it
+    enum class Instrument { sampler, synth };
+    void setInstrument (Instrument newInstrument) { instrument.store (newInstrument); }
+    Instrument getInstrument() const { return instrument.load(); }
 
-    //==============================================================================
-    bs_hid::HIDDeviceManager hidDeviceManager;
-    bs_hid::TouchCalibrationManager calibrationManager;
+    // When touches play: as soon as a block picks them up, or all at one constant delay after their reports
+    enum class Timing { lowestLatency, constantLatency };
+    void setTiming (Timing newTiming) { timing.store (newTiming); }
+    Timing getTiming() const { return timing.load(); }
+
+    // The constant delay, late-frame counters and measured jitter. Its options and stats are thread-safe
+    bs_hid::JitterBuffer& getJitterBuffer() { return jitterBuffer; }
 
-    // Touch state for audio processing
-    bool previousTouchState = false;
+    // Report clock to sample position, drift included. getMapping() is thread-safe
+    const bs_hid::AudioClock& getAudioClock() const { return audioClock; }
+
+private:
+    //==============================================================================
+    // One hub per process owns the device and polling thread; each instance subscribes
+    juce::SharedResourcePointer<bs_hid::HIDHub> hidHub;
+    bs_hid::HIDHub::Subscriber hidSubscriber { *hidHub };
+
+    // MPE output, one member channel per contact
+    static constexpr int midiBufferBytes = 32768;
+    static constexpr int expressionLimitBytes = midiBufferBytes - 1024;   // Keeps room for note-ons and offs
+
+    TouchMPEOutput mpeOutput;
+    juce::MidiBuffer midiOutput;
+    double currentSampleRate = 44100.0;
+
+    // Audio output, one sample per touch or one synth voice per finger
+    TouchSampler sampler;
+    TouchSynth synth;
+    std::atomic<Instrument> instrument { Instrument::sampler };
+    Instrument playingInstrument = Instrument::sampler;     // Audio thread only
+
+    // Report times to sample positions, and every frame through the jitter buffer so the delay
+    // is already measured when constant latency is chosen
+    bs_hid::AudioClock audioClock;
+    bs_hid::JitterBuffer jitterBuffer;
+    std::atomic<Timing> timing { Timing::lowestLatency };
+
+    // Modulation output, rendered one report interval late so it ramps between reports
+    static constexpr double modulationDelayMs = 10.0;
+    static constexpr double maxTouchReportRateHz = 2000.0;     // Fastest panel the history is sized for
+    bs_hid::TouchHistory touchHistory;
 
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioPluginAudioProcessor)
@@ -0,0 +1,161 @@
+#include "TouchMPEOutput.h"
+
+//==============================================================================
+void TouchMPEOutput::prepare (const Settings& newSettings)
+{
+    settings = newSettings;
+    channels = {};
+    eventCounter = 0;
+
+    zoneConfiguration = juce::MPEMessages::setLowerZone (numMemberChannels, settings.pitchBendRange);
+    zoneConfigurationPending = true;
+}
+
+void TouchMPEOutput::addZoneConfiguration (juce::MidiBuffer& midi, int sampleOffset)
+{
+    if (! zoneConfigurationPending)
+        return;
+
+    midi.addEvents (zoneConfiguration, 0, -1, sampleOffset);
+    zoneConfigurationPending = false;
+}
+
+void TouchMPEOutput::addFrame (const bs_hid::TouchFrame& frame, int sampleOffset,
+                               juce::MidiBuffer& midi, int expressionLimitBytes)
+{
+    for (auto& channel : channels)
+        channel.seen = false;
+
+    for (int i = 0; i < frame.numContacts; ++i)
+    {
+        const auto& contact = frame.contacts[(size_t) i];
+        int channelIndex = findChannel (getContactKey (contact));
+
+        if (channelIndex < 0)
+        {
+            // The note starts on Began, once the strike velocity is known. A held contact
+            // whose note was stolen stays silent rather than stealing in turn
+            if (contact.phase != bs_hid::TouchPhase::began)
+                continue;
+
+            channelIndex = allocateChannel (midi, sampleOffset);
+            startNote (channelIndex, contact, midi, sampleOffset);
+        }
+        else if (midi.data.size() < expressionLimitBytes)
+        {
+            addExpression (channelIndex, contact, midi, sampleOffset);
+        }
+
+        channels[(size_t) channelIndex].seen = true;
+    }
+
+    // Contacts missing from the frame have lifted
+    for (int i = 0; i < numMemberChannels; ++i)
+        if (channels[(size_t) i].contactKey >= 0 && ! channels[(size_t) i].seen)
+            stopNote (i, midi, sampleOffset);
+}
+
+void TouchMPEOutput::allNotesOff (juce::MidiBuffer& midi, int sampleOffset)
+{
+    for (int i = 0; i < numMemberChannels; ++i)
+        if (channels[(size_t) i].contactKey >= 0)
+            stopNote (i, midi, sampleOffset);
+}
+
+//==============================================================================
+int TouchMPEOutput::findChannel (int contactKey) const noexcept
+{
+    for (int i = 0; i < numMemberChannels; ++i)
+        if (channels[(size_t) i].contactKey == contactKey)
+            return i;
+
+    return -1;
+}
+
+int TouchMPEOutput::allocateChannel (juce::MidiBuffer& midi, int sampleOffset) noexcept
+{
+    int freeIndex = -1, oldestIndex = 0;
+
+    for (int i = 0; i < numMemberChannels; ++i)
+    {
+        const auto& channel = channels[(size_t) i];
+
+        // The channel released longest ago, so a recent note's release tail keeps its channel
+        if (channel.contactKey < 0)
+        {
+            if (freeIndex < 0 || channel.releaseOrder < channels[(size_t) freeIndex].releaseOrder)
+                freeIndex = i;
+        }
+        else if (channel.startOrder < channels[(size_t) oldestIndex].startOrder
+                  || channels[(size_t) oldestIndex].contactKey < 0)
+        {
+            oldestIndex = i;
+        }
+    }
+
+    if (freeIndex >= 0)
+        return freeIndex;
+
+    stopNote (oldestIndex, midi, sampleOffset);
+    return oldestIndex;
+}
+
+void TouchMPEOutput::startNote (int channelIndex, const bs_hid::TouchData& contact,
+                                juce::MidiBuffer& midi, int sampleOffset)
+{
+    auto& channel = channels[(size_t) channelIndex];
+    const float pitch = (float) settings.lowestNote + contact.normX * settings.semitoneRange;
+
+    channel.contactKey = getContactKey (contact);
+    channel.note = juce::jlimit (0, 127, juce::roundToInt (pitch));
+    channel.startOrder = ++eventCounter;
+    channel.lastPitchBend = channel.lastTimbre = channel.lastPressure = -1;
+
+    // Expression goes first, so the note starts at the right pitch and timbre
+    addExpression (channelIndex, contact, midi, sampleOffset);
+
+    const auto velocity = (juce::uint8) juce::jlimit (1, 127, juce::roundToInt (contact.onsetVelocity * 127.0f));
+    midi.addEvent (juce::MidiMessage::noteOn (getMidiChannel (channelIndex), channel.note, velocity), sampleOffset);
+}
+
+void TouchMPEOutput::stopNote (int channelIndex, juce::MidiBuffer& midi, int sampleOffset)
+{
+    auto& channel = channels[(size_t) channelIndex];
+
+    midi.addEvent (juce::MidiMessage::noteOff (getMidiChannel (channelIndex), channel.note), sampleOffset);
+
+    channel.contactKey = -1;
+    channel.releaseOrder = ++eventCounter;
+}
+
+void TouchMPEOutput::addExpression (int channelIndex, const bs_hid::TouchData& contact,
+                                    juce::MidiBuffer& midi, int sampleOffset)
+{
+    auto& channel = channels[(size_t) channelIndex];
+    const int midiChannel = getMidiChannel (channelIndex);
+
+    // Pitch bend carries the distance from the note, so the pitch follows X continuously
+    const float pitch = (float) settings.lowestNote + contact.normX * settings.semitoneRange;
+    const float bend = (pitch - (float) channel.note) / (float) settings.pitchBendRange;
+    const int pitchBend = juce::jlimit (0, 16383, 8192 + juce::roundToInt (bend * 8191.0f));
+
+    // Y is 0 at the top, timbre rises upwards
+    const int timbre = juce::jlimit (0, 127, juce::roundToInt ((1.0f - contact.normY) * 127.0f));
+
+    // The panel reports no force, so pressure holds the strike velocity
+    const int pressure = juce::jlimit (0, 127, juce::roundToInt (contact.onsetVelocity * 127.0f));
+
+    // Only changes are sent; a resting finger sends nothing
+    if (pitchBend != channel.lastPitchBend)
+        midi.addEvent (juce::MidiMessage::pitchWheel (midiChannel, pitchBend), sampleOffset);
+
+    if (timbre != channel.lastTimbre)
+        midi.addEvent (juce::MidiMessage::controllerEvent (midiChannel, 74, timbre), sampleOffset);
+
+    if (pressure != channel.lastPressure)
+        midi.addEvent (juce::MidiMessage::channelPressureChange (midiChannel, pressure), sampleOffset);
+
+    channel.lastPitchBend = pitchBend;
+    channel.lastTimbre = timbre;
+    channel.lastPressure = pressure;
+}
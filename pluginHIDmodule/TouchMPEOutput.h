@@ -0,0 +1,84 @@
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <bs_hid/bs_hid.h>
+
+//==============================================================================
+/**
+    Turns touch frames into MPE: one note per contact on its own member channel
+    of a lower zone, with X as pitch (note plus per-note pitch bend), Y as
+    timbre (CC74) and the strike velocity as note-on velocity and pressure.
+
+    Contacts are assigned channels from a fixed pool. A released channel is
+    reused last, so release tails are not cut; when all are busy the oldest
+    note is stolen.
+
+    Nothing here allocates or locks once prepare() has run, so it can be called
+    from processBlock().
+*/
+class TouchMPEOutput
+{
+public:
+    //==============================================================================
+    static constexpr int numMemberChannels = 15;     // Channels 2 to 16, master on 1
+
+    struct Settings
+    {
+        int lowestNote = 48;                // Note at the left edge
+        float semitoneRange = 24.0f;        // Semitones across the screen
+        int pitchBendRange = 48;            // Per-note pitch bend range in semitones (MPE default)
+    };
+
+    //==============================================================================
+    TouchMPEOutput() = default;
+
+    /** Builds the zone configuration and forgets every note. Call from prepareToPlay() */
+    void prepare (const Settings& newSettings);
+    void prepare() { prepare (Settings()); }
+
+    /** Adds the zone configuration, if prepare() was called since the last time */
+    void addZoneConfiguration (juce::MidiBuffer& midi, int sampleOffset);
+
+    /** Adds the note-ons, expression and note-offs for one frame at sampleOffset.
+        Expression is skipped once the buffer reaches expressionLimitBytes, so
+        that a long block can't grow it past what was preallocated. */
+    void addFrame (const bs_hid::TouchFrame& frame, int sampleOffset,
+                   juce::MidiBuffer& midi, int expressionLimitBytes);
+
+    /** Releases every sounding note */
+    void allNotesOff (juce::MidiBuffer& midi, int sampleOffset);
+
+private:
+    //==============================================================================
+    struct Channel
+    {
+        int contactKey = -1;                // deviceIndex << 8 | contactId, or -1 when free
+        int note = 0;
+        uint32_t startOrder = 0, releaseOrder = 0;
+        int lastPitchBend = -1, lastTimbre = -1, lastPressure = -1;
+        bool seen = false;
+    };
+
+    static int getContactKey (const bs_hid::TouchData& contact) noexcept
+    {
+        return (int) contact.deviceIndex << 8 | (int) contact.contactId;
+    }
+
+    static int getMidiChannel (int channelIndex) noexcept { return channelIndex + 2; }
+
+    int findChannel (int contactKey) const noexcept;
+    int allocateChannel (juce::MidiBuffer& midi, int sampleOffset) noexcept;
+    void startNote (int channelIndex, const bs_hid::TouchData& contact, juce::MidiBuffer& midi, int sampleOffset);
+    void stopNote (int channelIndex, juce::MidiBuffer& midi, int sampleOffset);
+    void addExpression (int channelIndex, const bs_hid::TouchData& contact, juce::MidiBuffer& midi, int sampleOffset);
+
+    //==============================================================================
+    Settings settings;
+    std::array<Channel, numMemberChannels> channels;
+    uint32_t eventCounter = 0;
+
+    juce::MidiBuffer zoneConfiguration;
+    bool zoneConfigurationPending = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TouchMPEOutput)
+};
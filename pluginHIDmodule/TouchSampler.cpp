@@ -0,0 +1,257 @@
+#include "TouchSampler.h"
+
+//==============================================================================
+int TouchSampler::SampleBank::addSample (const juce::AudioBuffer<float>& source, double sourceSampleRate)
+{
+    const double ratio = sourceSampleRate / sampleRate;
+    const int length = juce::jmax (1, (int) std::ceil (source.getNumSamples() / ratio));
+
+    juce::AudioBuffer<float> resampled (juce::jmax (1, source.getNumChannels()), length);
+    resampled.clear();
+
+    for (int channel = 0; channel < source.getNumChannels(); ++channel)
+    {
+        const auto* in = source.getReadPointer (channel);
+        auto* out = resampled.getWritePointer (channel);
+        const int lastIndex = source.getNumSamples() - 1;
+
+        // Linear interpolation is enough for the short one-shots this plays
+        for (int i = 0; i < length && lastIndex >= 0; ++i)
+        {
+            const double position = i * ratio;
+            const int index = juce::jmin ((int) position, lastIndex);
+            const float fraction = (float) (position - index);
+            out[i] = in[index] + fraction * (in[juce::jmin (index + 1, lastIndex)] - in[index]);
+        }
+    }
+
+    samples.push_back (std::move (resampled));
+    sources.push_back ({ source, sourceSampleRate });
+    return (int) samples.size() - 1;
+}
+
+std::unique_ptr<TouchSampler::SampleBank> TouchSampler::SampleBank::withSampleRate (double playbackSampleRate) const
+{
+    if (isDefault)
+        return createDefault (playbackSampleRate);
+
+    auto newBank = std::make_unique<SampleBank> (playbackSampleRate);
+
+    for (const auto& source : sources)
+        newBank->addSample (source.audio, source.sampleRate);
+
+    return newBank;
+}
+
+std::unique_ptr<TouchSampler::SampleBank> TouchSampler::SampleBank::createDefault (double playbackSampleRate)
+{
+    auto defaultBank = std::make_unique<SampleBank> (playbackSampleRate);
+    const int length = (int) (playbackSampleRate * 0.5);
+    const int clickLength = (int) (playbackSampleRate * 0.003);
+    juce::Random random (1);
+
+    for (int semitones : { 0, 3, 5, 7, 10, 12, 15, 17 })
+    {
+        juce::AudioBuffer<float> hit (1, length);
+        auto* out = hit.getWritePointer (0);
+        const double frequency = 110.0 * std::pow (2.0, semitones / 12.0);
+        double phase = 0.0;
+
+        for (int i = 0; i < length; ++i)
+        {
+            const double t = i / playbackSampleRate;
+
+            // A body that drops in pitch as it decays, with a noise click on the attack
+            phase += juce::MathConstants<double>::twoPi * frequency * (1.0 + std::exp (-t * 40.0)) / playbackSampleRate;
+            float value = (float) (std::sin (phase) * std::exp (-t * 6.0));
+
+            if (i < clickLength)
+                value += (random.nextFloat() * 2.0f - 1.0f) * 0.5f * (1.0f - (float) i / (float) clickLength);
+
+            out[i] = value;
+        }
+
+        defaultBank->addSample (hit, playbackSampleRate);
+    }
+
+    // Synthesised at the playback rate, so there is nothing to keep for another one
+    defaultBank->isDefault = true;
+    defaultBank->sources.clear();
+    return defaultBank;
+}
+
+//==============================================================================
+void TouchSampler::setBank (std::unique_ptr<const SampleBank> newBank)
+{
+    const juce::ScopedLock sl (bankChangeLock);
+
+    {
+        const juce::SpinLock::ScopedLockType lock (bankLock);
+        std::swap (bank, newBank);
+        voices = {};
+    }
+
+    // The old bank is released here, outside the lock
+}
+
+double TouchSampler::getBankSampleRate() const
+{
+    const juce::SpinLock::ScopedLockType lock (bankLock);
+    return bank != nullptr ? bank->getSampleRate() : 0.0;
+}
+
+void TouchSampler::setSampleRate (double newSampleRate)
+{
+    // Only setBank() replaces the bank, and it waits for this lock, so the bank can be read without bankLock
+    const juce::ScopedLock sl (bankChangeLock);
+
+    if (bank == nullptr)
+        setBank (SampleBank::createDefault (newSampleRate));
+    else if (bank->getSampleRate() != newSampleRate)
+        setBank (bank->withSampleRate (newSampleRate));
+}
+
+void TouchSampler::addFrame (const bs_hid::TouchFrame& frame, int sampleOffset) noexcept
+{
+    for (int i = 0; i < frame.numContacts && numTriggers < maxTriggersPerBlock; ++i)
+    {
+        const auto& contact = frame.contacts[(size_t) i];
+
+        if (contact.phase == bs_hid::TouchPhase::began)
+            triggers[(size_t) numTriggers++] = { contact.zone, contact.normX, contact.onsetVelocity, sampleOffset };
+    }
+}
+
+void TouchSampler::render (juce::AudioBuffer<float>& buffer, int numSamples) noexcept
+{
+    const juce::SpinLock::ScopedTryLockType lock (bankLock);
+
+    // The bank is being replaced: this block's touches are dropped rather than waited for
+    if (! lock.isLocked() || bank == nullptr || bank->getNumSamples() == 0)
+    {
+        numTriggers = 0;
+        return;
+    }
+
+    for (int i = 0; i < numTriggers; ++i)
+        startVoice (triggers[(size_t) i]);
+
+    numTriggers = 0;
+
+    for (auto& voice : voices)
+    {
+        if (voice.fadingSample != nullptr)
+            renderFade (voice, buffer, numSamples);
+
+        if (voice.sample != nullptr)
+            renderVoice (voice, buffer, numSamples);
+    }
+}
+
+//==============================================================================
+void TouchSampler::startVoice (const Trigger& trigger) noexcept
+{
+    const int numSamples = bank->getNumSamples();
+    const int sampleIndex = trigger.zone >= 0 ? trigger.zone % numSamples
+                                              : juce::jlimit (0, numSamples - 1, (int) (trigger.x * (float) numSamples));
+
+    // A free voice, preferring one that isn't still fading out a stolen sample
+    Voice* target = nullptr;
+
+    for (auto& voice : voices)
+    {
+        if (voice.sample == nullptr && (target == nullptr || target->fadingSample != nullptr))
+            target = &voice;
+    }
+
+    if (target == nullptr)
+    {
+        target = &voices[0];
+
+        for (auto& voice : voices)
+            if (voice.startOrder < target->startOrder)
+                target = &voice;
+
+        // The stolen sample plays on to the new one's start, then fades out under it.
+        // One that was due to start even later never sounded and is just replaced
+        if (target->startOffset <= trigger.sampleOffset && target->gain > 0.0f)
+        {
+            target->fadingSample = target->sample;
+            target->fadingPosition = target->position;
+            target->fadingStartOffset = target->startOffset;
+            target->fadeStart = trigger.sampleOffset;
+            target->fadingGain = target->gain;
+            target->fadingStep = target->gain / (float) stealFadeSamples;
+        }
+    }
+
+    target->sample = &bank->getSample (sampleIndex);
+    target->position = 0;
+    target->startOffset = trigger.sampleOffset;
+    target->gain = gain.load() * trigger.velocity;
+    target->startOrder = ++startCounter;
+}
+
+void TouchSampler::renderVoice (Voice& voice, juce::AudioBuffer<float>& buffer, int numSamples) noexcept
+{
+    const auto& sample = *voice.sample;
+    const int begin = juce::jmin (voice.startOffset, numSamples);
+    const int count = juce::jmin (numSamples - begin, sample.getNumSamples() - voice.position);
+
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    {
+        const auto* source = sample.getReadPointer (juce::jmin (channel, sample.getNumChannels() - 1), voice.position);
+        juce::FloatVectorOperations::addWithMultiply (buffer.getWritePointer (channel, begin), source, voice.gain, count);
+    }
+
+    voice.position += count;
+    voice.startOffset = 0;
+
+    if (voice.position >= sample.getNumSamples())
+        voice.sample = nullptr;
+}
+
+void TouchSampler::renderFade (Voice& voice, juce::AudioBuffer<float>& buffer, int numSamples) noexcept
+{
+    const auto& sample = *voice.fadingSample;
+    const int sourceChannels = sample.getNumChannels();
+
+    // At full level up to the steal, like any other voice
+    const int begin = juce::jmin (voice.fadingStartOffset, numSamples);
+    const int fadeStart = juce::jmin (voice.fadeStart, numSamples);
+    const int heldCount = juce::jmin (fadeStart - begin, sample.getNumSamples() - voice.fadingPosition);
+
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    {
+        const auto* source = sample.getReadPointer (juce::jmin (channel, sourceChannels - 1), voice.fadingPosition);
+        juce::FloatVectorOperations::addWithMultiply (buffer.getWritePointer (channel, begin), source, voice.fadingGain, heldCount);
+    }
+
+    voice.fadingPosition += heldCount;
+
+    // Then a short linear ramp, which may carry on into the next block
+    const int rampCount = juce::jmin (numSamples - fadeStart,
+                                      sample.getNumSamples() - voice.fadingPosition,
+                                      (int) std::ceil (voice.fadingGain / voice.fadingStep));
+    float rampGain = voice.fadingGain;
+
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    {
+        const auto* source = sample.getReadPointer (juce::jmin (channel, sourceChannels - 1), voice.fadingPosition);
+        auto* out = buffer.getWritePointer (channel, fadeStart);
+        rampGain = voice.fadingGain;
+
+        for (int i = 0; i < rampCount; ++i)
+        {
+            rampGain = juce::jmax (0.0f, rampGain - voice.fadingStep);
+            out[i] += source[i] * rampGain;
+        }
+    }
+
+    voice.fadingPosition += juce::jmax (0, rampCount);
+    voice.fadingGain = rampGain;
+    voice.fadingStartOffset = voice.fadeStart = 0;
+
+    if (voice.fadingGain <= 0.0f || voice.fadingPosition >= sample.getNumSamples())
+        voice.fadingSample = nullptr;
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <bs_hid/bs_hid.h>
+
+//==============================================================================
+/**
+    Plays a preloaded sample for every touch, starting at the sample the touch
+    landed on.
+
+    Each contact's Began report triggers one sample, chosen by the contact's
+    zone if a ZoneMap is set, or else by its horizontal position, at a level
+    set by its strike velocity. Voices come from a fixed pool; when all are
+    busy the oldest is stolen, fading out over a few samples under the new
+    one rather than clicking.
+
+    Samples are held in a SampleBank at the playback rate, so a voice is a
+    plain vectorised multiply-add per channel with no interpolation.
+    addFrame() and render() never allocate, and only try-lock against a bank
+    being swapped, so they can run at any buffer size.
+*/
+class TouchSampler
+{
+public:
+    //==============================================================================
+    static constexpr int maxVoices = 32;
+    static constexpr int maxTriggersPerBlock = 64;
+    static constexpr int stealFadeSamples = 64;
+
+    //==============================================================================
+    /** A set of samples, resampled to one playback rate and held in memory. The source
+        audio is kept as well, so the bank can be remade at another rate */
+    class SampleBank
+    {
+    public:
+        explicit SampleBank (double playbackSampleRate) : sampleRate (playbackSampleRate) {}
+
+        /** Adds a copy of a sample, resampled to the bank's rate, and returns its index */
+        int addSample (const juce::AudioBuffer<float>& source, double sourceSampleRate);
+
+        /** The same samples made at another playback rate, from their source audio */
+        std::unique_ptr<SampleBank> withSampleRate (double playbackSampleRate) const;
+
+        int getNumSamples() const noexcept                          { return (int) samples.size(); }
+        double getSampleRate() const noexcept                       { return sampleRate; }
+        const juce::AudioBuffer<float>& getSample (int index) const { return samples[(size_t) index]; }
+
+        /** Eight synthesised drum-like hits on a pentatonic scale, used until samples are loaded */
+        static std::unique_ptr<SampleBank> createDefault (double playbackSampleRate);
+
+    private:
+        struct Source
+        {
+            juce::AudioBuffer<float> audio;
+            double sampleRate;
+        };
+
+        double sampleRate;
+        bool isDefault = false;     // Synthesised again rather than resampled
+        std::vector<juce::AudioBuffer<float>> samples;
+        std::vector<Source> sources;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SampleBank)
+    };
+
+    //==============================================================================
+    TouchSampler() = default;
+
+    /** Replaces the samples and silences every voice. The bank must be made at the
+        rate render() runs at. Call from any thread but the audio thread; the old
+        bank is freed on the calling thread. */
+    void setBank (std::unique_ptr<const SampleBank> newBank);
+
+    /** Returns the rate of the current bank, or 0 if there is none */
+    double getBankSampleRate() const;
+
+    /** Remakes the current bank at a new playback rate, keeping its samples, or makes the
+        default one if there is none. Call from prepareToPlay() */
+    void setSampleRate (double newSampleRate);
+
+    /** Overall level of every voice */
+    void setGain (float newGain) noexcept { gain.store (newGain); }
+
+    /** Queues a sample for every contact beginning in the frame, to start at sampleOffset */
+    void addFrame (const bs_hid::TouchFrame& frame, int sampleOffset) noexcept;
+
+    /** Starts the queued samples and mixes every voice into the first numSamples of the buffer */
+    void render (juce::AudioBuffer<float>& buffer, int numSamples) noexcept;
+
+private:
+    //==============================================================================
+    struct Trigger
+    {
+        int zone;
+        float x, velocity;
+        int sampleOffset;
+    };
+
+    struct Voice
+    {
+        const juce::AudioBuffer<float>* sample = nullptr;
+        int position = 0, startOffset = 0;
+        float gain = 0.0f;
+        uint32_t startOrder = 0;
+
+        // A stolen sample, playing on until fadeStart and then fading out
+        const juce::AudioBuffer<float>* fadingSample = nullptr;
+        int fadingPosition = 0, fadingStartOffset = 0, fadeStart = 0;
+        float fadingGain = 0.0f, fadingStep = 0.0f;
+    };
+
+    void startVoice (const Trigger& trigger) noexcept;
+    static void renderVoice (Voice& voice, juce::AudioBuffer<float>& buffer, int numSamples) noexcept;
+    static void renderFade (Voice& voice, juce::AudioBuffer<float>& buffer, int numSamples) noexcept;
+
+    //==============================================================================
+    juce::SpinLock bankLock;                        // Held by render(), and by setBank() to swap
+    juce::CriticalSection bankChangeLock;           // Serialises setBank() and setSampleRate()
+    std::unique_ptr<const SampleBank> bank;
+    std::array<Voice, maxVoices> voices;
+    uint32_t startCounter = 0;
+
+    std::array<Trigger, maxTriggersPerBlock> triggers;
+    int numTriggers = 0;
+
+    std::atomic<float> gain { 0.5f };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TouchSampler)
+};
@@ -0,0 +1,417 @@
+#include "TouchSynth.h"
+
+namespace
+{
+    //==============================================================================
+    // Four voices in one register. The voice code is written once against these;
+    // BS_HID_USE_SIMD picks the instruction set as it does in bs_hid
+   #if BS_HID_USE_SSE
+    struct Lanes
+    {
+        __m128 v;
+
+        static Lanes load (const float* p) noexcept     { return { _mm_load_ps (p) }; }
+        static Lanes fill (float x) noexcept            { return { _mm_set1_ps (x) }; }
+        void store (float* p) const noexcept            { _mm_store_ps (p, v); }
+    };
+
+    inline Lanes operator+ (Lanes a, Lanes b) noexcept  { return { _mm_add_ps (a.v, b.v) }; }
+    inline Lanes operator- (Lanes a, Lanes b) noexcept  { return { _mm_sub_ps (a.v, b.v) }; }
+    inline Lanes operator* (Lanes a, Lanes b) noexcept  { return { _mm_mul_ps (a.v, b.v) }; }
+    inline Lanes operator/ (Lanes a, Lanes b) noexcept  { return { _mm_div_ps (a.v, b.v) }; }
+    inline Lanes lessThan (Lanes a, Lanes b) noexcept   { return { _mm_cmplt_ps (a.v, b.v) }; }
+    inline Lanes select (Lanes mask, Lanes a, Lanes b) noexcept
+    {
+        return { _mm_or_ps (_mm_and_ps (mask.v, a.v), _mm_andnot_ps (mask.v, b.v)) };
+    }
+   #elif BS_HID_USE_NEON
+    struct Lanes
+    {
+        float32x4_t v;
+
+        static Lanes load (const float* p) noexcept     { return { vld1q_f32 (p) }; }
+        static Lanes fill (float x) noexcept            { return { vdupq_n_f32 (x) }; }
+        void store (float* p) const noexcept            { vst1q_f32 (p, v); }
+    };
+
+    inline Lanes operator+ (Lanes a, Lanes b) noexcept  { return { vaddq_f32 (a.v, b.v) }; }
+    inline Lanes operator- (Lanes a, Lanes b) noexcept  { return { vsubq_f32 (a.v, b.v) }; }
+    inline Lanes operator* (Lanes a, Lanes b) noexcept  { return { vmulq_f32 (a.v, b.v) }; }
+    inline Lanes operator/ (Lanes a, Lanes b) noexcept  { return { vdivq_f32 (a.v, b.v) }; }
+    inline Lanes lessThan (Lanes a, Lanes b) noexcept   { return { vreinterpretq_f32_u32 (vcltq_f32 (a.v, b.v)) }; }
+    inline Lanes select (Lanes mask, Lanes a, Lanes b) noexcept
+    {
+        return { vbslq_f32 (vreinterpretq_u32_f32 (mask.v), a.v, b.v) };
+    }
+   #else
+    struct Lanes
+    {
+        float v[4];
+
+        static Lanes load (const float* p) noexcept     { return { { p[0], p[1], p[2], p[3] } }; }
+        static Lanes fill (float x) noexcept            { return { { x, x, x, x } }; }
+        void store (float* p) const noexcept            { std::copy (v, v + 4, p); }
+    };
+
+    template <typename Operation>
+    inline Lanes perLane (Lanes a, Lanes b, Operation&& operation) noexcept
+    {
+        Lanes result;
+
+        for (int i = 0; i < 4; ++i)
+            result.v[i] = operation (a.v[i], b.v[i]);
+
+        return result;
+    }
+
+    // Masks are all-ones or zero per lane, as with the intrinsics: here, 1 or 0
+    inline Lanes operator+ (Lanes a, Lanes b) noexcept  { return perLane (a, b, [] (float x, float y) { return x + y; }); }
+    inline Lanes operator- (Lanes a, Lanes b) noexcept  { return perLane (a, b, [] (float x, float y) { return x - y; }); }
+    inline Lanes operator* (Lanes a, Lanes b) noexcept  { return perLane (a, b, [] (float x, float y) { return x * y; }); }
+    inline Lanes operator/ (Lanes a, Lanes b) noexcept  { return perLane (a, b, [] (float x, float y) { return x / y; }); }
+    inline Lanes lessThan (Lanes a, Lanes b) noexcept   { return perLane (a, b, [] (float x, float y) { return x < y ? 1.0f : 0.0f; }); }
+    inline Lanes select (Lanes mask, Lanes a, Lanes b) noexcept
+    {
+        Lanes result;
+
+        for (int i = 0; i < 4; ++i)
+            result.v[i] = mask.v[i] != 0.0f ? a.v[i] : b.v[i];
+
+        return result;
+    }
+   #endif
+
+    float getEnvelopeCoefficient (float timeMs, double sampleRate)
+    {
+        return 1.0f - (float) std::exp (-1.0 / juce::jmax (1.0, timeMs * 0.001 * sampleRate));
+    }
+}
+
+//==============================================================================
+void TouchSynth::prepare (double newSampleRate, const Settings& newSettings)
+{
+    sampleRate = newSampleRate;
+    settings = newSettings;
+    attackCoefficient = getEnvelopeCoefficient (settings.attackMs, sampleRate);
+    releaseCoefficient = getEnvelopeCoefficient (settings.releaseMs, sampleRate);
+
+    for (int i = 0; i < numPaddedLanes; ++i)
+    {
+        phase[i] = incrementSlope[i] = cutoffSlope[i] = 0.0f;
+        lowpass1[i] = lowpass2[i] = level[i] = targetLevel[i] = 0.0f;
+        increment[i] = 0.01f;                   // Never zero: the band-limiting step divides by it
+        cutoff[i] = 0.5f;
+        envelopeCoefficient[i] = releaseCoefficient;
+    }
+
+    lanes = {};
+    eventCounter = 0;
+    numEvents = 0;
+    lastEventOffset = 0;
+}
+
+void TouchSynth::addFrame (const bs_hid::TouchFrame& frame, int sampleOffset) noexcept
+{
+    // Events are kept in time order, so render() can walk them once
+    sampleOffset = juce::jmax (sampleOffset, lastEventOffset);
+    lastEventOffset = sampleOffset;
+
+    for (auto& lane : lanes)
+        lane.seen = false;
+
+    for (int i = 0; i < frame.numContacts; ++i)
+    {
+        const auto& contact = frame.contacts[(size_t) i];
+        const int contactKey = (int) contact.deviceIndex << 8 | (int) contact.contactId;
+        int lane = -1;
+
+        for (int l = 0; l < numLanes && lane < 0; ++l)
+            if (lanes[(size_t) l].contactKey == contactKey)
+                lane = l;
+
+        if (lane < 0)
+        {
+            // The voice starts on Began, once the strike velocity is known
+            if (contact.phase != bs_hid::TouchPhase::began)
+                continue;
+
+            lane = allocateLane (sampleOffset);
+            lanes[(size_t) lane].contactKey = contactKey;
+            lanes[(size_t) lane].startOrder = ++eventCounter;
+            addEvent (Event::Type::start, lane, &contact, sampleOffset);
+        }
+        else
+        {
+            addEvent (Event::Type::move, lane, &contact, sampleOffset);
+        }
+
+        lanes[(size_t) lane].seen = true;
+    }
+
+    // Contacts missing from the frame have lifted
+    for (int l = 0; l < numLanes; ++l)
+    {
+        auto& lane = lanes[(size_t) l];
+
+        if (lane.contactKey >= 0 && ! lane.seen)
+        {
+            addEvent (Event::Type::release, l, nullptr, sampleOffset);
+            lane.contactKey = -1;
+            lane.releaseOrder = ++eventCounter;
+        }
+    }
+}
+
+void TouchSynth::releaseAll (int sampleOffset) noexcept
+{
+    sampleOffset = juce::jmax (sampleOffset, lastEventOffset);
+    lastEventOffset = sampleOffset;
+
+    for (int l = 0; l < numLanes; ++l)
+    {
+        auto& lane = lanes[(size_t) l];
+
+        if (lane.contactKey >= 0)
+        {
+            addEvent (Event::Type::release, l, nullptr, sampleOffset);
+            lane.contactKey = -1;
+            lane.releaseOrder = ++eventCounter;
+        }
+    }
+}
+
+int TouchSynth::allocateLane (int sampleOffset) noexcept
+{
+    int freeLane = -1, oldestLane = 0;
+
+    for (int l = 0; l < numLanes; ++l)
+    {
+        const auto& lane = lanes[(size_t) l];
+
+        // The lane released longest ago, whose tail has decayed the most
+        if (lane.contactKey < 0)
+        {
+            if (freeLane < 0 || lane.releaseOrder < lanes[(size_t) freeLane].releaseOrder)
+                freeLane = l;
+        }
+        else if (lane.startOrder < lanes[(size_t) oldestLane].startOrder
+                  || lanes[(size_t) oldestLane].contactKey < 0)
+        {
+            oldestLane = l;
+        }
+    }
+
+    if (freeLane >= 0)
+        return freeLane;
+
+    // Every finger has a voice: the oldest is restarted for the new one
+    addEvent (Event::Type::release, oldestLane, nullptr, sampleOffset);
+    return oldestLane;
+}
+
+void TouchSynth::addEvent (Event::Type type, int lane, const bs_hid::TouchData* contact, int sampleOffset) noexcept
+{
+    // Movements give way first, so starts and releases always have room
+    const int limit = type == Event::Type::move ? maxEventsPerBlock - 2 * numLanes : maxEventsPerBlock;
+
+    if (numEvents >= limit)
+    {
+        jassert (type == Event::Type::move);
+        return;
+    }
+
+    Event event { type, (uint8_t) lane, sampleOffset, 0.0f, 0.0f, 0.0f, -1 };
+
+    if (contact != nullptr)
+    {
+        const float note = (float) settings.lowestNote + contact->normX * settings.semitoneRange;
+        const double frequency = 440.0 * std::pow (2.0, (note - 69.0) / 12.0);
+        event.increment = (float) juce::jlimit (1.0e-6, 0.45, frequency / sampleRate);
+
+        // Y is 0 at the top, brightness rises upwards
+        const float brightness = 1.0f - juce::jlimit (0.0f, 1.0f, contact->normY);
+        const double cutoffHz = settings.minCutoffHz * std::pow (settings.maxCutoffHz / settings.minCutoffHz, brightness);
+        event.cutoff = (float) (1.0 - std::exp (-juce::MathConstants<double>::twoPi * cutoffHz / sampleRate));
+
+        event.level = settings.gain * contact->onsetVelocity;
+    }
+
+    events[(size_t) numEvents++] = event;
+}
+
+//==============================================================================
+void TouchSynth::render (juce::AudioBuffer<float>& buffer, int numSamples) noexcept
+{
+    // Link each event to the same lane's next, so a lane can glide towards it
+    int nextEvent[numLanes];
+    std::fill (nextEvent, nextEvent + numLanes, -1);
+
+    for (int i = numEvents; --i >= 0;)
+    {
+        auto& event = events[(size_t) i];
+        event.sampleOffset = juce::jlimit (0, juce::jmax (0, numSamples - 1), event.sampleOffset);
+        event.next = nextEvent[event.lane];
+        nextEvent[event.lane] = i;
+    }
+
+    for (int l = 0; l < numLanes; ++l)
+        setSlopesTowards (l, nextEvent[l], 0);
+
+    const int numChannels = buffer.getNumChannels();
+
+    for (int chunkStart = 0; chunkStart < numSamples; chunkStart += maxChunkSamples)
+    {
+        const int chunkEnd = juce::jmin (numSamples, chunkStart + maxChunkSamples);
+        const int chunkLength = chunkEnd - chunkStart;
+
+        std::fill (laneMix, laneMix + chunkLength * 4, 0.0f);
+
+        for (int group = 0; group < numGroups; ++group)
+            renderGroup (group, chunkStart, chunkEnd, laneMix);
+
+        for (int i = 0; i < chunkLength; ++i)
+        {
+            const float* mix = laneMix + i * 4;
+            const float sample = mix[0] + mix[1] + mix[2] + mix[3];
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                buffer.getWritePointer (channel)[chunkStart + i] += sample;
+        }
+    }
+
+    numEvents = 0;
+    lastEventOffset = 0;
+}
+
+void TouchSynth::applyEvent (const Event& event) noexcept
+{
+    const int l = event.lane;
+
+    switch (event.type)
+    {
+        case Event::Type::start:
+            phase[l] = 0.0f;
+            increment[l] = event.increment;
+            cutoff[l] = event.cutoff;
+            targetLevel[l] = event.level;
+            envelopeCoefficient[l] = attackCoefficient;
+            break;
+
+        case Event::Type::move:
+            // The glide has arrived: land exactly on the reported value
+            increment[l] = event.increment;
+            cutoff[l] = event.cutoff;
+            break;
+
+        case Event::Type::release:
+            targetLevel[l] = 0.0f;
+            envelopeCoefficient[l] = releaseCoefficient;
+            break;
+    }
+
+    setSlopesTowards (l, event.next, event.sampleOffset);
+}
+
+void TouchSynth::setSlopesTowards (int lane, int eventIndex, int fromOffset) noexcept
+{
+    incrementSlope[lane] = cutoffSlope[lane] = 0.0f;
+
+    if (eventIndex < 0)
+        return;
+
+    // A lane glides only towards a movement; a start jumps, and anything else holds
+    const auto& event = events[(size_t) eventIndex];
+
+    if (event.type == Event::Type::move && event.sampleOffset > fromOffset)
+    {
+        const float samples = (float) (event.sampleOffset - fromOffset);
+        incrementSlope[lane] = (event.increment - increment[lane]) / samples;
+        cutoffSlope[lane] = (event.cutoff - cutoff[lane]) / samples;
+    }
+}
+
+void TouchSynth::renderGroup (int group, int start, int end, float* mix) noexcept
+{
+    const int firstLane = group * 4;
+
+    // The group's events in this chunk, in time order
+    int eventIndex = 0;
+
+    auto isInGroup = [&] (const Event& event) { return event.lane >= firstLane && event.lane < firstLane + 4; };
+    auto findNextEvent = [&]
+    {
+        while (eventIndex < numEvents && ! (isInGroup (events[(size_t) eventIndex]) && events[(size_t) eventIndex].sampleOffset >= start))
+            ++eventIndex;
+    };
+
+    findNextEvent();
+
+    // Silent voices with nothing to start are skipped
+    bool isSilent = eventIndex >= numEvents || events[(size_t) eventIndex].sampleOffset >= end;
+
+    for (int l = firstLane; l < firstLane + 4 && isSilent; ++l)
+        isSilent = targetLevel[l] == 0.0f && level[l] < 1.0e-5f;
+
+    if (isSilent)
+        return;
+
+    const auto one = Lanes::fill (1.0f), two = Lanes::fill (2.0f), zero = Lanes::fill (0.0f);
+
+    for (int position = start; position < end;)
+    {
+        while (eventIndex < numEvents && events[(size_t) eventIndex].sampleOffset == position)
+        {
+            applyEvent (events[(size_t) eventIndex++]);
+            findNextEvent();
+        }
+
+        const int segmentEnd = eventIndex < numEvents ? juce::jmin (end, events[(size_t) eventIndex].sampleOffset) : end;
+
+        auto phases = Lanes::load (phase + firstLane);
+        auto increments = Lanes::load (increment + firstLane);
+        auto cutoffs = Lanes::load (cutoff + firstLane);
+        auto firstStage = Lanes::load (lowpass1 + firstLane);
+        auto secondStage = Lanes::load (lowpass2 + firstLane);
+        auto levels = Lanes::load (level + firstLane);
+        const auto incrementSlopes = Lanes::load (incrementSlope + firstLane);
+        const auto cutoffSlopes = Lanes::load (cutoffSlope + firstLane);
+        const auto targets = Lanes::load (targetLevel + firstLane);
+        const auto envelopeCoefficients = Lanes::load (envelopeCoefficient + firstLane);
+
+        for (int i = position; i < segmentEnd; ++i)
+        {
+            phases = phases + increments;
+            phases = select (lessThan (phases, one), phases, phases - one);
+
+            // PolyBLEP: smooths the sawtooth's reset over one sample either side, against aliasing
+            const auto inverseIncrement = one / increments;
+            const auto afterReset = phases * inverseIncrement;
+            const auto beforeReset = (phases - one) * inverseIncrement;
+            const auto blep = select (lessThan (phases, increments),
+                                      afterReset + afterReset - afterReset * afterReset - one,
+                                      select (lessThan (one - increments, phases),
+                                              beforeReset * beforeReset + beforeReset + beforeReset + one,
+                                              zero));
+            const auto saw = two * phases - one - blep;
+
+            firstStage = firstStage + cutoffs * (saw - firstStage);
+            secondStage = secondStage + cutoffs * (firstStage - secondStage);
+            levels = levels + envelopeCoefficients * (targets - levels);
+
+            float* out = mix + (i - start) * 4;
+            (Lanes::load (out) + secondStage * levels).store (out);
+
+            increments = increments + incrementSlopes;
+            cutoffs = cutoffs + cutoffSlopes;
+        }
+
+        phases.store (phase + firstLane);
+        increments.store (increment + firstLane);
+        cutoffs.store (cutoff + firstLane);
+        firstStage.store (lowpass1 + firstLane);
+        secondStage.store (lowpass2 + firstLane);
+        levels.store (level + firstLane);
+
+        position = segmentEnd;
+    }
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <bs_hid/bs_hid.h>
+
+//==============================================================================
+/**
+    A polyphonic synth with one voice per finger: each contact plays a
+    band-limited sawtooth through a two-pole low-pass, with X setting the
+    pitch, Y the brightness (higher is brighter) and the strike velocity the
+    level.
+
+    Voices are lanes of structure-of-arrays state, rendered four at a time
+    with SSE2 or NEON (see BS_HID_USE_SIMD), so ten fingers cost about as much
+    as three scalar voices. Pitch and cutoff glide sample by sample between
+    the positions the contact reported, each reached at the offset of its
+    report, so the sound follows the touch history smoothly instead of
+    stepping once per report.
+
+    addFrame() queues each frame's changes and render() plays them. Neither
+    allocates or locks, so both can be called from processBlock().
+*/
+class TouchSynth
+{
+public:
+    //==============================================================================
+    static constexpr int numLanes = bs_hid::TouchFrame::maxContacts;    // One voice per contact
+    static constexpr int maxEventsPerBlock = 512;
+
+    struct Settings
+    {
+        int lowestNote = 36;                // Note at the left edge
+        float semitoneRange = 24.0f;        // Semitones across the screen
+        float minCutoffHz = 200.0f;         // Cutoff at the bottom of the screen
+        float maxCutoffHz = 8000.0f;        // Cutoff at the top
+        float attackMs = 3.0f;
+        float releaseMs = 120.0f;
+        float gain = 0.2f;                  // Level of a full-velocity voice
+    };
+
+    //==============================================================================
+    TouchSynth() = default;
+
+    /** Sets the sample rate and settings and silences every voice. Call from prepareToPlay() */
+    void prepare (double sampleRate, const Settings& newSettings);
+    void prepare (double sampleRate) { prepare (sampleRate, Settings()); }
+
+    /** Queues the frame's note starts, movements and releases at sampleOffset */
+    void addFrame (const bs_hid::TouchFrame& frame, int sampleOffset) noexcept;
+
+    /** Queues a release of every sounding voice at sampleOffset */
+    void releaseAll (int sampleOffset) noexcept;
+
+    /** Plays the queued events and adds every voice to the first numSamples of the buffer */
+    void render (juce::AudioBuffer<float>& buffer, int numSamples) noexcept;
+
+private:
+    //==============================================================================
+    static constexpr int numGroups = (numLanes + 3) / 4;
+    static constexpr int numPaddedLanes = numGroups * 4;
+    static constexpr int maxChunkSamples = 256;
+
+    struct Event
+    {
+        enum class Type : uint8_t { start, move, release };
+
+        Type type;
+        uint8_t lane;
+        int sampleOffset;
+        float increment, cutoff, level;     // Targets reached at sampleOffset
+        int next;                           // Index of the lane's next event, or -1
+    };
+
+    struct LaneState
+    {
+        int contactKey = -1;                // deviceIndex << 8 | contactId, or -1 when released
+        uint32_t startOrder = 0, releaseOrder = 0;
+        bool seen = false;
+    };
+
+    void addEvent (Event::Type type, int lane, const bs_hid::TouchData* contact, int sampleOffset) noexcept;
+    void applyEvent (const Event& event) noexcept;
+    void setSlopesTowards (int lane, int eventIndex, int fromOffset) noexcept;
+    int allocateLane (int sampleOffset) noexcept;
+    void renderGroup (int group, int start, int end, float* mix) noexcept;
+
+    //==============================================================================
+    Settings settings;
+    double sampleRate = 44100.0;
+    float attackCoefficient = 0.0f, releaseCoefficient = 0.0f;
+
+    // Per-lane synthesis state, structure of arrays so four lanes load as one register
+    alignas (16) float phase[numPaddedLanes] {};
+    alignas (16) float increment[numPaddedLanes] {};        // Phase advance per sample (frequency / sample rate)
+    alignas (16) float incrementSlope[numPaddedLanes] {};
+    alignas (16) float cutoff[numPaddedLanes] {};           // One-pole coefficient
+    alignas (16) float cutoffSlope[numPaddedLanes] {};
+    alignas (16) float lowpass1[numPaddedLanes] {};
+    alignas (16) float lowpass2[numPaddedLanes] {};
+    alignas (16) float level[numPaddedLanes] {};
+    alignas (16) float targetLevel[numPaddedLanes] {};
+    alignas (16) float envelopeCoefficient[numPaddedLanes] {};
+
+    std::array<LaneState, numLanes> lanes;
+    uint32_t eventCounter = 0;
+
+    std::array<Event, maxEventsPerBlock> events;
+    int numEvents = 0;
+    int lastEventOffset = 0;
+
+    alignas (16) float laneMix[maxChunkSamples * 4] {};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TouchSynth)
+};
@@ -0,0 +1,128 @@
+/*
+  ==============================================================================
+
+   Touch Daemon - Owns the touch device and publishes frames to shared memory
+
+   Run one instance per machine. Plugins and apps attach with
+   bs_hid::SharedTouchClient and never open the device themselves.
+
+  ==============================================================================
+*/
+
+#include <bs_hid/bs_hid.h>
+
+#include <csignal>
+#include <iostream>
+
+namespace
+{
+    std::atomic<bool> quitRequested{false};
+
+    void handleSignal(int)
+    {
+        quitRequested.store(true);
+    }
+}
+
+//==============================================================================
+/** Forwards every frame from the hub to the shared ring, on the HID thread */
+class TouchPublisher : private bs_hid::HIDDeviceManager::Listener,
+                       private juce::Timer
+{
+public:
+    TouchPublisher(bs_hid::HIDHub& hubToUse, bs_hid::SharedTouchRing& ringToUse)
+        : hub(hubToUse), ring(ringToUse)
+    {
+        hub.getDeviceManager().addListener(this);
+        timerCallback();
+        startTimer(250);
+    }
+
+    ~TouchPublisher() override
+    {
+        stopTimer();
+        hub.getDeviceManager().removeListener(this);
+    }
+
+private:
+    void touchDetected(const bs_hid::TouchData&) override {}
+
+    void touchFrameReceived(const bs_hid::TouchFrame& frame) override
+    {
+        const bool isDown = frame.hasActiveContacts();
+        uint32_t flags = 0;
+
+        if (isDown && !wasDown)
+            flags |= bs_hid::SharedTouchRing::touchBegan;
+        else if (!isDown && wasDown)
+            flags |= bs_hid::SharedTouchRing::touchEnded;
+
+        wasDown = isDown;
+        ring.publish(frame, flags);
+    }
+
+    void timerCallback() override
+    {
+        if (quitRequested.load())
+        {
+            juce::MessageManager::getInstance()->stopDispatchLoop();
+            return;
+        }
+
+        auto& deviceManager = hub.getDeviceManager();
+        const bool isConnected = deviceManager.isDeviceConnected();
+
+        if (isConnected != lastConnected)
+        {
+            bs_hid::SharedTouchRing::DeviceStatus status;
+            status.isConnected = isConnected;
+
+            if (isConnected)
+                status.deviceInfo = deviceManager.getConnectedDeviceInfo();
+
+            ring.setDeviceStatus(status);
+            lastConnected = isConnected;
+
+            DBG("TouchDaemon: Device " << (isConnected ? "connected" : "disconnected"));
+        }
+
+        ring.updateHeartbeat();
+    }
+
+    bs_hid::HIDHub& hub;
+    bs_hid::SharedTouchRing& ring;
+    bool wasDown = false;           // HID thread only
+    bool lastConnected = false;     // Message thread only
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TouchPublisher)
+};
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const juce::String segmentName = argc > 1 ? juce::String(argv[1])
+                                              : juce::String(bs_hid::SharedTouchRing::defaultName);
+
+    auto ring = bs_hid::SharedTouchRing::create(segmentName);
+
+    if (ring == nullptr)
+    {
+        std::cerr << "Could not create shared memory segment " << segmentName << std::endl;
+        return 1;
+    }
+
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+
+    {
+        juce::SharedResourcePointer<bs_hid::HIDHub> hub;
+        TouchPublisher publisher(*hub, *ring);
+
+        std::cout << "Publishing touches on " << segmentName << std::endl;
+        juce::MessageManager::getInstance()->runDispatchLoop();
+    }
+
+    return 0;
+}